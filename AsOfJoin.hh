@@ -0,0 +1,237 @@
+////////////////////////////////////////////////////////////////////
+/// \class AsOfJoin
+///
+/// \brief  Joins slow control series onto sorted event times
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file, replaces a binary search per event.
+///
+/// \details For each event time and each series gives either the latest
+///         reading at or before it (kLatest) or the linear interpolation
+///         between the readings either side (kInterpolate). Before the
+///         first reading the value is NaN, after the last it is held.
+///
+///         Events are split into chunks over threads. A chunk finds its
+///         first reading with one binary search, then walks events and
+///         readings forwards together, so a join is O(events + readings)
+///         per series. The walk writes reading indices for a block of
+///         events and a second loop gathers the values, four events per
+///         AVX2 instruction when available. Interpolation works on
+///         integer ns offsets from the reading, value + slope * (t - t0)
+///         with the slopes found once per series.
+///
+///         Each series holds a NaN reading at the earliest possible time
+///         in front of the real ones, so every event has a reading at or
+///         before it and the loops need no edge cases.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_AsOfJoin__
+#define __RAT_DS_AsOfJoin__
+
+#include <PackedTime.hh>
+#include <TimeParallel.hh>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <stdint.h>
+#include <vector>
+
+class AsOfJoin
+{
+public:
+  enum Mode { kLatest, kInterpolate };
+
+  /// Construct the join
+  ///
+  /// @param[in] threads_ to use, 0 for the hardware concurrency
+  AsOfJoin( const unsigned threads_ = 0 ) : threads(threads_) { };
+
+  /// Add a slow control series, the readings are copied
+  ///
+  /// @param[in] times of the readings, sorted
+  /// @param[in] values of the readings
+  /// @param[in] count of readings
+  /// @return index of the series
+  inline size_t AddSeries( const PackedTime* times, const double* values, const size_t count );
+
+  /// Get the number of series
+  ///
+  /// @return count
+  size_t GetSeriesCount() const { return series.size(); }
+
+  /// Join every series onto the events
+  ///
+  /// @param[in] events times, sorted
+  /// @param[in] nEvents number of events
+  /// @param[in] mode kLatest or kInterpolate
+  /// @param[out] out value of series s at event i is out[s * nEvents + i]
+  inline void Join( const PackedTime* events, const size_t nEvents, const Mode mode, double* out ) const;
+
+  /// Join every series onto the events
+  ///
+  /// @param[in] events times, sorted
+  /// @param[in] nEvents number of events
+  /// @param[in] mode kLatest or kInterpolate
+  /// @return value of series s at event i is at [s * nEvents + i]
+  std::vector<double> Join( const PackedTime* events, const size_t nEvents, const Mode mode ) const
+  {
+    std::vector<double> out( series.size() * nEvents );
+    Join( events, nEvents, mode, out.data() );
+    return out;
+  }
+
+  /// Get one value by binary search, for single lookups
+  ///
+  /// @param[in] index of the series
+  /// @param[in] time of the lookup
+  /// @param[in] mode kLatest or kInterpolate
+  /// @return the value
+  inline double Lookup( const size_t index, const PackedTime time, const Mode mode ) const;
+
+protected:
+  static constexpr size_t kBlockSize = 1024; ///< Events per index block
+  static constexpr size_t kMinChunk = 1 << 15; ///< Smallest chunk worth a thread
+  static constexpr PackedTime kMaxSimdGap = PackedTime( 1 ) << 51; ///< Largest offset the SIMD conversion is exact for
+
+  struct Series
+  {
+    std::vector<PackedTime> times; ///< Reading times, after the sentinel
+    std::vector<double> values; ///< Reading values
+    std::vector<double> slopes; ///< Value change per ns to the next reading, 0 after the last
+    bool wide; ///< A gap too long for the SIMD offset conversion
+  };
+
+  /// Gather the values of a block of events from their reading indices
+  static inline void Gather( const Series& data, const PackedTime* events, const int64_t* indices, const size_t count,
+                             const Mode mode, double* out );
+
+  /// Value of a reading index at a time
+  static double Value( const Series& data, const size_t j, const PackedTime time, const Mode mode )
+  {
+    if( mode == kLatest )
+      return data.values[j];
+    // Wrapping subtraction, the sentinel's offset is garbage but its slope is 0
+    const int64_t offset = static_cast<int64_t>( static_cast<uint64_t>( time ) - static_cast<uint64_t>( data.times[j] ) );
+    return data.values[j] + data.slopes[j] * static_cast<double>( offset );
+  }
+
+  std::vector<Series> series; ///< The slow control series
+  unsigned threads; ///< Threads to use, 0 for the hardware concurrency
+};
+
+inline size_t
+AsOfJoin::AddSeries( const PackedTime* times, const double* values, const size_t count )
+{
+  Series data;
+  data.times.reserve( count + 1 );
+  data.values.reserve( count + 1 );
+  data.times.push_back( std::numeric_limits<PackedTime>::min() );
+  data.values.push_back( std::numeric_limits<double>::quiet_NaN() );
+  data.times.insert( data.times.end(), times, times + count );
+  data.values.insert( data.values.end(), values, values + count );
+  data.slopes.assign( count + 1, 0.0 );
+  data.wide = false;
+  for( size_t j = 1; j + 1 < data.times.size(); j++ )
+    {
+      const PackedTime gap = data.times[j + 1] - data.times[j];
+      if( gap < 0 )
+        throw std::invalid_argument( "AsOfJoin: readings are not sorted" );
+      if( gap > 0 ) // Repeated times are never interpolated from, the later reading wins
+        data.slopes[j] = ( data.values[j + 1] - data.values[j] ) / static_cast<double>( gap );
+      data.wide = data.wide || gap >= kMaxSimdGap;
+    }
+  series.push_back( data );
+  return series.size() - 1;
+}
+
+inline double
+AsOfJoin::Lookup( const size_t index, const PackedTime time, const Mode mode ) const
+{
+  const Series& data = series.at( index );
+  const size_t j = std::upper_bound( data.times.begin() + 1, data.times.end(), time ) - data.times.begin() - 1;
+  return Value( data, j, time, mode );
+}
+
+inline void
+AsOfJoin::Gather( const Series& data, const PackedTime* events, const int64_t* indices, const size_t count,
+                  const Mode mode, double* out )
+{
+  size_t i = 0;
+#if defined(__AVX2__)
+  const double* values = data.values.data();
+  if( mode == kLatest )
+    {
+      for( ; i + 4 <= count; i += 4 )
+        {
+          const __m256i index = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( indices + i ) );
+          _mm256_storeu_pd( out + i, _mm256_i64gather_pd( values, index, 8 ) );
+        }
+    }
+  else if( !data.wide )
+    {
+      const long long* times = reinterpret_cast<const long long*>( data.times.data() );
+      const double* slopes = data.slopes.data();
+      // Exact int64 to double for |x| < 2^51: add 1.5 * 2^52 as integers, subtract it as doubles
+      const __m256i magicBits = _mm256_set1_epi64x( 0x4338000000000000ll );
+      const __m256d magic = _mm256_set1_pd( 6755399441055744.0 );
+      const __m256i limit = _mm256_set1_epi64x( kMaxSimdGap - 1 );
+      const __m256i zero = _mm256_setzero_si256();
+      for( ; i + 4 <= count; i += 4 )
+        {
+          const __m256i index = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( indices + i ) );
+          const __m256i time = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( events + i ) );
+          __m256i offset = _mm256_sub_epi64( time, _mm256_i64gather_epi64( times, index, 8 ) );
+          // Only the sentinel and holds after the last reading go out of range, both have slope 0
+          const __m256i outside = _mm256_or_si256( _mm256_cmpgt_epi64( offset, limit ), _mm256_cmpgt_epi64( zero, offset ) );
+          offset = _mm256_andnot_si256( outside, offset );
+          const __m256d offsetNs = _mm256_sub_pd( _mm256_castsi256_pd( _mm256_add_epi64( offset, magicBits ) ), magic );
+          const __m256d slope = _mm256_i64gather_pd( slopes, index, 8 );
+          const __m256d value = _mm256_i64gather_pd( values, index, 8 );
+          _mm256_storeu_pd( out + i, _mm256_add_pd( value, _mm256_mul_pd( slope, offsetNs ) ) );
+        }
+    }
+#endif
+  for( ; i < count; i++ )
+    out[i] = Value( data, static_cast<size_t>( indices[i] ), events[i], mode );
+}
+
+inline void
+AsOfJoin::Join( const PackedTime* events, const size_t nEvents, const Mode mode, double* out ) const
+{
+  if( nEvents == 0 )
+    return;
+  TimeParallel::ForEachChunk( nEvents, threads, kMinChunk,
+                              [&]( const size_t, const size_t begin, const size_t end )
+                              {
+                                int64_t indices[kBlockSize];
+                                for( size_t s = 0; s < series.size(); s++ )
+                                  {
+                                    const Series& data = series[s];
+                                    const PackedTime* times = data.times.data();
+                                    const size_t last = data.times.size() - 1;
+                                    // Latest reading at or before the chunk's first event, then walk forwards
+                                    size_t j = std::upper_bound( data.times.begin() + 1, data.times.end(), events[begin] )
+                                      - data.times.begin() - 1;
+                                    for( size_t first = begin; first < end; first += kBlockSize )
+                                      {
+                                        const size_t count = std::min( kBlockSize, end - first );
+                                        for( size_t i = 0; i < count; i++ )
+                                          {
+                                            const PackedTime time = events[first + i];
+                                            while( j < last && times[j + 1] <= time )
+                                              j++;
+                                            indices[i] = static_cast<int64_t>( j );
+                                          }
+                                        Gather( data, events + first, indices, count, mode, out + s * nEvents + first );
+                                      }
+                                  }
+                              } );
+}
+
+#endif
@@ -0,0 +1,582 @@
+////////////////////////////////////////////////////////////////////
+/// \class BinaryLogger
+///
+/// \brief  Logger that defers timestamp and text formatting off the DAQ threads
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file, replaces GetTime/strftime/snprintf on the producers.
+///
+/// \details A producer thread logs a format ID, a packed time and the
+///         raw argument values into a fixed 64 byte record and pushes
+///         it onto its own SpscQueue, with no locks, allocation or text
+///         work. The IDs come from RegisterFormat, done once per call site:
+///
+///           static const uint32_t kFormat = logger.RegisterFormat( "crate %d gtid %u lost %s" );
+///           producer.Log( kFormat, now, crate, gtid, reason );
+///
+///         Formatting happens in Process, on the thread of Start, or
+///         offline: Write stores the binary records, with the formats
+///         they use, and Decode (or the BinaryLogDecode tool) turns the
+///         file into text later. Times print as UTC calendar time with
+///         ns, converted arithmetically, without mktime.
+///
+///         Formats are printf style, %d %i %u %x %X %o %c %f %e %g %a
+///         %s %p and %%, with flags, width and precision but not *.
+///         Integer length modifiers are ignored, the argument's own
+///         type decides, stored in 4 bytes up to 32 bits and 8
+///         above. Arguments that do not fit the record are dropped,
+///         printing <?>, and strings are cut to fit. A full queue
+///         drops the record and counts it, it never blocks.
+///
+///         The binary file is native endian: an 8 byte magic, then
+///         blocks of 'F' id length text for formats and 'R' header
+///         arguments for records.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_BinaryLogger__
+#define __RAT_DS_BinaryLogger__
+
+#include <PackedTime.hh>
+#include <SpscQueue.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class BinaryLogger
+{
+public:
+  static constexpr size_t kArgumentBytes = 48; ///< Argument bytes per record
+  static constexpr size_t kMaxFormatBytes = 1 << 16; ///< Longest format text
+
+  /// One log call, a cache line
+  struct Record
+  {
+    PackedTime time; ///< Time of the call
+    uint32_t format; ///< Format ID
+    uint16_t size; ///< Argument bytes used
+    uint16_t pad; ///< Unused
+    uint8_t arguments[kArgumentBytes]; ///< Type tag then value per argument
+  };
+
+  /// The queue of one producer thread
+  class Producer
+  {
+  public:
+    /// Log a record, the owning thread only
+    ///
+    /// @param[in] format ID from RegisterFormat
+    /// @param[in] time of the record
+    /// @param[in] args integers, floating point or strings
+    /// @return false if the queue was full and the record dropped
+    template<class... TArgs>
+    bool Log( const uint32_t format, const PackedTime time, const TArgs&... args )
+    {
+      // Filled in the ring itself, no copy of the record
+      Record* record = queue.Claim();
+      if( record == 0 )
+        {
+          dropped.store( dropped.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+          return false;
+        }
+      record->time = time;
+      record->format = format;
+      record->pad = 0;
+      uint8_t* out = record->arguments;
+      ( Encode( out, record->arguments + kArgumentBytes, args ), ... );
+      record->size = static_cast<uint16_t>( out - record->arguments );
+      queue.Publish();
+      return true;
+    }
+
+    /// Get the number of Log calls that found the queue full
+    ///
+    /// @return count
+    uint64_t GetDropped() const { return dropped.load( std::memory_order_relaxed ); }
+
+  protected:
+    friend class BinaryLogger;
+
+    Producer( const size_t queueSize ) : queue(queueSize), dropped(0) { };
+
+    SpscQueue<Record> queue; ///< Records to the consumer
+    std::atomic<uint64_t> dropped; ///< Records lost on a full queue
+  };
+
+  typedef std::function<void( const PackedTime time, const std::string& text )> Sink;
+
+  /// Construct the logger
+  BinaryLogger() : running(false), wroteHeader(false), writtenFormats(0) { };
+
+  /// Stops the logging thread if running, errors are lost, call Stop to see them
+  ~BinaryLogger()
+  {
+    try
+      {
+        Stop();
+      }
+    catch( const std::exception& )
+      {
+      }
+  }
+
+  /// Register a format, once per call site
+  ///
+  /// @param[in] format printf style text, up to kMaxFormatBytes
+  /// @return ID to log with
+  uint32_t RegisterFormat( const std::string& format )
+  {
+    if( format.size() > kMaxFormatBytes )
+      throw std::invalid_argument( "BinaryLogger: format longer than kMaxFormatBytes" );
+    std::lock_guard<std::mutex> lock( mutex );
+    formats.push_back( format );
+    return static_cast<uint32_t>( formats.size() - 1 );
+  }
+
+  /// Add a producer, keep it for the life of the producer thread
+  ///
+  /// @param[in] queueSize records, a power of two
+  /// @return the producer, owned by the logger
+  Producer& AddProducer( const size_t queueSize = 1 << 12 )
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    producers.push_back( std::unique_ptr<Producer>( new Producer( queueSize ) ) );
+    return *producers.back();
+  }
+
+  /// Take every queued record, in time order
+  ///
+  /// @param[out] records cleared then filled
+  /// @return number of records
+  inline size_t Drain( std::vector<Record>& records );
+
+  /// Format every queued record, in time order
+  ///
+  /// @param[in] sink called with each time and text
+  /// @return number of records
+  template<class TSink>
+  size_t Process( TSink sink );
+
+  /// Write every queued record and the formats it needs, for Decode
+  ///
+  /// @param[in] file open for binary writing, the same for every call
+  /// @return number of records, throws runtime_error if the file cannot be written
+  inline size_t Write( FILE* file );
+
+  /// Run Process on a logging thread until Stop
+  ///
+  /// @param[in] sink called on the logging thread
+  void Start( const Sink& sink ) { StartThread( [this, sink]() { return Process( std::ref( sink ) ); } ); }
+
+  /// Run Write on a logging thread until Stop
+  ///
+  /// @param[in] file open for binary writing
+  void Start( FILE* file ) { StartThread( [this, file]() { return Write( file ); } ); }
+
+  /// Stop the logging thread after it handles what is queued
+  ///
+  /// Throws runtime_error if the thread stopped on an error
+  inline void Stop();
+
+  /// Get the number of records dropped by every producer
+  ///
+  /// @return count
+  inline uint64_t GetDropped();
+
+  /// Read a Write file and format its records
+  ///
+  /// @param[in] file open for binary reading
+  /// @param[in] sink called with each time and text
+  /// @return number of records, throws runtime_error on a corrupt file
+  static inline size_t Decode( FILE* file, const Sink& sink );
+
+  /// Format a record
+  ///
+  /// @param[in] format the record's format text
+  /// @param[in] record to format
+  /// @return the text
+  static inline std::string FormatRecord( const std::string& format, const Record& record );
+
+  /// Format a time as UTC, 2010-01-01 00:00:00.000000000
+  ///
+  /// @param[in] time to format
+  /// @return the text
+  static inline std::string FormatTime( const PackedTime time );
+
+protected:
+  static constexpr char kMagic[9] = "UTBLOG1\n"; ///< Start of a Write file
+  static constexpr size_t kHeaderBytes = offsetof( Record, arguments ); ///< Record bytes before the arguments
+
+  template<class T>
+  static typename std::enable_if<std::is_integral<T>::value>::type
+  Encode( uint8_t*& out, const uint8_t* end, const T value )
+  {
+    // Integers up to 32 bits take 4 bytes, i and u, wider ones 8, I and U
+    const size_t bytes = sizeof( T ) <= 4 ? 4 : 8;
+    if( static_cast<size_t>( end - out ) < bytes + 1 )
+      return;
+    *out++ = std::is_signed<T>::value ? ( bytes == 4 ? 'i' : 'I' ) : ( bytes == 4 ? 'u' : 'U' );
+    if( bytes == 4 )
+      {
+        const uint32_t bits = static_cast<uint32_t>( value );
+        std::memcpy( out, &bits, 4 );
+      }
+    else
+      {
+        const uint64_t bits = static_cast<uint64_t>( value );
+        std::memcpy( out, &bits, 8 );
+      }
+    out += bytes;
+  }
+
+  template<class T>
+  static typename std::enable_if<std::is_floating_point<T>::value>::type
+  Encode( uint8_t*& out, const uint8_t* end, const T value )
+  {
+    if( end - out < 9 )
+      return;
+    *out++ = 'd';
+    const double number = static_cast<double>( value );
+    std::memcpy( out, &number, 8 );
+    out += 8;
+  }
+
+  static void Encode( uint8_t*& out, const uint8_t* end, const char* value )
+  {
+    Encode( out, end, value, value == 0 ? 0 : std::strlen( value ) );
+  }
+
+  static void Encode( uint8_t*& out, const uint8_t* end, const std::string& value )
+  {
+    Encode( out, end, value.data(), value.size() );
+  }
+
+  static void Encode( uint8_t*& out, const uint8_t* end, const void* value )
+  {
+    Encode( out, end, reinterpret_cast<uintptr_t>( value ) );
+  }
+
+  /// Store a string, cut to what fits
+  static void Encode( uint8_t*& out, const uint8_t* end, const char* value, const size_t length )
+  {
+    if( end - out < 2 )
+      return;
+    const size_t stored = std::min( length, static_cast<size_t>( end - out - 2 ) );
+    *out++ = 's';
+    *out++ = static_cast<uint8_t>( stored );
+    std::memcpy( out, value, stored );
+    out += stored;
+  }
+
+  /// Format one conversion of one argument onto text
+  static inline void FormatArgument( std::string& text, std::string spec, const char conversion,
+                                     const uint8_t*& in, const uint8_t* end );
+
+  /// Run a drain function on a logging thread until Stop
+  inline void StartThread( const std::function<size_t()>& drain );
+
+  std::mutex mutex; ///< Guards formats and producers
+  std::vector<std::string> formats; ///< Format text by ID
+  std::vector<std::unique_ptr<Producer> > producers; ///< Producer queues
+  std::vector<std::string> consumerFormats; ///< Copy of formats for Process, no lock held while formatting
+  std::vector<Record> batch; ///< Records of a Process or Write
+  std::thread thread; ///< Logging thread of Start
+  std::atomic<bool> running; ///< Logging thread runs
+  std::function<size_t()> threadDrain; ///< Work of the logging thread
+  std::string threadError; ///< Error that stopped the logging thread
+  bool wroteHeader; ///< Write has written the magic
+  size_t writtenFormats; ///< Formats Write has written
+};
+
+inline size_t
+BinaryLogger::Drain( std::vector<Record>& records )
+{
+  records.clear();
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    for( size_t p = 0; p < producers.size(); p++ )
+      {
+        Record record;
+        while( producers[p]->queue.Pop( record ) )
+          records.push_back( record );
+      }
+  }
+  // One producer, or producers taking turns, are already in order
+  const auto earlier = []( const Record& lhs, const Record& rhs ) { return lhs.time < rhs.time; };
+  if( !std::is_sorted( records.begin(), records.end(), earlier ) )
+    std::stable_sort( records.begin(), records.end(), earlier );
+  return records.size();
+}
+
+template<class TSink>
+size_t
+BinaryLogger::Process( TSink sink )
+{
+  const size_t count = Drain( batch );
+  for( size_t i = 0; i < count; i++ )
+    {
+      if( batch[i].format >= consumerFormats.size() )
+        {
+          std::lock_guard<std::mutex> lock( mutex );
+          consumerFormats = formats;
+        }
+      const std::string text = batch[i].format < consumerFormats.size()
+        ? FormatRecord( consumerFormats[batch[i].format], batch[i] ) : "<unknown format>";
+      sink( batch[i].time, FormatTime( batch[i].time ) + " " + text );
+    }
+  return count;
+}
+
+inline size_t
+BinaryLogger::Write( FILE* file )
+{
+  const size_t count = Drain( batch );
+  std::lock_guard<std::mutex> lock( mutex );
+  if( !wroteHeader )
+    {
+      std::fwrite( kMagic, 1, 8, file );
+      wroteHeader = true;
+    }
+  // Formats first, any record in the batch was logged after its format was registered
+  for( ; writtenFormats < formats.size(); writtenFormats++ )
+    {
+      const uint32_t id = static_cast<uint32_t>( writtenFormats );
+      const uint32_t length = static_cast<uint32_t>( formats[writtenFormats].size() );
+      std::fputc( 'F', file );
+      std::fwrite( &id, sizeof( id ), 1, file );
+      std::fwrite( &length, sizeof( length ), 1, file );
+      std::fwrite( formats[writtenFormats].data(), 1, length, file );
+    }
+  for( size_t i = 0; i < count; i++ )
+    {
+      std::fputc( 'R', file );
+      std::fwrite( &batch[i], 1, kHeaderBytes + batch[i].size, file );
+    }
+  // The error flag is sticky, one check covers every call above
+  if( std::ferror( file ) )
+    throw std::runtime_error( std::string( "BinaryLogger: cannot write the log: " ) + std::strerror( errno ) );
+  return count;
+}
+
+inline void
+BinaryLogger::StartThread( const std::function<size_t()>& drain )
+{
+  if( thread.joinable() )
+    throw std::logic_error( "BinaryLogger: already started" );
+  threadDrain = drain;
+  threadError.clear();
+  running.store( true );
+  thread = std::thread( [this]()
+                        {
+                          // An error ends the thread, Stop reports it
+                          try
+                            {
+                              while( running.load( std::memory_order_relaxed ) )
+                                if( threadDrain() == 0 )
+                                  std::this_thread::sleep_for( std::chrono::microseconds( 500 ) );
+                            }
+                          catch( const std::exception& exception )
+                            {
+                              threadError = exception.what();
+                            }
+                        } );
+}
+
+inline void
+BinaryLogger::Stop()
+{
+  if( !thread.joinable() )
+    return;
+  running.store( false );
+  thread.join();
+  if( !threadError.empty() )
+    throw std::runtime_error( threadError );
+  threadDrain();
+}
+
+inline uint64_t
+BinaryLogger::GetDropped()
+{
+  std::lock_guard<std::mutex> lock( mutex );
+  uint64_t dropped = 0;
+  for( size_t p = 0; p < producers.size(); p++ )
+    dropped += producers[p]->GetDropped();
+  return dropped;
+}
+
+inline size_t
+BinaryLogger::Decode( FILE* file, const Sink& sink )
+{
+  char magic[8];
+  if( std::fread( magic, 1, 8, file ) != 8 || std::memcmp( magic, kMagic, 8 ) != 0 )
+    throw std::runtime_error( "BinaryLogger: not a binary log" );
+  std::vector<std::string> formats;
+  size_t count = 0;
+  for( int type = std::fgetc( file ); type != EOF; type = std::fgetc( file ) )
+    {
+      if( type == 'F' )
+        {
+          uint32_t id;
+          uint32_t length;
+          if( std::fread( &id, sizeof( id ), 1, file ) != 1 || std::fread( &length, sizeof( length ), 1, file ) != 1
+              || id > formats.size() + ( 1 << 20 ) )
+            throw std::runtime_error( "BinaryLogger: truncated format" );
+          // No format is registered longer, so a corrupt length cannot ask for gigabytes
+          if( length > kMaxFormatBytes )
+            throw std::runtime_error( "BinaryLogger: corrupt format length" );
+          std::string format( length, '\0' );
+          if( length > 0 && std::fread( &format[0], 1, length, file ) != length )
+            throw std::runtime_error( "BinaryLogger: truncated format" );
+          if( id >= formats.size() )
+            formats.resize( id + 1, "<unknown format>" );
+          formats[id] = format;
+        }
+      else if( type == 'R' )
+        {
+          Record record;
+          if( std::fread( &record, 1, kHeaderBytes, file ) != kHeaderBytes || record.size > kArgumentBytes
+              || std::fread( record.arguments, 1, record.size, file ) != record.size )
+            throw std::runtime_error( "BinaryLogger: truncated record" );
+          const std::string text = record.format < formats.size()
+            ? FormatRecord( formats[record.format], record ) : "<unknown format>";
+          sink( record.time, FormatTime( record.time ) + " " + text );
+          count++;
+        }
+      else
+        throw std::runtime_error( "BinaryLogger: corrupt block" );
+    }
+  return count;
+}
+
+inline std::string
+BinaryLogger::FormatRecord( const std::string& format, const Record& record )
+{
+  std::string text;
+  const uint8_t* in = record.arguments;
+  const uint8_t* end = record.arguments + std::min<size_t>( record.size, kArgumentBytes );
+  for( size_t i = 0; i < format.size(); i++ )
+    {
+      if( format[i] != '%' )
+        {
+          text += format[i];
+          continue;
+        }
+      if( i + 1 < format.size() && format[i + 1] == '%' )
+        {
+          text += '%';
+          i++;
+          continue;
+        }
+      // Flags, width and precision are kept, length modifiers dropped
+      std::string spec = "%";
+      for( i++; i < format.size() && std::strchr( "-+ #0123456789.", format[i] ) != 0 && format[i] != '\0'; i++ )
+        spec += format[i];
+      while( i < format.size() && std::strchr( "hljztLq", format[i] ) != 0 && format[i] != '\0' )
+        i++;
+      if( i == format.size() )
+        {
+          text += spec;
+          break;
+        }
+      FormatArgument( text, spec, format[i], in, end );
+    }
+  return text;
+}
+
+inline void
+BinaryLogger::FormatArgument( std::string& text, std::string spec, const char conversion,
+                              const uint8_t*& in, const uint8_t* end )
+{
+  if( end - in < 1 )
+    {
+      text += "<?>";
+      return;
+    }
+  const char tag = static_cast<char>( *in++ );
+  char buffer[512];
+  int written = 0;
+  if( tag == 's' )
+    {
+      const size_t stored = in < end ? *in++ : 0;
+      const size_t length = std::min<size_t>( stored, static_cast<size_t>( end - in ) );
+      const std::string value( reinterpret_cast<const char*>( in ), length );
+      in += length;
+      written = std::snprintf( buffer, sizeof( buffer ), ( spec + "s" ).c_str(), value.c_str() );
+    }
+  else
+    {
+      // Widen to 64 bits, sign extending the signed 4 byte integers
+      const size_t bytes = std::min<size_t>( tag == 'i' || tag == 'u' ? 4 : 8, static_cast<size_t>( end - in ) );
+      uint64_t bits = 0;
+      std::memcpy( &bits, in, bytes );
+      in += bytes;
+      if( tag == 'i' )
+        bits = static_cast<uint64_t>( static_cast<int64_t>( static_cast<int32_t>( static_cast<uint32_t>( bits ) ) ) );
+      double number;
+      std::memcpy( &number, &bits, 8 );
+      const bool isSigned = tag == 'i' || tag == 'I';
+      const bool floating = std::strchr( "fFeEgGaA", conversion ) != 0;
+      if( tag == 'd' && !floating )
+        written = std::snprintf( buffer, sizeof( buffer ), ( spec + "g" ).c_str(), number );
+      else if( tag == 'd' )
+        written = std::snprintf( buffer, sizeof( buffer ), ( spec + conversion ).c_str(), number );
+      else if( floating )
+        written = std::snprintf( buffer, sizeof( buffer ), ( spec + conversion ).c_str(),
+                                 isSigned ? static_cast<double>( static_cast<int64_t>( bits ) ) : static_cast<double>( bits ) );
+      else if( conversion == 'c' )
+        written = std::snprintf( buffer, sizeof( buffer ), ( spec + "c" ).c_str(), static_cast<int>( bits ) );
+      else if( conversion == 'p' )
+        written = std::snprintf( buffer, sizeof( buffer ), ( spec + "p" ).c_str(),
+                                 reinterpret_cast<const void*>( static_cast<uintptr_t>( bits ) ) );
+      else if( std::strchr( "uxXo", conversion ) != 0 && conversion != '\0' )
+        written = std::snprintf( buffer, sizeof( buffer ), ( spec + "ll" + conversion ).c_str(),
+                                 static_cast<unsigned long long>( bits ) );
+      else if( !isSigned )
+        written = std::snprintf( buffer, sizeof( buffer ), ( spec + "llu" ).c_str(), static_cast<unsigned long long>( bits ) );
+      else
+        written = std::snprintf( buffer, sizeof( buffer ), ( spec + "lld" ).c_str(),
+                                 static_cast<long long>( static_cast<int64_t>( bits ) ) );
+    }
+  if( written > 0 )
+    text.append( buffer, std::min<size_t>( static_cast<size_t>( written ), sizeof( buffer ) - 1 ) );
+}
+
+inline std::string
+BinaryLogger::FormatTime( const PackedTime time )
+{
+  // Days since 1970 to a proleptic Gregorian date
+  const int64_t day = PackedTimes::FloorDivide( time, PackedTimes::kNanoSecondsPerDay );
+  const int64_t inDay = time - day * PackedTimes::kNanoSecondsPerDay;
+  const int64_t z = day + PackedTimes::kUnixT0Seconds / PackedTimes::kSecondsPerDay + 719468;
+  const int64_t era = ( z >= 0 ? z : z - 146096 ) / 146097;
+  const int64_t dayOfEra = z - era * 146097;
+  const int64_t yearOfEra = ( dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096 ) / 365;
+  const int64_t dayOfYear = dayOfEra - ( 365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100 );
+  const int64_t monthFromMarch = ( 5 * dayOfYear + 2 ) / 153;
+  const int64_t dayOfMonth = dayOfYear - ( 153 * monthFromMarch + 2 ) / 5 + 1;
+  const int64_t month = monthFromMarch < 10 ? monthFromMarch + 3 : monthFromMarch - 9;
+  const int64_t year = yearOfEra + era * 400 + ( month <= 2 );
+  const int64_t seconds = inDay / PackedTimes::kNanoSecondsPerSecond;
+  char buffer[64];
+  std::snprintf( buffer, sizeof( buffer ), "%04lld-%02lld-%02lld %02lld:%02lld:%02lld.%09lld",
+                 static_cast<long long>( year ), static_cast<long long>( month ), static_cast<long long>( dayOfMonth ),
+                 static_cast<long long>( seconds / 3600 ), static_cast<long long>( seconds / 60 % 60 ),
+                 static_cast<long long>( seconds % 60 ),
+                 static_cast<long long>( inDay % PackedTimes::kNanoSecondsPerSecond ) );
+  return buffer;
+}
+
+#endif
@@ -0,0 +1,245 @@
+////////////////////////////////////////////////////////////////////
+/// \class ChannelRateTable
+///
+/// \brief  Exponentially decayed hit rate of every PMT channel
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file for online rate monitoring.
+///
+/// \details Each channel keeps a weight w and the time of its last hit.
+///         A hit at t decays the weight to t and adds one,
+///         w = w exp(-(t - last) / tau) + 1, so w estimates the number
+///         of hits in the last tau and the rate is w / tau. Reads decay
+///         the stored weight to the read time, so channels without hits
+///         cost nothing.
+///
+///         The state is two arrays (structure of arrays), last times and
+///         weights, with exp(-x) from ExpNegative, a branch free
+///         polynomial a few times cheaper than std::exp with a relative
+///         error below 1e-8.
+///
+///         One thread fills, any number of threads may read. Channels
+///         are grouped in blocks of 64, each with a sequence number the
+///         writer makes odd while it updates the block. A reader copies
+///         a block and retries if the number changed, so readers never
+///         block the writer and a Snapshot is consistent per channel
+///         without stopping the filling. Use one table per writer
+///         thread, e.g. split by crate, for more writers.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_ChannelRateTable__
+#define __RAT_DS_ChannelRateTable__
+
+#include <PackedTime.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <stdint.h>
+
+class ChannelRateTable
+{
+public:
+  /// Construct the table, every channel starts with no hits
+  ///
+  /// @param[in] nChannels_ number of channels
+  /// @param[in] tau_ decay time (s)
+  inline ChannelRateTable( const size_t nChannels_, const double tau_ );
+
+  /// Add a hit, writer thread only
+  ///
+  /// @param[in] channel of the hit
+  /// @param[in] time of the hit, older than the channel's last hit counts as at it
+  void Fill( const uint32_t channel, const PackedTime time )
+  {
+    if( channel >= nChannels )
+      throw std::out_of_range( "ChannelRateTable: no such channel" );
+    Update( channel, time );
+  }
+
+  /// Add hits, writer thread only
+  ///
+  /// @param[in] channels of the hits
+  /// @param[in] times of the hits, sorted
+  /// @param[in] count of hits, none are added if a channel is out of range
+  inline void Fill( const uint32_t* channels, const PackedTime* times, const size_t count );
+
+  /// Get the rate of a channel, any thread
+  ///
+  /// @param[in] channel to read
+  /// @param[in] now time to decay to
+  /// @return rate (Hz)
+  inline double GetRate( const uint32_t channel, const PackedTime now ) const;
+
+  /// Get the rates of every channel, any thread
+  ///
+  /// @param[in] now time to decay to
+  /// @param[out] rates one per channel (Hz)
+  inline void Snapshot( const PackedTime now, double* rates ) const;
+
+  /// Get the number of channels
+  ///
+  /// @return count
+  size_t GetChannelCount() const { return nChannels; }
+
+  /// Get the decay time
+  ///
+  /// @return tau (s)
+  double GetTau() const { return tau; }
+
+  /// exp(-x) for x >= 0 without branches, relative error below 1e-8, exact at 0, exp(-708) beyond x = 708
+  ///
+  /// @param[in] x exponent, negative is taken as 0
+  /// @return exp(-x)
+  static inline double ExpNegative( double x );
+
+protected:
+  static constexpr size_t kBlockShift = 6; ///< 64 channels per sequence number
+
+  /// Add a hit to a channel known to exist
+  inline void Update( const uint32_t channel, const PackedTime time );
+
+  /// Copy one channel's state consistently
+  inline void Read( const uint32_t channel, PackedTime& time, double& weight ) const;
+
+  /// Weight decayed from its last hit to now, as a rate
+  double Decay( const PackedTime time, const double weight, const PackedTime now ) const
+  {
+    return weight * ExpNegative( static_cast<double>( now - time ) * inverseTau ) * rateScale;
+  }
+
+  size_t nChannels; ///< Number of channels
+  double tau; ///< Decay time (s)
+  double inverseTau; ///< 1 / tau (1/ns)
+  double rateScale; ///< 1 / tau (1/s)
+  std::unique_ptr<std::atomic<PackedTime>[]> times; ///< Last hit time per channel
+  std::unique_ptr<std::atomic<double>[]> weights; ///< Decayed weight per channel at its last hit
+  std::unique_ptr<std::atomic<uint32_t>[]> sequences; ///< Odd while the writer updates a block
+};
+
+inline
+ChannelRateTable::ChannelRateTable( const size_t nChannels_, const double tau_ )
+  : nChannels(nChannels_), tau(tau_), inverseTau(1.0 / ( tau_ * 1.0e9 )), rateScale(1.0 / tau_),
+    times(new std::atomic<PackedTime>[nChannels_]), weights(new std::atomic<double>[nChannels_]),
+    sequences(new std::atomic<uint32_t>[( nChannels_ >> kBlockShift ) + 1])
+{
+  if( !( tau_ > 0.0 ) )
+    throw std::invalid_argument( "ChannelRateTable: tau must be positive" );
+  for( size_t channel = 0; channel < nChannels; channel++ )
+    {
+      times[channel].store( 0, std::memory_order_relaxed );
+      weights[channel].store( 0.0, std::memory_order_relaxed );
+    }
+  for( size_t block = 0; block <= ( nChannels >> kBlockShift ); block++ )
+    sequences[block].store( 0, std::memory_order_relaxed );
+}
+
+inline double
+ChannelRateTable::ExpNegative( double x )
+{
+  // exp(-x) = 2^y, y = -x log2(e) = n + f with n the nearest whole number
+  x = std::min( std::max( x, 0.0 ), 708.0 );
+  const double y = -x * 1.4426950408889634;
+  const int64_t n = static_cast<int64_t>( y - 0.5 ); // Truncation, y <= 0 so f in [-1/2, 1/2]
+  // 2^f = e^g with g = f ln 2 in [-0.35, 0.35], Taylor to g^7, exactly 1 at x = 0
+  const double g = ( y - static_cast<double>( n ) ) * 0.6931471805599453;
+  double p = 1.0 / 5040.0;
+  p = p * g + 1.0 / 720.0;
+  p = p * g + 1.0 / 120.0;
+  p = p * g + 1.0 / 24.0;
+  p = p * g + 1.0 / 6.0;
+  p = p * g + 0.5;
+  p = p * g + 1.0;
+  p = p * g + 1.0;
+  // 2^n by building the exponent bits, n >= -1022 as x <= 708
+  const uint64_t bits = static_cast<uint64_t>( n + 1023 ) << 52;
+  double scale;
+  std::memcpy( &scale, &bits, sizeof( scale ) );
+  return p * scale;
+}
+
+inline void
+ChannelRateTable::Update( const uint32_t channel, const PackedTime time )
+{
+  std::atomic<uint32_t>& sequence = sequences[channel >> kBlockShift];
+  const uint32_t start = sequence.load( std::memory_order_relaxed );
+  sequence.store( start + 1, std::memory_order_relaxed );
+  std::atomic_thread_fence( std::memory_order_release );
+  const PackedTime last = times[channel].load( std::memory_order_relaxed );
+  const double weight = weights[channel].load( std::memory_order_relaxed );
+  const double decay = ExpNegative( static_cast<double>( time - last ) * inverseTau );
+  weights[channel].store( weight * decay + 1.0, std::memory_order_relaxed );
+  times[channel].store( std::max( time, last ), std::memory_order_relaxed );
+  sequence.store( start + 2, std::memory_order_release );
+}
+
+inline void
+ChannelRateTable::Fill( const uint32_t* channels, const PackedTime* times_, const size_t count )
+{
+  // Checked in a pass of its own, so the update loop stays branch free and a bad channel adds nothing
+  uint32_t highest = 0;
+  for( size_t i = 0; i < count; i++ )
+    highest = std::max( highest, channels[i] );
+  if( count > 0 && highest >= nChannels )
+    throw std::out_of_range( "ChannelRateTable: no such channel" );
+  for( size_t i = 0; i < count; i++ )
+    Update( channels[i], times_[i] );
+}
+
+inline void
+ChannelRateTable::Read( const uint32_t channel, PackedTime& time, double& weight ) const
+{
+  const std::atomic<uint32_t>& sequence = sequences[channel >> kBlockShift];
+  for( ;; )
+    {
+      const uint32_t start = sequence.load( std::memory_order_acquire );
+      time = times[channel].load( std::memory_order_relaxed );
+      weight = weights[channel].load( std::memory_order_relaxed );
+      std::atomic_thread_fence( std::memory_order_acquire );
+      if( ( start & 1 ) == 0 && sequence.load( std::memory_order_relaxed ) == start )
+        return;
+    }
+}
+
+inline double
+ChannelRateTable::GetRate( const uint32_t channel, const PackedTime now ) const
+{
+  if( channel >= nChannels )
+    throw std::out_of_range( "ChannelRateTable: no such channel" );
+  PackedTime time;
+  double weight;
+  Read( channel, time, weight );
+  return Decay( time, weight, now );
+}
+
+inline void
+ChannelRateTable::Snapshot( const PackedTime now, double* rates ) const
+{
+  for( size_t first = 0; first < nChannels; first += size_t( 1 ) << kBlockShift )
+    {
+      // Copy a whole block under one sequence number, decay after
+      const size_t last = std::min( nChannels, first + ( size_t( 1 ) << kBlockShift ) );
+      const std::atomic<uint32_t>& sequence = sequences[first >> kBlockShift];
+      PackedTime blockTimes[size_t( 1 ) << kBlockShift];
+      double blockWeights[size_t( 1 ) << kBlockShift];
+      for( ;; )
+        {
+          const uint32_t start = sequence.load( std::memory_order_acquire );
+          for( size_t channel = first; channel < last; channel++ )
+            {
+              blockTimes[channel - first] = times[channel].load( std::memory_order_relaxed );
+              blockWeights[channel - first] = weights[channel].load( std::memory_order_relaxed );
+            }
+          std::atomic_thread_fence( std::memory_order_acquire );
+          if( ( start & 1 ) == 0 && sequence.load( std::memory_order_relaxed ) == start )
+            break;
+        }
+      for( size_t channel = first; channel < last; channel++ )
+        rates[channel] = Decay( blockTimes[channel - first], blockWeights[channel - first], now );
+    }
+}
+
+#endif
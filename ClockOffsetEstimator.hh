@@ -0,0 +1,175 @@
+////////////////////////////////////////////////////////////////////
+/// \class ClockOffsetEstimator
+///
+/// \brief  Offset and drift of a remote clock from timestamped probes
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file for ClockSync.
+///
+/// \details A probe is stamped four times, sent at t1 and received at
+///         t4 by the local clock, received at t2 and replied at t3 by
+///         the remote one. As in NTP the remote clock is ahead by
+///         theta = ((t2 - t1) + (t3 - t4)) / 2, exact if the two
+///         network legs take equal times. Queueing makes them unequal,
+///         but it also lengthens the round trip
+///         delta = (t4 - t1) - (t3 - t2), so of each window of probes
+///         only the one with the smallest round trip is kept. A least
+///         squares line through the kept offsets against remote time
+///         gives the offset and the drift (ns per ns).
+///
+///         ClockCorrection holds the fit and maps remote times onto the
+///         local clock, one multiply-add per time for whole arrays of
+///         packed times or UniversalTimeCores.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_ClockOffsetEstimator__
+#define __RAT_DS_ClockOffsetEstimator__
+
+#include <PackedTime.hh>
+#include <UniversalTimeCore.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include <stdint.h>
+
+/// Maps one remote clock onto the local clock
+struct ClockCorrection
+{
+  PackedTime reference; ///< Remote time the offset is quoted at
+  double offset; ///< Remote minus local (ns) at reference
+  double drift; ///< Change of offset per ns of remote time
+  double delay; ///< Smallest round trip (ns) of the fit, its offsets are good to about half this
+  uint32_t points; ///< Probes in the fit, 0 for none and no correction
+
+  /// Get remote minus local at a remote time
+  ///
+  /// @param[in] time remote
+  /// @return offset (ns)
+  double GetOffset( const PackedTime time ) const { return offset + drift * static_cast<double>( time - reference ); }
+
+  /// Convert remote times to local times in place
+  ///
+  /// @param[in,out] times remote then local
+  /// @param[in] count of times
+  void Apply( PackedTime* times, const size_t count ) const
+  {
+    for( size_t i = 0; i < count; i++ )
+      times[i] -= std::llrint( GetOffset( times[i] ) );
+  }
+
+  /// Convert remote times to local times in place
+  ///
+  /// @param[in,out] times remote then local
+  /// @param[in] count of times
+  void Apply( UniversalTimeCore* times, const size_t count ) const
+  {
+    for( size_t i = 0; i < count; i++ )
+      times[i] -= UniversalTimeCore( 0, 0, GetOffset( PackedTimes::Pack( times[i] ) ) );
+  }
+};
+
+class ClockOffsetEstimator
+{
+public:
+  /// Construct the estimator
+  ///
+  /// @param[in] window_ probes per kept probe, the one with the smallest round trip
+  /// @param[in] history_ kept probes in the fit, the oldest are dropped
+  ClockOffsetEstimator( const size_t window_ = 8, const size_t history_ = 64 )
+    : window(window_), history(history_), inWindow(0)
+  {
+    if( window_ == 0 || history_ == 0 )
+      throw std::invalid_argument( "ClockOffsetEstimator: window and history must be positive" );
+  }
+
+  /// Add a probe
+  ///
+  /// @param[in] t1 local send time
+  /// @param[in] t2 remote receive time
+  /// @param[in] t3 remote reply time
+  /// @param[in] t4 local receive time
+  /// @return false if the stamps are inconsistent and the probe is ignored
+  inline bool Add( const PackedTime t1, const PackedTime t2, const PackedTime t3, const PackedTime t4 );
+
+  /// Fit the kept probes, and the best of the current window
+  ///
+  /// @return the correction, points is 0 before any probe
+  inline ClockCorrection Fit() const;
+
+  /// Get the number of kept probes
+  ///
+  /// @return count, excluding the current window
+  size_t GetKeptCount() const { return kept.size(); }
+
+protected:
+  struct Point
+  {
+    PackedTime time; ///< Remote time, midway between t2 and t3
+    double offset; ///< Remote minus local (ns)
+    double delay; ///< Round trip (ns)
+  };
+
+  size_t window; ///< Probes per kept probe
+  size_t history; ///< Kept probes in the fit
+  size_t inWindow; ///< Probes in the current window
+  Point best; ///< Smallest round trip of the current window
+  std::deque<Point> kept; ///< Kept probes, oldest first
+};
+
+inline bool
+ClockOffsetEstimator::Add( const PackedTime t1, const PackedTime t2, const PackedTime t3, const PackedTime t4 )
+{
+  const PackedTime delay = ( t4 - t1 ) - ( t3 - t2 );
+  if( t4 < t1 || t3 < t2 || delay < 0 )
+    return false;
+  Point point;
+  point.time = t2 + ( t3 - t2 ) / 2;
+  point.offset = 0.5 * static_cast<double>( ( t2 - t1 ) + ( t3 - t4 ) );
+  point.delay = static_cast<double>( delay );
+  if( inWindow == 0 || point.delay < best.delay )
+    best = point;
+  if( ++inWindow == window )
+    {
+      kept.push_back( best );
+      if( kept.size() > history )
+        kept.pop_front();
+      inWindow = 0;
+    }
+  return true;
+}
+
+inline ClockCorrection
+ClockOffsetEstimator::Fit() const
+{
+  ClockCorrection correction = { 0, 0.0, 0.0, std::numeric_limits<double>::infinity(), 0 };
+  const size_t n = kept.size() + ( inWindow > 0 );
+  if( n == 0 )
+    return correction;
+  // Sums about the last point keep the time differences small
+  const Point& last = inWindow > 0 ? best : kept.back();
+  double sumT = 0.0, sumO = 0.0, sumTT = 0.0, sumTO = 0.0;
+  for( size_t i = 0; i < n; i++ )
+    {
+      const Point& point = i < kept.size() ? kept[i] : best;
+      const double t = static_cast<double>( point.time - last.time );
+      sumT += t;
+      sumO += point.offset;
+      sumTT += t * t;
+      sumTO += t * point.offset;
+      correction.delay = std::min( correction.delay, point.delay );
+    }
+  const double meanT = sumT / n;
+  const double meanO = sumO / n;
+  const double varianceT = sumTT / n - meanT * meanT;
+  correction.drift = n >= 2 && varianceT > 0.0 ? ( sumTO / n - meanT * meanO ) / varianceT : 0.0;
+  correction.reference = last.time;
+  correction.offset = meanO - correction.drift * meanT;
+  correction.points = static_cast<uint32_t>( n );
+  return correction;
+}
+
+#endif
@@ -0,0 +1,330 @@
+////////////////////////////////////////////////////////////////////
+/// \class ClockSync
+///
+/// \brief  Measures the clock offsets of DAQ nodes and publishes corrections
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file for cross node coincidences.
+///
+/// \details Every DAQ node runs a ClockSyncServer, a UDP responder that
+///         stamps each probe on arrival and again on reply with the
+///         node's own clock. The reference node runs ClockSync: Poll
+///         sends one probe to every node and collects the replies into a
+///         ClockOffsetEstimator per node, and Publish fits them and swaps
+///         in a new ClockCorrections table through an RcuPointer.
+///         Threads correcting hit times get the table with one load and
+///         never wait for the network:
+///
+///           const ClockCorrections* table = sync.GetCorrections(); // Reader of domain
+///           table->nodes[node].Apply( times, count );
+///
+///         Polling every few ms and publishing every second or so is
+///         plenty, offsets of tens of us drift by well under 1 ns/ms.
+///         Probes are 40 byte datagrams, native endian, the nodes are
+///         expected to share the architecture.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_ClockSync__
+#define __RAT_DS_ClockSync__
+
+#include <ClockOffsetEstimator.hh>
+#include <PackedTime.hh>
+#include <QsbrDomain.hh>
+#include <RcuPointer.hh>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Corrections of every node, published whole
+struct ClockCorrections
+{
+  std::vector<ClockCorrection> nodes; ///< By node index
+};
+
+/// Probe datagram, sent with t1 and returned with t2 and t3
+struct ClockProbe
+{
+  static constexpr uint32_t kMagic = 0x55544353; ///< "UTCS"
+
+  uint32_t magic; ///< kMagic
+  uint32_t node; ///< Node index at the sender
+  uint64_t sequence; ///< Poll number at the sender
+  PackedTime t1; ///< Sender's send time
+  PackedTime t2; ///< Responder's receive time
+  PackedTime t3; ///< Responder's reply time
+};
+
+class ClockSyncServer
+{
+public:
+  typedef std::function<PackedTime()> Clock;
+
+  /// Open the responder socket
+  ///
+  /// @param[in] port to listen on, 0 for any free port
+  /// @param[in] clock_ of this node
+  inline ClockSyncServer( const uint16_t port = 0, const Clock& clock_ = SystemClock );
+
+  /// Stops the responder thread and closes the socket
+  ~ClockSyncServer() { Stop(); close( socketFd ); }
+
+  ClockSyncServer( const ClockSyncServer& ) = delete;
+  ClockSyncServer& operator=( const ClockSyncServer& ) = delete;
+
+  /// Get the port listened on
+  ///
+  /// @return port
+  uint16_t GetPort() const { return port; }
+
+  /// Answer the probes arriving within a time, however busy the socket
+  ///
+  /// @param[in] timeoutMs to answer for
+  /// @return number of probes answered
+  inline size_t Serve( const int timeoutMs );
+
+  /// Run Serve on a responder thread until Stop
+  inline void Start();
+
+  /// Stop the responder thread
+  inline void Stop();
+
+  /// Read CLOCK_REALTIME as a packed time
+  ///
+  /// @return now
+  static PackedTime SystemClock()
+  {
+    timespec now;
+    clock_gettime( CLOCK_REALTIME, &now );
+    return ( static_cast<PackedTime>( now.tv_sec ) - PackedTimes::kUnixT0Seconds ) * PackedTimes::kNanoSecondsPerSecond
+      + now.tv_nsec;
+  }
+
+protected:
+  int socketFd; ///< UDP socket
+  uint16_t port; ///< Bound port
+  Clock clock; ///< This node's clock
+  std::thread thread; ///< Responder thread of Start
+  std::atomic<bool> running; ///< Responder thread runs
+};
+
+class ClockSync
+{
+public:
+  typedef ClockSyncServer::Clock Clock;
+
+  /// Open the probing socket
+  ///
+  /// @param[in] domain_ readers of GetCorrections register with
+  /// @param[in] clock_ of this, the reference, node
+  /// @param[in] window_ probes per kept probe of each estimator
+  /// @param[in] history_ kept probes in each fit
+  inline ClockSync( QsbrDomain& domain_, const Clock& clock_ = ClockSyncServer::SystemClock, const size_t window_ = 8,
+                    const size_t history_ = 64 );
+
+  ~ClockSync() { close( socketFd ); }
+
+  ClockSync( const ClockSync& ) = delete;
+  ClockSync& operator=( const ClockSync& ) = delete;
+
+  /// Add a node, before polling
+  ///
+  /// @param[in] address IPv4 dotted quad of its ClockSyncServer
+  /// @param[in] port of its ClockSyncServer
+  /// @return node index
+  inline size_t AddNode( const std::string& address, const uint16_t port );
+
+  /// Probe every node once
+  ///
+  /// @param[in] timeoutMs to wait for the replies
+  /// @return number of replies
+  inline size_t Poll( const int timeoutMs = 100 );
+
+  /// Fit every node and publish the corrections
+  inline void Publish();
+
+  /// Get the published corrections, valid until the reader's next quiescent state
+  ///
+  /// @return the table, 0 before the first Publish
+  const ClockCorrections* GetCorrections() const { return corrections.Get(); }
+
+  /// Get a node's estimator
+  ///
+  /// @param[in] node index
+  /// @return the estimator
+  const ClockOffsetEstimator& GetEstimator( const size_t node ) const { return estimators.at( node ); }
+
+protected:
+  int socketFd; ///< UDP socket
+  Clock clock; ///< Reference clock
+  size_t window; ///< Probes per kept probe
+  size_t history; ///< Kept probes per fit
+  uint64_t sequence; ///< Polls made
+  std::vector<sockaddr_in> addresses; ///< Node servers
+  std::vector<ClockOffsetEstimator> estimators; ///< Node estimators
+  RcuPointer<ClockCorrections> corrections; ///< Published table
+};
+
+inline
+ClockSyncServer::ClockSyncServer( const uint16_t port_, const Clock& clock_ )
+  : socketFd(socket( AF_INET, SOCK_DGRAM, 0 )), port(port_), clock(clock_), running(false)
+{
+  if( socketFd < 0 )
+    throw std::runtime_error( std::string( "ClockSyncServer: socket: " ) + std::strerror( errno ) );
+  sockaddr_in address;
+  std::memset( &address, 0, sizeof( address ) );
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl( INADDR_ANY );
+  address.sin_port = htons( port_ );
+  socklen_t length = sizeof( address );
+  if( bind( socketFd, reinterpret_cast<sockaddr*>( &address ), sizeof( address ) ) != 0
+      || getsockname( socketFd, reinterpret_cast<sockaddr*>( &address ), &length ) != 0 )
+    {
+      const std::string error = std::strerror( errno );
+      close( socketFd );
+      throw std::runtime_error( "ClockSyncServer: bind: " + error );
+    }
+  port = ntohs( address.sin_port );
+}
+
+inline size_t
+ClockSyncServer::Serve( const int timeoutMs )
+{
+  size_t answered = 0;
+  // A deadline rather than a wait per probe, so a client polling often cannot keep Stop waiting
+  const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now()
+    + std::chrono::milliseconds( timeoutMs );
+  pollfd wait = { socketFd, POLLIN, 0 };
+  for( ;; )
+    {
+      const int left = static_cast<int>( std::chrono::duration_cast<std::chrono::milliseconds>(
+                                           deadline - std::chrono::steady_clock::now() ).count() );
+      if( left < 0 || poll( &wait, 1, left ) <= 0 )
+        break;
+      ClockProbe probe;
+      sockaddr_in from;
+      socklen_t length = sizeof( from );
+      const ssize_t size = recvfrom( socketFd, &probe, sizeof( probe ), 0, reinterpret_cast<sockaddr*>( &from ), &length );
+      const PackedTime received = clock();
+      if( size != static_cast<ssize_t>( sizeof( probe ) ) || probe.magic != ClockProbe::kMagic )
+        continue;
+      probe.t2 = received;
+      probe.t3 = clock();
+      sendto( socketFd, &probe, sizeof( probe ), 0, reinterpret_cast<sockaddr*>( &from ), length );
+      answered++;
+    }
+  return answered;
+}
+
+inline void
+ClockSyncServer::Start()
+{
+  if( thread.joinable() )
+    throw std::logic_error( "ClockSyncServer: already started" );
+  running.store( true );
+  thread = std::thread( [this]()
+                        {
+                          while( running.load( std::memory_order_relaxed ) )
+                            Serve( 50 );
+                        } );
+}
+
+inline void
+ClockSyncServer::Stop()
+{
+  if( !thread.joinable() )
+    return;
+  running.store( false );
+  thread.join();
+}
+
+inline
+ClockSync::ClockSync( QsbrDomain& domain_, const Clock& clock_, const size_t window_, const size_t history_ )
+  : socketFd(socket( AF_INET, SOCK_DGRAM, 0 )), clock(clock_), window(window_), history(history_), sequence(0),
+    corrections(domain_)
+{
+  if( socketFd < 0 )
+    throw std::runtime_error( std::string( "ClockSync: socket: " ) + std::strerror( errno ) );
+}
+
+inline size_t
+ClockSync::AddNode( const std::string& address, const uint16_t port )
+{
+  sockaddr_in node;
+  std::memset( &node, 0, sizeof( node ) );
+  node.sin_family = AF_INET;
+  node.sin_port = htons( port );
+  if( inet_pton( AF_INET, address.c_str(), &node.sin_addr ) != 1 )
+    throw std::invalid_argument( "ClockSync: bad address " + address );
+  addresses.push_back( node );
+  estimators.push_back( ClockOffsetEstimator( window, history ) );
+  return addresses.size() - 1;
+}
+
+inline size_t
+ClockSync::Poll( const int timeoutMs )
+{
+  sequence++;
+  for( size_t node = 0; node < addresses.size(); node++ )
+    {
+      ClockProbe probe = { ClockProbe::kMagic, static_cast<uint32_t>( node ), sequence, 0, 0, 0 };
+      probe.t1 = clock();
+      sendto( socketFd, &probe, sizeof( probe ), 0, reinterpret_cast<const sockaddr*>( &addresses[node] ),
+              sizeof( addresses[node] ) );
+    }
+  // Replies of earlier polls arriving late are dropped by their sequence, replies not from
+  // the node's address or repeated are dropped too, so no node can end the wait for the others
+  std::vector<bool> replied( addresses.size(), false );
+  size_t replies = 0;
+  const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now()
+    + std::chrono::milliseconds( timeoutMs );
+  pollfd wait = { socketFd, POLLIN, 0 };
+  while( replies < addresses.size() )
+    {
+      const int left = static_cast<int>( std::chrono::duration_cast<std::chrono::milliseconds>(
+                                           deadline - std::chrono::steady_clock::now() ).count() );
+      if( poll( &wait, 1, std::max( left, 0 ) ) <= 0 )
+        break;
+      ClockProbe probe;
+      sockaddr_in from;
+      socklen_t length = sizeof( from );
+      const ssize_t size = recvfrom( socketFd, &probe, sizeof( probe ), 0, reinterpret_cast<sockaddr*>( &from ), &length );
+      const PackedTime received = clock();
+      if( size != static_cast<ssize_t>( sizeof( probe ) ) || probe.magic != ClockProbe::kMagic
+          || probe.sequence != sequence || probe.node >= estimators.size() || replied[probe.node]
+          || from.sin_addr.s_addr != addresses[probe.node].sin_addr.s_addr || from.sin_port != addresses[probe.node].sin_port )
+        continue;
+      replied[probe.node] = true;
+      estimators[probe.node].Add( probe.t1, probe.t2, probe.t3, received );
+      replies++;
+    }
+  return replies;
+}
+
+inline void
+ClockSync::Publish()
+{
+  std::unique_ptr<ClockCorrections> table( new ClockCorrections );
+  for( size_t node = 0; node < estimators.size(); node++ )
+    table->nodes.push_back( estimators[node].Fit() );
+  corrections.Publish( std::unique_ptr<const ClockCorrections>( table.release() ) );
+}
+
+#endif
@@ -0,0 +1,210 @@
+////////////////////////////////////////////////////////////////////
+/// \class Deduplicator
+///
+/// \brief  Drops repeated events from a merged time ordered stream
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file, replaces the global std::set of (time, GTID).
+///
+/// \details An event is a duplicate of an earlier one with the same ID
+///         (a GTID, or any 64 bit hash of what identifies an event)
+///         and a time within the tolerance of it. The first in stream
+///         order is kept. As the stream is time ordered, an entry more
+///         than tolerance + maxDisorder behind the latest time can
+///         never match again, so only that window is remembered.
+///
+///         Entries sit in an open addressing table, linear probing on
+///         the mixed ID, 16 bytes a slot. Expired entries are not
+///         removed, a lookup steps over them like tombstones and an
+///         insert reuses the first it passes. When live and expired
+///         entries fill half the table, or after as many inserts as it
+///         has slots, it is rebuilt with the live ones only at a size
+///         for them, so memory follows the number of events in the
+///         window however long the stream, and shrinks after a burst.
+///
+///         Events may arrive up to maxDisorder behind the latest time.
+///         Later ones are counted as late and may slip through.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_Deduplicator__
+#define __RAT_DS_Deduplicator__
+
+#include <PackedTime.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+class Deduplicator
+{
+public:
+  /// Construct the deduplicator
+  ///
+  /// @param[in] tolerance_ largest time difference of duplicates (ns)
+  /// @param[in] maxDisorder_ furthest an event may arrive behind the latest (ns)
+  /// @param[in] minCapacity_ smallest table size, rounded up to a power of two
+  Deduplicator( const PackedTime tolerance_, const PackedTime maxDisorder_ = 0, const size_t minCapacity_ = 64 )
+    : tolerance(std::max<PackedTime>( tolerance_, 0 )), retention(tolerance + std::max<PackedTime>( maxDisorder_, 0 )),
+      minCapacity(16), duplicates(0), late(0) { while( minCapacity < minCapacity_ ) minCapacity <<= 1; Reset(); };
+
+  /// Forget every event
+  void Reset()
+  {
+    slots.assign( minCapacity, Slot() );
+    used = 0;
+    fills = 0;
+    latest = kEmpty;
+    cutoff = kEmpty;
+  }
+
+  /// Check an event and remember it if new
+  ///
+  /// @param[in] time of the event
+  /// @param[in] id of the event
+  /// @return true if new, false if a duplicate
+  inline bool Add( const PackedTime time, const uint64_t id );
+
+  /// Drop the duplicates from an array of events, keeping the order
+  ///
+  /// @param[in,out] events in time order, with a PackedTime member time, compacted
+  /// @param[in] count of events
+  /// @param[in] idOf returns the uint64_t ID of an event
+  /// @return number of events kept, at the front
+  template<class T, class TIdOf>
+  size_t Filter( T* events, const size_t count, TIdOf idOf )
+  {
+    size_t kept = 0;
+    for( size_t i = 0; i < count; i++ )
+      if( Add( events[i].time, idOf( events[i] ) ) )
+        {
+          if( kept != i )
+            events[kept] = events[i];
+          kept++;
+        }
+    return kept;
+  }
+
+  /// Get the number of duplicates dropped
+  ///
+  /// @return count
+  uint64_t GetDuplicates() const { return duplicates; }
+
+  /// Get the number of events that arrived more than maxDisorder behind the latest
+  ///
+  /// @return count
+  uint64_t GetLate() const { return late; }
+
+  /// Get the table size
+  ///
+  /// @return slots
+  size_t GetCapacity() const { return slots.size(); }
+
+protected:
+  static constexpr PackedTime kEmpty = INT64_MIN; ///< Time of an empty slot, and of no time yet
+
+  struct Slot
+  {
+    Slot() : time(kEmpty), key(0) { };
+
+    PackedTime time; ///< Of the event, kEmpty if never used
+    uint64_t key; ///< Mixed ID
+  };
+
+  /// Mix an ID, a bijection so distinct IDs stay distinct (the splitmix64 finaliser)
+  static uint64_t Mix( uint64_t id )
+  {
+    id = ( id ^ ( id >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+    id = ( id ^ ( id >> 27 ) ) * 0x94d049bb133111ebULL;
+    return id ^ ( id >> 31 );
+  }
+
+  /// Rebuild with the live entries only, at a size for them
+  inline void Rehash();
+
+  PackedTime tolerance; ///< Largest time difference of duplicates
+  PackedTime retention; ///< Entries this far behind the latest have expired
+  size_t minCapacity; ///< Smallest table size
+  std::vector<Slot> slots; ///< The table, a power of two
+  std::vector<Slot> spare; ///< The table before the last rebuild
+  size_t used; ///< Slots ever filled, live or expired
+  size_t fills; ///< Inserts since the last rebuild
+  PackedTime latest; ///< Latest time seen
+  PackedTime cutoff; ///< Entries before this have expired
+  uint64_t duplicates; ///< Events dropped
+  uint64_t late; ///< Events beyond the disorder allowed
+};
+
+inline bool
+Deduplicator::Add( const PackedTime time, const uint64_t id )
+{
+  if( latest == kEmpty || time > latest )
+    {
+      latest = time;
+      cutoff = time - retention;
+    }
+  else if( time < latest - ( retention - tolerance ) )
+    late++;
+  const uint64_t key = Mix( id );
+  const size_t mask = slots.size() - 1;
+  size_t reuse = slots.size(); // First expired slot passed
+  size_t index = key & mask;
+  for( ; slots[index].time != kEmpty; index = ( index + 1 ) & mask )
+    {
+      const Slot& slot = slots[index];
+      if( slot.time < cutoff )
+        {
+          if( reuse == slots.size() )
+            reuse = index;
+          continue;
+        }
+      if( slot.key == key && slot.time >= time - tolerance && slot.time <= time + tolerance )
+        {
+          duplicates++;
+          return false;
+        }
+    }
+  // Too old to ever match, nothing to remember
+  if( time < cutoff )
+    return true;
+  if( reuse != slots.size() )
+    index = reuse;
+  else
+    used++;
+  slots[index].time = time;
+  slots[index].key = key;
+  // Full of expired entries, or due a check it has not outgrown the window
+  if( 2 * used > slots.size() || ( ++fills >= slots.size() && slots.size() > minCapacity ) )
+    Rehash();
+  return true;
+}
+
+inline void
+Deduplicator::Rehash()
+{
+  size_t live = 0;
+  for( size_t i = 0; i < slots.size(); i++ )
+    live += slots[i].time >= cutoff;
+  // A quarter full after the rebuild, so growth and shrinking both have slack
+  size_t capacity = minCapacity;
+  while( capacity < 4 * live )
+    capacity <<= 1;
+  // Into the previous table, so a rebuild at the same size does not allocate
+  spare.assign( capacity, Slot() );
+  spare.swap( slots );
+  const size_t mask = capacity - 1;
+  for( size_t i = 0; i < spare.size(); i++ )
+    if( spare[i].time >= cutoff )
+      {
+        size_t index = spare[i].key & mask;
+        while( slots[index].time != kEmpty )
+          index = ( index + 1 ) & mask;
+        slots[index] = spare[i];
+      }
+  if( spare.size() > capacity )
+    std::vector<Slot>().swap( spare ); // Give a burst's memory back
+  used = live;
+  fills = 0;
+}
+
+#endif
@@ -0,0 +1,412 @@
+////////////////////////////////////////////////////////////////////
+/// \class EventBuilder
+///
+/// \brief  Assembles per crate fragments into events by GTID and time
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file, replaces the std::map keyed event building.
+///
+/// \details Each crate pushes its fragments, in time order, into its own
+///         SpscQueue so crate readout threads never contend. Process()
+///         (one builder thread, or Start() to run it on one) drains the
+///         queues and assembles events:
+///
+///          - Open events sit in a time bucketed table, bucket width a
+///            power of two >= the tolerance, indexed by the packed time
+///            of the event's first fragment. A fragment only looks at
+///            the buckets within the tolerance of its time, so matching
+///            is O(1) whatever the number of open events.
+///          - A fragment joins an open event with the same 24 bit GTID
+///            within the tolerance that has no fragment from its crate.
+///            Otherwise it opens a new event. GTIDs roll over every
+///            2^24 triggers, so the time tolerance keeps two triggers
+///            with the same GTID apart. Released events carry the GTID
+///            unwrapped to 64 bits.
+///          - The watermark is the oldest of the newest times seen per
+///            crate. Crates silent for longer than the timeout (wall
+///            clock) are left out, so a dead crate cannot stall the
+///            builder. Crate streams are time ordered, so once the
+///            watermark passes an event's first time plus the tolerance
+///            nothing more can join it. Events are released in order
+///            of their earliest fragment time, each as soon as this
+///            holds for it and every earlier event.
+///          - Fragments older than the last released event are late,
+///            they are counted and dropped since they can no longer be
+///            released in order.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_EventBuilder__
+#define __RAT_DS_EventBuilder__
+
+#include <PackedTime.hh>
+#include <SpscQueue.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <stdint.h>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class EventBuilder
+{
+public:
+  static constexpr unsigned kMaxCrates = 32; ///< Crates per builder, SNO+ has 19
+  static constexpr uint32_t kGtidMask = 0xFFFFFF; ///< GTIDs are 24 bits
+
+  /// One crate's data for one trigger
+  struct Fragment
+  {
+    PackedTime time; ///< Crate time of the trigger
+    uint32_t gtid; ///< Global trigger ID, 24 bits
+    uint32_t crate; ///< Crate number, < the number of crates
+    uint64_t payload; ///< The caller's handle to the crate data
+  };
+
+  /// An assembled event
+  struct Event
+  {
+    int64_t gtid; ///< GTID unwrapped over rollovers
+    PackedTime time; ///< Earliest fragment time
+    PackedTime firstTime; ///< Time of the fragment that opened the event
+    uint32_t crateMask; ///< Bit c set if crate c has a fragment
+    Fragment fragments[kMaxCrates]; ///< Fragment of crate c, valid if its bit is set
+
+    /// Get the number of crates with a fragment
+    ///
+    /// @return count
+    unsigned GetCount() const { return static_cast<unsigned>( __builtin_popcount( crateMask ) ); }
+  };
+
+  typedef std::function<void( const Event& )> Sink;
+
+  /// Construct the builder
+  ///
+  /// @param[in] nCrates_ number of crates, at most kMaxCrates
+  /// @param[in] tolerance_ largest clock disagreement (ns) between crates
+  /// @param[in] timeout_ seconds without data after which a crate is not waited for
+  /// @param[in] queueSize per crate, a power of two
+  inline EventBuilder( const unsigned nCrates_, const PackedTime tolerance_, const double timeout_,
+                       const size_t queueSize = 1 << 16 );
+
+  /// Stops the builder thread if running
+  ~EventBuilder() { if( thread.joinable() ) { running.store( false ); thread.join(); } }
+
+  /// Add a fragment, called by the thread reading fragment.crate only
+  ///
+  /// @param[in] fragment to add
+  /// @return false if that crate's queue is full, try again later
+  bool Push( const Fragment& fragment )
+  {
+    if( fragment.crate >= nCrates )
+      throw std::out_of_range( "EventBuilder: no such crate" );
+    return queues[fragment.crate]->Push( fragment );
+  }
+
+  /// Drain the queues, assemble and release the ready events in time order
+  ///
+  /// @param[in] sink called with each released event
+  /// @return number of events released
+  template<class TSink>
+  size_t Process( TSink sink );
+
+  /// Release every open event in time order, e.g. at the end of a run
+  ///
+  /// @param[in] sink called with each released event
+  /// @return number of events released
+  template<class TSink>
+  size_t Flush( TSink sink );
+
+  /// Run Process on a builder thread until Stop
+  ///
+  /// @param[in] sink called on the builder thread with each event
+  inline void Start( const Sink& sink );
+
+  /// Stop the builder thread, then Flush
+  inline void Stop();
+
+  /// Get the number of released events, from any thread while the builder thread runs
+  ///
+  /// @return count
+  uint64_t GetBuilt() const { return built.load( std::memory_order_relaxed ); }
+
+  /// Get the number of released events missing a crate, from any thread
+  ///
+  /// @return count
+  uint64_t GetPartial() const { return partial.load( std::memory_order_relaxed ); }
+
+  /// Get the number of dropped late fragments, from any thread
+  ///
+  /// @return count
+  uint64_t GetLate() const { return late.load( std::memory_order_relaxed ); }
+
+  /// Get the number of fragments that opened an event while an event
+  /// within the tolerance, missing their crate, had another GTID, from any thread
+  ///
+  /// @return count
+  uint64_t GetMismatched() const { return mismatched.load( std::memory_order_relaxed ); }
+
+protected:
+  static constexpr size_t kBuckets = 4096; ///< Ring of buckets, a power of two
+  static constexpr size_t kDrainBatch = 1024; ///< Fragments taken from one queue per turn
+
+  /// Add to a counter, written only by the thread assembling, so no locked add, read from any
+  static void Count( std::atomic<uint64_t>& counter, const uint64_t n )
+  {
+    counter.store( counter.load( std::memory_order_relaxed ) + n, std::memory_order_relaxed );
+  }
+
+  /// Heap entry, the earliest time of an event when pushed
+  typedef std::pair<PackedTime, uint32_t> Key;
+  typedef std::chrono::steady_clock Clock;
+
+  /// Add a fragment to an open event, or open one
+  inline void Assemble( const Fragment& fragment );
+
+  /// Release events from the front until one is not ready
+  template<class TSink>
+  size_t Release( const PackedTime watermark, TSink& sink );
+
+  /// Remove an event from its bucket and the pool
+  inline void Close( const uint32_t index );
+
+  /// Get the bucket of a time
+  size_t Bucket( const PackedTime time ) const { return static_cast<size_t>( time >> bucketShift ) & ( kBuckets - 1 ); }
+
+  std::vector<std::unique_ptr<SpscQueue<Fragment> > > queues; ///< Input queue per crate
+  std::vector<PackedTime> crateTimes; ///< Newest time seen per crate
+  std::vector<Clock::time_point> crateSeen; ///< When each crate last sent data
+  std::vector<Event> events; ///< Event pool
+  std::vector<uint32_t> freeEvents; ///< Unused pool entries
+  std::vector<std::vector<uint32_t> > buckets; ///< Open events by first time
+  std::priority_queue<Key, std::vector<Key>, std::greater<Key> > order; ///< Open events by earliest time, may hold stale entries
+  unsigned nCrates; ///< Number of crates
+  uint32_t fullMask; ///< crateMask of a complete event
+  PackedTime tolerance; ///< Largest clock disagreement (ns)
+  Clock::duration timeout; ///< Wait for a silent crate
+  unsigned bucketShift; ///< log2 of the bucket width
+  PackedTime newestTime; ///< Newest time seen from any crate
+  PackedTime releasedTime; ///< Time of the last released event
+  int64_t lastGtid; ///< Unwrapped GTID of the last released event
+  bool haveGtid; ///< Has an event been released
+  std::atomic<uint64_t> built; ///< Released events
+  std::atomic<uint64_t> partial; ///< Released events missing a crate
+  std::atomic<uint64_t> late; ///< Dropped late fragments
+  std::atomic<uint64_t> mismatched; ///< Fragments opening an event beside one with another GTID
+  std::thread thread; ///< Builder thread of Start
+  std::atomic<bool> running; ///< Builder thread should continue
+  Sink threadSink; ///< Sink of the builder thread
+};
+
+inline
+EventBuilder::EventBuilder( const unsigned nCrates_, const PackedTime tolerance_, const double timeout_,
+                            const size_t queueSize )
+  : crateTimes(nCrates_, std::numeric_limits<PackedTime>::min()), crateSeen(nCrates_, Clock::now()), buckets(kBuckets),
+    nCrates(nCrates_), fullMask(nCrates_ >= 32 ? 0xFFFFFFFFu : ( 1u << nCrates_ ) - 1), tolerance(tolerance_),
+    timeout(std::chrono::duration_cast<Clock::duration>( std::chrono::duration<double>( timeout_ ) )),
+    bucketShift(0), newestTime(std::numeric_limits<PackedTime>::min()), releasedTime(std::numeric_limits<PackedTime>::min()),
+    lastGtid(0), haveGtid(false), built(0), partial(0), late(0), mismatched(0), running(false)
+{
+  if( nCrates_ == 0 || nCrates_ > kMaxCrates )
+    throw std::invalid_argument( "EventBuilder: number of crates must be 1 to 32" );
+  if( tolerance_ < 0 || timeout_ < 0.0 )
+    throw std::invalid_argument( "EventBuilder: tolerance and timeout must not be negative" );
+  while( ( PackedTime( 1 ) << bucketShift ) <= tolerance_ )
+    bucketShift++;
+  for( unsigned crate = 0; crate < nCrates_; crate++ )
+    queues.emplace_back( new SpscQueue<Fragment>( queueSize ) );
+}
+
+inline void
+EventBuilder::Assemble( const Fragment& fragment )
+{
+  if( fragment.time < releasedTime )
+    {
+      Count( late, 1 );
+      return;
+    }
+  const uint32_t crateBit = 1u << fragment.crate;
+  const uint32_t gtid = fragment.gtid & kGtidMask;
+  // Buckets of first times within the tolerance, at most 3 as the width exceeds the tolerance
+  const PackedTime lowBucket = ( fragment.time - tolerance ) >> bucketShift;
+  const PackedTime highBucket = ( fragment.time + tolerance ) >> bucketShift;
+  bool otherGtid = false;
+  for( PackedTime bucket = lowBucket; bucket <= highBucket; bucket++ )
+    {
+      const std::vector<uint32_t>& open = buckets[static_cast<size_t>( bucket ) & ( kBuckets - 1 )];
+      for( size_t i = 0; i < open.size(); i++ )
+        {
+          Event& event = events[open[i]];
+          const PackedTime difference = fragment.time - event.firstTime;
+          if( difference < -tolerance || difference > tolerance || ( event.crateMask & crateBit ) != 0 )
+            continue;
+          if( event.gtid != gtid ) // Open events hold the raw GTID
+            {
+              otherGtid = true;
+              continue;
+            }
+          event.fragments[fragment.crate] = fragment;
+          event.crateMask |= crateBit;
+          if( fragment.time < event.time )
+            {
+              event.time = fragment.time;
+              order.push( Key( event.time, open[i] ) );
+            }
+          return;
+        }
+    }
+  // No match, open an event
+  Count( mismatched, otherGtid );
+  uint32_t index;
+  if( freeEvents.empty() )
+    {
+      index = static_cast<uint32_t>( events.size() );
+      events.push_back( Event() );
+    }
+  else
+    {
+      index = freeEvents.back();
+      freeEvents.pop_back();
+    }
+  Event& event = events[index];
+  event.gtid = gtid;
+  event.time = fragment.time;
+  event.firstTime = fragment.time;
+  event.crateMask = crateBit;
+  event.fragments[fragment.crate] = fragment;
+  buckets[Bucket( fragment.time )].push_back( index );
+  order.push( Key( fragment.time, index ) );
+}
+
+inline void
+EventBuilder::Close( const uint32_t index )
+{
+  std::vector<uint32_t>& open = buckets[Bucket( events[index].firstTime )];
+  const std::vector<uint32_t>::iterator position = std::find( open.begin(), open.end(), index );
+  *position = open.back();
+  open.pop_back();
+  events[index].crateMask = 0;
+  freeEvents.push_back( index );
+}
+
+template<class TSink>
+size_t
+EventBuilder::Release( const PackedTime watermark, TSink& sink )
+{
+  size_t released = 0;
+  while( !order.empty() )
+    {
+      const Key key = order.top();
+      Event& event = events[key.second];
+      if( event.crateMask == 0 || key.first != event.time ) // Closed, or superseded by an earlier fragment
+        {
+          order.pop();
+          continue;
+        }
+      if( watermark != std::numeric_limits<PackedTime>::max() && event.firstTime + tolerance >= watermark )
+        break;
+      order.pop();
+      // Unwrap the GTID against the last released event, events are released in time order
+      const uint32_t raw = static_cast<uint32_t>( event.gtid ) & kGtidMask;
+      if( haveGtid )
+        {
+          const int32_t step = static_cast<int32_t>( ( ( raw - static_cast<uint32_t>( lastGtid ) ) & kGtidMask ) << 8 ) >> 8;
+          event.gtid = lastGtid + step;
+        }
+      else
+        event.gtid = raw;
+      lastGtid = event.gtid;
+      haveGtid = true;
+      releasedTime = event.time;
+      Count( built, 1 );
+      Count( partial, event.crateMask != fullMask );
+      sink( static_cast<const Event&>( event ) );
+      Close( key.second );
+      released++;
+    }
+  return released;
+}
+
+template<class TSink>
+size_t
+EventBuilder::Process( TSink sink )
+{
+  const Clock::time_point now = Clock::now();
+  PackedTime watermark = std::numeric_limits<PackedTime>::max();
+  bool waiting = false;
+  for( unsigned crate = 0; crate < nCrates; crate++ )
+    {
+      Fragment fragment;
+      size_t taken = 0;
+      for( ; taken < kDrainBatch && queues[crate]->Pop( fragment ); taken++ )
+        {
+          fragment.crate = crate;
+          crateTimes[crate] = std::max( crateTimes[crate], fragment.time );
+          newestTime = std::max( newestTime, fragment.time );
+          Assemble( fragment );
+        }
+      if( taken != 0 )
+        crateSeen[crate] = now;
+      if( now - crateSeen[crate] <= timeout )
+        {
+          watermark = std::min( watermark, crateTimes[crate] );
+          waiting = true;
+        }
+    }
+  if( !waiting ) // Every crate is silent, release all that nothing can join
+    watermark = newestTime == std::numeric_limits<PackedTime>::min() ? newestTime : newestTime - tolerance;
+  return Release( watermark, sink );
+}
+
+template<class TSink>
+size_t
+EventBuilder::Flush( TSink sink )
+{
+  size_t released = Process( sink );
+  // Keep draining until the producers' queues are empty, then release everything
+  for( ;; )
+    {
+      bool empty = true;
+      for( unsigned crate = 0; crate < nCrates; crate++ )
+        empty = empty && queues[crate]->GetSize() == 0;
+      if( empty )
+        break;
+      released += Process( sink );
+    }
+  return released + Release( std::numeric_limits<PackedTime>::max(), sink );
+}
+
+inline void
+EventBuilder::Start( const Sink& sink )
+{
+  if( thread.joinable() )
+    throw std::logic_error( "EventBuilder: already started" );
+  threadSink = sink;
+  running.store( true );
+  thread = std::thread( [this]()
+                        {
+                          // By reference, Process would copy the std::function on every pass
+                          while( running.load( std::memory_order_relaxed ) )
+                            if( Process( std::ref( threadSink ) ) == 0 )
+                              std::this_thread::yield();
+                        } );
+}
+
+inline void
+EventBuilder::Stop()
+{
+  if( !thread.joinable() )
+    return;
+  running.store( false );
+  thread.join();
+  Flush( std::ref( threadSink ) );
+}
+
+#endif
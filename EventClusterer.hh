@@ -0,0 +1,156 @@
+////////////////////////////////////////////////////////////////////
+/// \class EventClusterer
+///
+/// \brief  Groups time sorted hits into events separated by time gaps
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file for the batch time kernels.
+///
+/// \details A new event starts at hit i whenever the gap to hit i-1
+///         exceeds the maximum gap. The boundaries are found with an
+///         adjacent difference and compare over the packed times, four
+///         hits per AVX2 instruction when available, and the hits are
+///         split into chunks over threads. Each chunk also reads the
+///         hit before its first, so the chunk results stitch together
+///         by concatenation and events spanning chunks are not split.
+///
+///         Events are returned as [begin, end) hit index ranges.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_EventClusterer__
+#define __RAT_DS_EventClusterer__
+
+#include <PackedTime.hh>
+#include <TimeParallel.hh>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+class EventClusterer
+{
+public:
+  typedef std::pair<size_t, size_t> Range; ///< [begin, end) hit indices of an event
+
+  /// Construct the clusterer
+  ///
+  /// @param[in] maxGap_ largest gap (ns) between hits in the same event
+  /// @param[in] threads_ to use, 0 for the hardware concurrency
+  EventClusterer( const PackedTime maxGap_, const unsigned threads_ = 0 ) : maxGap(maxGap_), threads(threads_) { };
+
+  /// Group hits into events
+  ///
+  /// @param[in] times of the hits, sorted
+  /// @param[in] count of hits
+  /// @param[out] events hit index ranges, replaces the contents
+  inline void Cluster( const PackedTime* times, const size_t count, std::vector<Range>& events ) const;
+
+  /// Group hits into events
+  ///
+  /// @param[in] times of the hits, sorted
+  /// @param[in] count of hits
+  /// @return events hit index ranges
+  std::vector<Range> Cluster( const PackedTime* times, const size_t count ) const
+  {
+    std::vector<Range> events;
+    Cluster( times, count, events );
+    return events;
+  }
+
+  /// Find the hits in [begin, end) that start a new event, begin must be at least 1
+  ///
+  /// @param[in] times of the hits, sorted
+  /// @param[in] begin first hit to test
+  /// @param[in] end one past the last hit to test
+  /// @param[in] maxGap largest gap (ns) between hits in the same event
+  /// @param[out] boundaries room for end - begin indices
+  /// @return number of boundaries written
+  static inline size_t FindBoundaries( const PackedTime* times, const size_t begin, const size_t end,
+                                       const PackedTime maxGap, size_t* boundaries );
+
+  /// Get the largest gap
+  ///
+  /// @return max gap (ns)
+  PackedTime GetMaxGap() const { return maxGap; }
+
+protected:
+  static constexpr size_t kBlockSize = 4096; ///< Hits tested per staging block
+  static constexpr size_t kMinChunk = 1 << 16; ///< Smallest chunk worth a thread
+
+  PackedTime maxGap; ///< Largest gap (ns) between hits in the same event
+  unsigned threads; ///< Threads to use, 0 for the hardware concurrency
+};
+
+inline size_t
+EventClusterer::FindBoundaries( const PackedTime* times, const size_t begin, const size_t end,
+                                const PackedTime maxGap, size_t* boundaries )
+{
+  size_t found = 0;
+  size_t i = begin;
+#if defined(__AVX2__)
+  const __m256i limit = _mm256_set1_epi64x( maxGap );
+  for( ; i + 4 <= end; i += 4 )
+    {
+      const __m256i current = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( times + i ) );
+      const __m256i previous = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( times + i - 1 ) );
+      const __m256i gap = _mm256_sub_epi64( current, previous );
+      unsigned mask = _mm256_movemask_pd( _mm256_castsi256_pd( _mm256_cmpgt_epi64( gap, limit ) ) );
+      while( mask != 0 ) // Boundaries are rare, this rarely loops
+        {
+          boundaries[found++] = i + __builtin_ctz( mask );
+          mask &= mask - 1;
+        }
+    }
+#endif
+  // Branchless compaction, always write and only advance on a boundary
+  for( ; i < end; i++ )
+    {
+      boundaries[found] = i;
+      found += ( times[i] - times[i - 1] ) > maxGap;
+    }
+  return found;
+}
+
+inline void
+EventClusterer::Cluster( const PackedTime* times, const size_t count, std::vector<Range>& events ) const
+{
+  events.clear();
+  if( count == 0 )
+    return;
+  // Chunks cover hits [1, count), hit 0 always starts the first event
+  const size_t tested = count - 1;
+  const size_t chunks = TimeParallel::ChunkCount( tested, threads, kMinChunk );
+  std::vector< std::vector<size_t> > chunkBoundaries( chunks );
+  TimeParallel::ForEachChunk( tested, threads, kMinChunk,
+                              [&]( const size_t chunk, const size_t begin, const size_t end )
+                              {
+                                std::vector<size_t>& out = chunkBoundaries[chunk];
+                                size_t block[kBlockSize];
+                                for( size_t first = begin + 1; first < end + 1; first += kBlockSize )
+                                  {
+                                    const size_t last = std::min( first + kBlockSize, end + 1 );
+                                    const size_t found = FindBoundaries( times, first, last, maxGap, block );
+                                    out.insert( out.end(), block, block + found );
+                                  }
+                              } );
+  // Stitch the chunks, each event ends where the next begins
+  size_t total = 0;
+  for( size_t chunk = 0; chunk < chunks; chunk++ )
+    total += chunkBoundaries[chunk].size();
+  events.reserve( total + 1 );
+  size_t eventBegin = 0;
+  for( size_t chunk = 0; chunk < chunks; chunk++ )
+    for( size_t i = 0; i < chunkBoundaries[chunk].size(); i++ )
+      {
+        events.push_back( Range( eventBegin, chunkBoundaries[chunk][i] ) );
+        eventBegin = chunkBoundaries[chunk][i];
+      }
+  events.push_back( Range( eventBegin, count ) );
+}
+
+#endif
@@ -0,0 +1,285 @@
+////////////////////////////////////////////////////////////////////
+/// \class InterArrivalStats
+///
+/// \brief  Streaming statistics of the gaps between consecutive times
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file for detector health monitoring.
+///
+/// \details Fed with consecutive packed times, each new time adds the
+///         gap to the previous one. Three summaries are kept, all of
+///         bounded size and all mergeable:
+///          - count, mean and variance (Welford, merged with Chan et al.)
+///          - a KllSketch of the gaps for quantiles
+///          - a LogHistogram, 4 bins per octave of ns
+///
+///         Use one object per thread (or node) and Merge() them, gaps
+///         are only taken within each object's own stream. Serialise()
+///         and Deserialise() carry the state between nodes.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_InterArrivalStats__
+#define __RAT_DS_InterArrivalStats__
+
+#include <KllSketch.hh>
+#include <PackedTime.hh>
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////
+/// \class LogHistogram
+///
+/// \brief  Fixed size histogram of ns gaps with logarithmic bins
+///
+/// \details Bin 0 holds gaps <= 0, the rest split each octave [2^m, 2^m+1)
+///         into 4 bins using the two bits below the leading one, so the
+///         bin is found with a count leading zeros and no floating point.
+///
+////////////////////////////////////////////////////////////////////
+class LogHistogram
+{
+public:
+  static constexpr size_t kBinsPerOctave = 4;
+  static constexpr size_t kBins = 1 + 64 * kBinsPerOctave;
+
+  /// Construct an empty histogram
+  LogHistogram() { Reset(); };
+
+  /// Empty the histogram
+  void Reset() { std::memset( bins, 0, sizeof( bins ) ); }
+
+  /// Add a gap
+  ///
+  /// @param[in] gap in ns
+  void Fill( const int64_t gap ) { bins[GetBin( gap )]++; }
+
+  /// Add another histogram to this
+  ///
+  /// @param[in] rhs histogram to add
+  void Merge( const LogHistogram& rhs )
+  {
+    for( size_t i = 0; i < kBins; i++ )
+      bins[i] += rhs.bins[i];
+  }
+
+  /// Get the bin holding a gap
+  ///
+  /// @param[in] gap in ns
+  /// @return bin index in [0, kBins)
+  static size_t GetBin( const int64_t gap )
+  {
+    const uint64_t positive = gap > 0 ? static_cast<uint64_t>( gap ) : 0;
+    const unsigned octave = 63 - __builtin_clzll( positive | 1 );
+    // Two bits below the leading one, shifted up for the lowest octaves
+    const uint64_t fraction = octave >= 2 ? ( positive >> ( octave - 2 ) ) : ( positive << ( 2 - octave ) );
+    const size_t bin = 1 + octave * kBinsPerOctave + ( fraction & 3 );
+    return gap > 0 ? bin : 0;
+  }
+
+  /// Get the smallest gap in a bin
+  ///
+  /// @param[in] bin index
+  /// @return low edge in ns
+  static double GetBinLowEdge( const size_t bin )
+  {
+    if( bin == 0 )
+      return 0.0;
+    const size_t octave = ( bin - 1 ) / kBinsPerOctave;
+    const size_t quarter = ( bin - 1 ) % kBinsPerOctave;
+    return std::ldexp( 1.0 + quarter / 4.0, static_cast<int>( octave ) );
+  }
+
+  /// Get the entries in a bin
+  ///
+  /// @param[in] bin index
+  /// @return entries
+  uint64_t GetBinContent( const size_t bin ) const { return bins[bin]; }
+
+  /// Add entries to a bin
+  ///
+  /// @param[in] bin index
+  /// @param[in] entries to add
+  void AddBinContent( const size_t bin, const uint64_t entries ) { bins[bin] += entries; }
+
+protected:
+  uint64_t bins[kBins]; ///< Entries per bin
+};
+
+class InterArrivalStats
+{
+public:
+  /// Construct empty statistics
+  ///
+  /// @param[in] k_ accuracy parameter of the quantile sketch
+  /// @param[in] seed_ of the quantile sketch, use a different one per thread
+  InterArrivalStats( const uint32_t k_ = 200, const uint64_t seed_ = 1 )
+    : count(0), mean(0.0), m2(0.0), last(0), hasLast(false), sketch(k_, seed_) { };
+
+  /// Add the next time of the stream
+  ///
+  /// @param[in] time of the next event
+  void Fill( const PackedTime time )
+  {
+    if( hasLast )
+      FillGap( time - last );
+    last = time;
+    hasLast = true;
+  }
+
+  /// Add the next times of the stream
+  ///
+  /// @param[in] times of the next events, in stream order
+  /// @param[in] nTimes number of times
+  inline void Fill( const PackedTime* times, const size_t nTimes );
+
+  /// Add a gap directly
+  ///
+  /// @param[in] gap in ns
+  void FillGap( const int64_t gap )
+  {
+    count++;
+    const double value = static_cast<double>( gap );
+    const double delta = value - mean;
+    mean += delta / static_cast<double>( count );
+    m2 += delta * ( value - mean );
+    sketch.Fill( gap );
+    histogram.Fill( gap );
+  }
+
+  /// Merge statistics from another stream
+  ///
+  /// @param[in] rhs statistics to merge
+  inline void Merge( const InterArrivalStats& rhs );
+
+  /// Get the number of gaps
+  ///
+  /// @return count
+  uint64_t GetCount() const { return count; }
+
+  /// Get the mean gap
+  ///
+  /// @return mean in ns
+  double GetMean() const { return mean; }
+
+  /// Get the sample variance of the gaps
+  ///
+  /// @return variance in ns^2, 0 for fewer than 2 gaps
+  double GetVariance() const { return count > 1 ? m2 / static_cast<double>( count - 1 ) : 0.0; }
+
+  /// Get the approximate gap at a quantile
+  ///
+  /// @param[in] fraction in [0, 1]
+  /// @return gap in ns
+  int64_t GetQuantile( const double fraction ) const { return sketch.GetQuantile( fraction ); }
+
+  /// Get the quantile sketch
+  ///
+  /// @return the sketch
+  const KllSketch& GetSketch() const { return sketch; }
+
+  /// Get the log binned histogram
+  ///
+  /// @return the histogram
+  const LogHistogram& GetHistogram() const { return histogram; }
+
+  /// Append the statistics to a byte buffer
+  ///
+  /// @param[out] buffer to append to
+  inline void Serialise( std::vector<char>& buffer ) const;
+
+  /// Replace these statistics with ones from a byte buffer
+  ///
+  /// @param[in] data buffer written by Serialise
+  /// @param[in] size of the buffer
+  /// @return bytes consumed
+  inline size_t Deserialise( const char* data, const size_t size );
+
+protected:
+  uint64_t count; ///< Number of gaps
+  double mean; ///< Running mean gap
+  double m2; ///< Running sum of squared deviations
+  PackedTime last; ///< Previous time of the stream
+  bool hasLast; ///< Has the stream started?
+  KllSketch sketch; ///< Quantiles of the gaps
+  LogHistogram histogram; ///< Log binned gaps
+};
+
+inline void
+InterArrivalStats::Fill( const PackedTime* times, const size_t nTimes )
+{
+  if( nTimes == 0 )
+    return;
+  Fill( times[0] );
+  for( size_t i = 1; i < nTimes; i++ )
+    FillGap( times[i] - times[i - 1] );
+  last = times[nTimes - 1];
+}
+
+inline void
+InterArrivalStats::Merge( const InterArrivalStats& rhs )
+{
+  // The sketch first, it throws on a different k before anything has changed
+  sketch.Merge( rhs.sketch );
+  if( rhs.count > 0 )
+    {
+      const double total = static_cast<double>( count + rhs.count );
+      const double delta = rhs.mean - mean;
+      m2 += rhs.m2 + delta * delta * static_cast<double>( count ) * static_cast<double>( rhs.count ) / total;
+      mean += delta * static_cast<double>( rhs.count ) / total;
+      count += rhs.count;
+    }
+  histogram.Merge( rhs.histogram );
+}
+
+inline void
+InterArrivalStats::Serialise( std::vector<char>& buffer ) const
+{
+  const size_t offset = buffer.size();
+  buffer.resize( offset + sizeof( count ) + sizeof( mean ) + sizeof( m2 ) + sizeof( uint64_t ) * LogHistogram::kBins );
+  char* out = buffer.data() + offset;
+  std::memcpy( out, &count, sizeof( count ) );
+  out += sizeof( count );
+  std::memcpy( out, &mean, sizeof( mean ) );
+  out += sizeof( mean );
+  std::memcpy( out, &m2, sizeof( m2 ) );
+  out += sizeof( m2 );
+  for( size_t i = 0; i < LogHistogram::kBins; i++, out += sizeof( uint64_t ) )
+    {
+      const uint64_t content = histogram.GetBinContent( i );
+      std::memcpy( out, &content, sizeof( uint64_t ) );
+    }
+  sketch.Serialise( buffer );
+}
+
+inline size_t
+InterArrivalStats::Deserialise( const char* data, const size_t size )
+{
+  const size_t fixed = sizeof( count ) + sizeof( mean ) + sizeof( m2 ) + sizeof( uint64_t ) * LogHistogram::kBins;
+  if( size < fixed )
+    throw std::length_error( "InterArrivalStats::Deserialise: truncated buffer" );
+  // Into a temporary, so a bad sketch leaves these statistics as they were
+  InterArrivalStats parsed;
+  std::memcpy( &parsed.count, data, sizeof( count ) );
+  data += sizeof( count );
+  std::memcpy( &parsed.mean, data, sizeof( mean ) );
+  data += sizeof( mean );
+  std::memcpy( &parsed.m2, data, sizeof( m2 ) );
+  data += sizeof( m2 );
+  for( size_t i = 0; i < LogHistogram::kBins; i++, data += sizeof( uint64_t ) )
+    {
+      uint64_t content = 0;
+      std::memcpy( &content, data, sizeof( uint64_t ) );
+      parsed.histogram.AddBinContent( i, content );
+    }
+  const size_t consumed = fixed + parsed.sketch.Deserialise( data, size - fixed );
+  *this = std::move( parsed );
+  return consumed;
+}
+
+#endif
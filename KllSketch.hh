@@ -0,0 +1,308 @@
+////////////////////////////////////////////////////////////////////
+/// \class KllSketch
+///
+/// \brief  Mergeable streaming quantile sketch of integer values
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file for the streaming time statistics.
+///
+/// \details Implements the KLL sketch (Karnin, Lang & Liberty 2016).
+///         Values are held in a stack of compactors, an item at level
+///         h stands for 2^h inputs. When the sketch is full the lowest
+///         over capacity level is sorted and every other item (random
+///         offset) is promoted. Capacities shrink geometrically towards
+///         the lower levels so memory is O(k log(n/k)) and the rank
+///         error is roughly 1.7 / k.
+///
+///         Two sketches with the same k merge by concatenating their
+///         levels and compacting, so per thread sketches can be reduced
+///         and sketches from other nodes merged after Serialise().
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_KllSketch__
+#define __RAT_DS_KllSketch__
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+class KllSketch
+{
+public:
+  /// Construct the sketch
+  ///
+  /// @param[in] k_ accuracy parameter, the top level capacity
+  /// @param[in] seed_ for the compaction coin flips
+  KllSketch( const uint32_t k_ = 200, const uint64_t seed_ = 1 )
+    : k(std::max<uint32_t>( k_, 8 )), count(0), random(seed_ | 1),
+      minimum(std::numeric_limits<int64_t>::max()), maximum(std::numeric_limits<int64_t>::min()),
+      retained(0), capacity(k), levels(1) { };
+
+  /// Add a value
+  ///
+  /// @param[in] value to add
+  void Fill( const int64_t value )
+  {
+    levels[0].push_back( value );
+    count++;
+    minimum = std::min( minimum, value );
+    maximum = std::max( maximum, value );
+    if( ++retained >= capacity )
+      Compress();
+  }
+
+  /// Merge another sketch into this
+  ///
+  /// @param[in] rhs sketch with the same k
+  inline void Merge( const KllSketch& rhs );
+
+  /// Get the approximate value at a quantile
+  ///
+  /// @param[in] fraction in [0, 1]
+  /// @return the value, 0 if empty
+  inline int64_t GetQuantile( const double fraction ) const;
+
+  /// Get the approximate fraction of values <= value
+  ///
+  /// @param[in] value to rank
+  /// @return the normalised rank in [0, 1]
+  inline double GetRank( const int64_t value ) const;
+
+  /// Get the number of values added
+  ///
+  /// @return count
+  uint64_t GetCount() const { return count; }
+
+  /// Get the smallest value added
+  ///
+  /// @return minimum, exact
+  int64_t GetMinimum() const { return minimum; }
+
+  /// Get the largest value added
+  ///
+  /// @return maximum, exact
+  int64_t GetMaximum() const { return maximum; }
+
+  /// Get the number of retained items, a measure of memory
+  ///
+  /// @return retained items
+  size_t GetRetained() const { return retained; }
+
+  /// Append the sketch to a byte buffer
+  ///
+  /// @param[out] buffer to append to
+  inline void Serialise( std::vector<char>& buffer ) const;
+
+  /// Replace this sketch with one from a byte buffer
+  ///
+  /// @param[in] data buffer written by Serialise
+  /// @param[in] size of the buffer
+  /// @return bytes consumed
+  inline size_t Deserialise( const char* data, const size_t size );
+
+protected:
+  /// Get the capacity of level h, the top level has capacity k
+  inline size_t LevelCapacity( const size_t h ) const;
+
+  /// Compact the lowest full levels until the sketch is within capacity
+  inline void Compress();
+
+  /// Recount the retained items and total capacity after the levels change
+  inline void Recount();
+
+  /// Coin flip for the compaction offset
+  uint64_t Flip()
+  {
+    random ^= random << 13;
+    random ^= random >> 7;
+    random ^= random << 17;
+    return random >> 63;
+  }
+
+  template<class T>
+  static void Append( std::vector<char>& buffer, const T& value )
+  {
+    const char* bytes = reinterpret_cast<const char*>( &value );
+    buffer.insert( buffer.end(), bytes, bytes + sizeof( T ) );
+  }
+
+  template<class T>
+  static size_t Extract( const char* data, const size_t size, size_t offset, T& value )
+  {
+    if( offset + sizeof( T ) > size )
+      throw std::length_error( "KllSketch::Deserialise: truncated buffer" );
+    std::memcpy( &value, data + offset, sizeof( T ) );
+    return offset + sizeof( T );
+  }
+
+  uint32_t k; ///< Accuracy parameter
+  uint64_t count; ///< Number of values added
+  uint64_t random; ///< Xorshift state for the coin flips
+  int64_t minimum; ///< Exact minimum
+  int64_t maximum; ///< Exact maximum
+  size_t retained; ///< Items held over all levels
+  size_t capacity; ///< Sum of the level capacities
+  std::vector< std::vector<int64_t> > levels; ///< Compactors, level h items weigh 2^h
+};
+
+inline size_t
+KllSketch::LevelCapacity( const size_t h ) const
+{
+  const size_t depth = levels.size() - 1 - h;
+  const double scaled = std::ceil( k * std::pow( 2.0 / 3.0, static_cast<double>( depth ) ) );
+  return std::max<size_t>( 2, static_cast<size_t>( scaled ) );
+}
+
+inline void
+KllSketch::Compress()
+{
+  while( retained >= capacity )
+    {
+      size_t h = 0;
+      while( levels[h].size() < LevelCapacity( h ) )
+        h++;
+      if( h + 1 == levels.size() )
+        levels.push_back( std::vector<int64_t>() );
+      std::vector<int64_t>& level = levels[h];
+      std::sort( level.begin(), level.end() );
+      // An odd item out stays behind so the total weight is conserved
+      const bool odd = level.size() % 2 == 1;
+      const int64_t leftover = odd ? level.back() : 0;
+      const size_t paired = level.size() - ( odd ? 1 : 0 );
+      std::vector<int64_t>& above = levels[h + 1];
+      for( size_t i = Flip(); i < paired; i += 2 )
+        above.push_back( level[i] );
+      level.clear();
+      if( odd )
+        level.push_back( leftover );
+      Recount();
+    }
+}
+
+inline void
+KllSketch::Recount()
+{
+  retained = 0;
+  capacity = 0;
+  for( size_t h = 0; h < levels.size(); h++ )
+    {
+      retained += levels[h].size();
+      capacity += LevelCapacity( h );
+    }
+}
+
+inline void
+KllSketch::Merge( const KllSketch& rhs )
+{
+  if( rhs.k != k )
+    throw std::invalid_argument( "KllSketch::Merge: sketches have different k" );
+  if( rhs.count == 0 )
+    return;
+  while( levels.size() < rhs.levels.size() )
+    levels.push_back( std::vector<int64_t>() );
+  for( size_t h = 0; h < rhs.levels.size(); h++ )
+    levels[h].insert( levels[h].end(), rhs.levels[h].begin(), rhs.levels[h].end() );
+  count += rhs.count;
+  minimum = std::min( minimum, rhs.minimum );
+  maximum = std::max( maximum, rhs.maximum );
+  Recount();
+  Compress();
+}
+
+inline int64_t
+KllSketch::GetQuantile( const double fraction ) const
+{
+  if( count == 0 )
+    return 0;
+  if( fraction <= 0.0 )
+    return minimum;
+  if( fraction >= 1.0 )
+    return maximum;
+  std::vector< std::pair<int64_t, uint64_t> > weighted;
+  weighted.reserve( GetRetained() );
+  for( size_t h = 0; h < levels.size(); h++ )
+    for( size_t i = 0; i < levels[h].size(); i++ )
+      weighted.push_back( std::make_pair( levels[h][i], uint64_t( 1 ) << h ) );
+  std::sort( weighted.begin(), weighted.end() );
+  const double target = fraction * static_cast<double>( count );
+  uint64_t cumulative = 0;
+  for( size_t i = 0; i < weighted.size(); i++ )
+    {
+      cumulative += weighted[i].second;
+      if( static_cast<double>( cumulative ) >= target )
+        return weighted[i].first;
+    }
+  return maximum;
+}
+
+inline double
+KllSketch::GetRank( const int64_t value ) const
+{
+  if( count == 0 )
+    return 0.0;
+  uint64_t below = 0;
+  for( size_t h = 0; h < levels.size(); h++ )
+    for( size_t i = 0; i < levels[h].size(); i++ )
+      below += ( levels[h][i] <= value ) ? ( uint64_t( 1 ) << h ) : 0;
+  return static_cast<double>( below ) / static_cast<double>( count );
+}
+
+inline void
+KllSketch::Serialise( std::vector<char>& buffer ) const
+{
+  Append( buffer, k );
+  Append( buffer, count );
+  Append( buffer, random );
+  Append( buffer, minimum );
+  Append( buffer, maximum );
+  Append( buffer, static_cast<uint32_t>( levels.size() ) );
+  for( size_t h = 0; h < levels.size(); h++ )
+    {
+      Append( buffer, static_cast<uint32_t>( levels[h].size() ) );
+      const char* bytes = reinterpret_cast<const char*>( levels[h].data() );
+      buffer.insert( buffer.end(), bytes, bytes + levels[h].size() * sizeof( int64_t ) );
+    }
+}
+
+inline size_t
+KllSketch::Deserialise( const char* data, const size_t size )
+{
+  // Into a temporary, so a bad buffer leaves this sketch as it was
+  KllSketch parsed;
+  size_t offset = 0;
+  offset = Extract( data, size, offset, parsed.k );
+  if( parsed.k < 8 )
+    throw std::invalid_argument( "KllSketch::Deserialise: k below 8" );
+  offset = Extract( data, size, offset, parsed.count );
+  offset = Extract( data, size, offset, parsed.random );
+  offset = Extract( data, size, offset, parsed.minimum );
+  offset = Extract( data, size, offset, parsed.maximum );
+  uint32_t nLevels = 0;
+  offset = Extract( data, size, offset, nLevels );
+  // Each level has at least its size, so a corrupt count cannot ask for more than the buffer holds
+  if( nLevels > ( size - offset ) / sizeof( uint32_t ) )
+    throw std::length_error( "KllSketch::Deserialise: truncated buffer" );
+  parsed.levels.assign( std::max<uint32_t>( nLevels, 1 ), std::vector<int64_t>() );
+  for( size_t h = 0; h < nLevels; h++ )
+    {
+      uint32_t items = 0;
+      offset = Extract( data, size, offset, items );
+      if( items > ( size - offset ) / sizeof( int64_t ) )
+        throw std::length_error( "KllSketch::Deserialise: truncated buffer" );
+      parsed.levels[h].resize( items );
+      if( items > 0 )
+        std::memcpy( parsed.levels[h].data(), data + offset, items * sizeof( int64_t ) );
+      offset += items * sizeof( int64_t );
+    }
+  parsed.Recount();
+  *this = std::move( parsed );
+  return offset;
+}
+
+#endif
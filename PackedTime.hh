@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////
+/// \class PackedTime
+///
+/// \brief  Flat integer representation of a SNO+ universal time
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file for the batch time kernels.
+///
+/// \details A packed time is the signed number of nanoseconds since
+///         the SNO+ epoch, t0 (midnight on 01 Jan 2010 GMT), held in
+///         a single 64 bit integer. This covers +/- 292 years at 1 ns
+///         resolution. Differences and comparisons are then single
+///         integer operations, so arrays of packed times are what the
+///         batch kernels (clustering, statistics, joins...) run on.
+///
+///         Unpacking uses floor division, so the days field carries
+///         the sign and seconds and nano seconds are never negative.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_PackedTime__
+#define __RAT_DS_PackedTime__
+
+#include <cmath>
+#include <cstddef>
+#include <stdint.h>
+
+/// Nanoseconds since t0
+typedef int64_t PackedTime;
+
+class PackedTimes
+{
+public:
+  static constexpr int64_t kNanoSecondsPerSecond = 1000000000LL;
+  static constexpr int64_t kSecondsPerDay = 86400LL;
+  static constexpr int64_t kNanoSecondsPerDay = kSecondsPerDay * kNanoSecondsPerSecond;
+  static constexpr int64_t kUnixT0Seconds = 1262304000LL; ///< t0, 2010-01-01, in seconds since 1970
+
+  /// Pack the raw universal time fields, they need not be normalised
+  ///
+  /// @param[in] days since t0
+  /// @param[in] seconds since t0
+  /// @param[in] nanoSeconds since t0, rounded to the nearest ns
+  /// @return the packed time
+  static PackedTime Pack( const int32_t days, const int32_t seconds, const double nanoSeconds )
+  {
+    return static_cast<int64_t>( days ) * kNanoSecondsPerDay
+      + static_cast<int64_t>( seconds ) * kNanoSecondsPerSecond
+      + static_cast<int64_t>( std::llround( nanoSeconds ) );
+  }
+
+  /// Pack any time class with the UniversalTime accessors
+  ///
+  /// @param[in] time to pack
+  /// @return the packed time
+  template<class TTime>
+  static PackedTime Pack( const TTime& time )
+  {
+    return Pack( time.GetDays(), time.GetSeconds(), time.GetNanoSeconds() );
+  }
+
+  /// Pack an array of times
+  ///
+  /// @param[in] times to pack
+  /// @param[in] count of times
+  /// @param[out] packed array of count times
+  template<class TTime>
+  static void Pack( const TTime* times, const size_t count, PackedTime* packed )
+  {
+    for( size_t i = 0; i < count; i++ )
+      packed[i] = Pack( times[i] );
+  }
+
+  /// Unpack into canonical fields
+  ///
+  /// @param[in] time to unpack
+  /// @param[out] days since t0, carries the sign
+  /// @param[out] seconds in [0, 86400)
+  /// @param[out] nanoSeconds in [0, 1e9)
+  static void Unpack( const PackedTime time, int32_t& days, int32_t& seconds, double& nanoSeconds )
+  {
+    const int64_t day = FloorDivide( time, kNanoSecondsPerDay );
+    const int64_t remainder = time - day * kNanoSecondsPerDay;
+    days = static_cast<int32_t>( day );
+    seconds = static_cast<int32_t>( remainder / kNanoSecondsPerSecond );
+    nanoSeconds = static_cast<double>( remainder % kNanoSecondsPerSecond );
+  }
+
+  /// Floor division, rounds towards minus infinity for either sign of numerator
+  ///
+  /// @param[in] numerator
+  /// @param[in] denominator must be positive
+  /// @return floor( numerator / denominator )
+  static int64_t FloorDivide( const int64_t numerator, const int64_t denominator )
+  {
+    const int64_t quotient = numerator / denominator;
+    return quotient - ( ( numerator % denominator ) < 0 );
+  }
+};
+
+#endif
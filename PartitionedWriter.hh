@@ -0,0 +1,640 @@
+////////////////////////////////////////////////////////////////////
+/// \class PartitionedWriter
+///
+/// \brief  Writes events into time sorted files, one per time bucket
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file, output that time range queries can skip through.
+///
+/// \details Events are routed by their packed time into partitions of
+///         a fixed width, hourly by default, aligned to t0. Each
+///         partition buffers its events and a full buffer is handed to
+///         a pool of writer threads, which sort it by time and write it
+///         as a chunk file. Close merges the chunks of every partition
+///         into one sorted file, part_<index>.dat with index the number
+///         of widths since t0, on the writer threads as well.
+///
+///         A text manifest, manifest.txt, lists every file with its
+///         partition, first and last time and event count. It is
+///         rewritten, through a rename so readers never see half of it,
+///         after every file written. PartitionManifest::Select gives the
+///         files a time range touches and ReadRange reads just those,
+///         and of each only the slice in the range, found by a binary
+///         search that reads one record per step.
+///
+///         Events must be trivially copyable with a PackedTime member
+///         named time, files hold them raw and native endian. Add is
+///         called from one thread and blocks only if the writers fall
+///         more than two buffers per thread behind.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_PartitionedWriter__
+#define __RAT_DS_PartitionedWriter__
+
+#include <PackedTime.hh>
+#include <TimeParallel.hh>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// The files of a PartitionedWriter directory and their time spans
+class PartitionManifest
+{
+public:
+  struct Entry
+  {
+    std::string file; ///< Name within the directory
+    int64_t partition; ///< Widths since t0
+    PackedTime first; ///< Earliest event time
+    PackedTime last; ///< Latest event time
+    uint64_t count; ///< Number of events
+  };
+
+  /// Construct an empty manifest
+  ///
+  /// @param[in] width_ of the partitions (ns)
+  /// @param[in] recordSize_ bytes per event
+  PartitionManifest( const PackedTime width_ = 0, const size_t recordSize_ = 0 ) : width(width_), recordSize(recordSize_) { };
+
+  /// Read the manifest of a directory
+  ///
+  /// @param[in] directory written by a PartitionedWriter
+  /// @return the manifest, throws runtime_error if it is missing or corrupt
+  static inline PartitionManifest Load( const std::string& directory );
+
+  /// Write the manifest into a directory, replacing the old one whole
+  ///
+  /// @param[in] directory to write to
+  inline void Save( const std::string& directory ) const;
+
+  /// Get the files holding events in a time range
+  ///
+  /// @param[in] begin of the range
+  /// @param[in] end of the range, exclusive
+  /// @return the entries overlapping it, in partition order
+  inline std::vector<Entry> Select( const PackedTime begin, const PackedTime end ) const;
+
+  /// Get the partition width
+  ///
+  /// @return width (ns)
+  PackedTime GetWidth() const { return width; }
+
+  /// Get the bytes per event
+  ///
+  /// @return record size
+  size_t GetRecordSize() const { return recordSize; }
+
+  std::vector<Entry> entries; ///< Every file, in partition order
+
+protected:
+  PackedTime width; ///< Partition width (ns)
+  size_t recordSize; ///< Bytes per event
+};
+
+template<class T>
+class PartitionedWriter
+{
+  static_assert( std::is_trivially_copyable<T>::value, "PartitionedWriter: events are written raw" );
+
+public:
+  static constexpr PackedTime kHour = 3600 * PackedTimes::kNanoSecondsPerSecond; ///< Default partition width
+
+  /// Start writing into a directory, which must exist
+  ///
+  /// @param[in] directory_ for the files and manifest
+  /// @param[in] width_ of the partitions (ns)
+  /// @param[in] threads_ writer threads, 0 for the hardware concurrency
+  /// @param[in] bufferSize_ events buffered per partition before a chunk is written
+  inline PartitionedWriter( const std::string& directory_, const PackedTime width_ = kHour, const unsigned threads_ = 0,
+                            const size_t bufferSize_ = 1 << 16 );
+
+  /// Close, errors are lost, call Close to see them
+  ~PartitionedWriter()
+  {
+    try
+      {
+        Close();
+      }
+    catch( const std::exception& )
+      {
+      }
+  }
+
+  PartitionedWriter( const PartitionedWriter& ) = delete;
+  PartitionedWriter& operator=( const PartitionedWriter& ) = delete;
+
+  /// Add an event
+  ///
+  /// @param[in] event to write
+  inline void Add( const T& event );
+
+  /// Add events
+  ///
+  /// @param[in] events to write, any order
+  /// @param[in] count of events
+  void Add( const T* events, const size_t count )
+  {
+    for( size_t i = 0; i < count; i++ )
+      Add( events[i] );
+  }
+
+  /// Write every buffered event as chunks and wait for the writers
+  inline void Flush();
+
+  /// Flush, merge each partition into one file and stop the writers
+  inline void Close();
+
+  /// Get a copy of the manifest
+  ///
+  /// @return the files written so far
+  PartitionManifest GetManifest()
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    return manifest;
+  }
+
+  /// Read the events of a time range from a directory
+  ///
+  /// @param[in] directory written by a PartitionedWriter of T
+  /// @param[in] begin of the range
+  /// @param[in] end of the range, exclusive
+  /// @param[out] events in the range, appended in time order
+  /// @return number of files read
+  static inline size_t ReadRange( const std::string& directory, const PackedTime begin, const PackedTime end,
+                                  std::vector<T>& events );
+
+protected:
+  struct Job
+  {
+    int64_t partition; ///< Widths since t0
+    uint32_t chunk; ///< Chunk number, or the number of chunks for a merge
+    std::vector<T> events; ///< Events of a chunk, empty for a merge
+  };
+
+  /// Queue a job, waiting while the writers are too far behind
+  inline void Submit( Job& job );
+
+  /// Wait for the queued jobs and join the writers
+  inline void Stop();
+
+  /// Body of a writer thread
+  inline void Work();
+
+  /// Sort and write one chunk
+  inline void WriteChunk( Job& job );
+
+  /// Merge the chunks of one partition
+  inline void Merge( const int64_t partition, const uint32_t nChunks );
+
+  /// Get the file name of a chunk
+  static std::string ChunkName( const int64_t partition, const uint32_t chunk )
+  {
+    return "part_" + std::to_string( partition ) + "_" + std::to_string( chunk ) + ".dat";
+  }
+
+  /// Read count records from index first of a file, throws runtime_error if it is short
+  static void ReadRecords( const int fd, const std::string& path, const uint64_t first, const uint64_t count, T* out )
+  {
+    char* bytes = reinterpret_cast<char*>( out );
+    const uint64_t length = count * sizeof( T );
+    for( uint64_t done = 0; done < length; )
+      {
+        const ssize_t read = pread( fd, bytes + done, length - done, first * sizeof( T ) + done );
+        if( read < 0 && errno == EINTR )
+          continue;
+        if( read <= 0 )
+          throw std::runtime_error( "PartitionedWriter: " + path + " is short" );
+        done += static_cast<uint64_t>( read );
+      }
+  }
+
+  /// Get the index of the first record of a sorted file in [low, high) at or after time
+  static uint64_t LowerBound( const int fd, const std::string& path, uint64_t low, uint64_t high, const PackedTime time )
+  {
+    while( low < high )
+      {
+        const uint64_t middle = low + ( high - low ) / 2;
+        T record;
+        ReadRecords( fd, path, middle, 1, &record );
+        if( record.time < time )
+          low = middle + 1;
+        else
+          high = middle;
+      }
+    return low;
+  }
+
+  /// Record a written file in the manifest and save it, mutex held
+  inline void Record( const PartitionManifest::Entry& entry );
+
+  /// Throw the first writer error, if any, mutex held
+  void CheckError() const
+  {
+    if( !error.empty() )
+      throw std::runtime_error( "PartitionedWriter: " + error );
+  }
+
+  std::string directory; ///< Output directory
+  PackedTime width; ///< Partition width (ns)
+  size_t bufferSize; ///< Events per chunk
+  size_t maxPending; ///< Jobs queued or running before Add blocks
+  std::map<int64_t, std::vector<T> > buffers; ///< Unwritten events by partition
+  std::map<int64_t, uint32_t> chunks; ///< Chunks submitted per partition
+
+  std::mutex mutex; ///< Guards everything below
+  std::condition_variable changed; ///< Signals new jobs and finished ones
+  std::deque<Job> jobs; ///< Waiting jobs
+  size_t pending; ///< Jobs waiting or running
+  bool stopping; ///< Writers should exit
+  std::string error; ///< First writer error
+  PartitionManifest manifest; ///< Files written
+  std::vector<std::thread> writers; ///< Writer threads
+};
+
+inline PartitionManifest
+PartitionManifest::Load( const std::string& directory )
+{
+  std::ifstream in( ( directory + "/manifest.txt" ).c_str() );
+  std::string line;
+  if( !in || !std::getline( in, line ) )
+    throw std::runtime_error( "PartitionManifest: cannot read " + directory + "/manifest.txt" );
+  std::istringstream header( line );
+  std::string hash, name, widthKey, sizeKey;
+  PackedTime width = 0;
+  size_t recordSize = 0;
+  if( !( header >> hash >> name >> widthKey >> width >> sizeKey >> recordSize ) || widthKey != "width" )
+    throw std::runtime_error( "PartitionManifest: " + directory + "/manifest.txt is not a manifest" );
+  PartitionManifest manifest( width, recordSize );
+  while( std::getline( in, line ) )
+    {
+      std::istringstream fields( line );
+      Entry entry;
+      if( !( fields >> entry.file >> entry.partition >> entry.first >> entry.last >> entry.count ) )
+        throw std::runtime_error( "PartitionManifest: corrupt line in " + directory + "/manifest.txt" );
+      manifest.entries.push_back( entry );
+    }
+  return manifest;
+}
+
+inline void
+PartitionManifest::Save( const std::string& directory ) const
+{
+  const std::string path = directory + "/manifest.txt";
+  {
+    std::ofstream out( ( path + ".tmp" ).c_str() );
+    out << "# PartitionedWriter width " << width << " recordSize " << recordSize << "\n";
+    for( size_t i = 0; i < entries.size(); i++ )
+      out << entries[i].file << " " << entries[i].partition << " " << entries[i].first << " " << entries[i].last
+          << " " << entries[i].count << "\n";
+    if( !out.flush() )
+      throw std::runtime_error( "PartitionManifest: cannot write " + path + ".tmp" );
+  }
+  if( std::rename( ( path + ".tmp" ).c_str(), path.c_str() ) != 0 )
+    throw std::runtime_error( "PartitionManifest: cannot replace " + path + ": " + std::strerror( errno ) );
+}
+
+inline std::vector<PartitionManifest::Entry>
+PartitionManifest::Select( const PackedTime begin, const PackedTime end ) const
+{
+  std::vector<Entry> selected;
+  for( size_t i = 0; i < entries.size(); i++ )
+    if( entries[i].last >= begin && entries[i].first < end )
+      selected.push_back( entries[i] );
+  return selected;
+}
+
+template<class T>
+inline
+PartitionedWriter<T>::PartitionedWriter( const std::string& directory_, const PackedTime width_, const unsigned threads_,
+                                         const size_t bufferSize_ )
+  : directory(directory_), width(width_), bufferSize(std::max<size_t>( bufferSize_, 1 )), pending(0), stopping(false),
+    manifest(width_, sizeof( T ))
+{
+  if( width_ <= 0 )
+    throw std::invalid_argument( "PartitionedWriter: width must be positive" );
+  const unsigned nThreads = threads_ == 0 ? TimeParallel::DefaultThreads() : threads_;
+  maxPending = 2 * nThreads;
+  for( unsigned t = 0; t < nThreads; t++ )
+    writers.emplace_back( [this]() { Work(); } );
+}
+
+template<class T>
+inline void
+PartitionedWriter<T>::Add( const T& event )
+{
+  const int64_t partition = PackedTimes::FloorDivide( event.time, width );
+  std::vector<T>& buffer = buffers[partition];
+  if( buffer.capacity() == 0 )
+    buffer.reserve( bufferSize );
+  buffer.push_back( event );
+  if( buffer.size() >= bufferSize )
+    {
+      Job job = { partition, chunks[partition]++, std::vector<T>() };
+      job.events.swap( buffer );
+      Submit( job );
+    }
+}
+
+template<class T>
+inline void
+PartitionedWriter<T>::Submit( Job& job )
+{
+  std::unique_lock<std::mutex> lock( mutex );
+  if( writers.empty() )
+    throw std::logic_error( "PartitionedWriter: closed" );
+  changed.wait( lock, [this]() { return pending < maxPending || !error.empty(); } );
+  CheckError();
+  jobs.push_back( Job() );
+  jobs.back().partition = job.partition;
+  jobs.back().chunk = job.chunk;
+  jobs.back().events.swap( job.events );
+  pending++;
+  changed.notify_all();
+}
+
+template<class T>
+inline void
+PartitionedWriter<T>::Flush()
+{
+  for( typename std::map<int64_t, std::vector<T> >::iterator it = buffers.begin(); it != buffers.end(); ++it )
+    if( !it->second.empty() )
+      {
+        Job job = { it->first, chunks[it->first]++, std::vector<T>() };
+        job.events.swap( it->second );
+        Submit( job );
+      }
+  buffers.clear();
+  std::unique_lock<std::mutex> lock( mutex );
+  changed.wait( lock, [this]() { return pending == 0; } );
+  CheckError();
+}
+
+template<class T>
+inline void
+PartitionedWriter<T>::Close()
+{
+  if( writers.empty() )
+    return;
+  try
+    {
+      Flush();
+      // A merge job per partition, a lone chunk is just renamed
+      for( std::map<int64_t, uint32_t>::iterator it = chunks.begin(); it != chunks.end(); ++it )
+        {
+          Job job = { it->first, it->second, std::vector<T>() };
+          Submit( job );
+        }
+      chunks.clear();
+    }
+  catch( const std::exception& )
+    {
+      Stop();
+      throw;
+    }
+  Stop();
+  std::lock_guard<std::mutex> lock( mutex );
+  CheckError();
+}
+
+template<class T>
+inline void
+PartitionedWriter<T>::Stop()
+{
+  {
+    std::unique_lock<std::mutex> lock( mutex );
+    changed.wait( lock, [this]() { return pending == 0; } );
+    stopping = true;
+    changed.notify_all();
+  }
+  for( size_t t = 0; t < writers.size(); t++ )
+    writers[t].join();
+  writers.clear();
+}
+
+template<class T>
+inline void
+PartitionedWriter<T>::Work()
+{
+  std::unique_lock<std::mutex> lock( mutex );
+  for( ;; )
+    {
+      changed.wait( lock, [this]() { return stopping || !jobs.empty(); } );
+      if( jobs.empty() )
+        return;
+      Job job;
+      job.partition = jobs.front().partition;
+      job.chunk = jobs.front().chunk;
+      job.events.swap( jobs.front().events );
+      jobs.pop_front();
+      lock.unlock();
+      std::string failure;
+      try
+        {
+          if( job.events.empty() )
+            Merge( job.partition, job.chunk );
+          else
+            WriteChunk( job );
+        }
+      catch( const std::exception& exception )
+        {
+          failure = exception.what();
+        }
+      lock.lock();
+      if( !failure.empty() && error.empty() )
+        error = failure;
+      pending--;
+      changed.notify_all();
+    }
+}
+
+template<class T>
+inline void
+PartitionedWriter<T>::WriteChunk( Job& job )
+{
+  std::stable_sort( job.events.begin(), job.events.end(), []( const T& lhs, const T& rhs ) { return lhs.time < rhs.time; } );
+  const std::string name = ChunkName( job.partition, job.chunk );
+  FILE* file = std::fopen( ( directory + "/" + name ).c_str(), "wb" );
+  if( file == 0 )
+    throw std::runtime_error( "cannot create " + directory + "/" + name + ": " + std::strerror( errno ) );
+  const size_t written = std::fwrite( job.events.data(), sizeof( T ), job.events.size(), file );
+  if( std::fclose( file ) != 0 || written != job.events.size() )
+    throw std::runtime_error( "cannot write " + directory + "/" + name );
+  const PartitionManifest::Entry entry = { name, job.partition, job.events.front().time, job.events.back().time,
+                                           job.events.size() };
+  std::lock_guard<std::mutex> lock( mutex );
+  Record( entry );
+}
+
+template<class T>
+inline void
+PartitionedWriter<T>::Merge( const int64_t partition, const uint32_t nChunks )
+{
+  // Chunks in the order they were added, whatever order they were written in
+  std::vector<PartitionManifest::Entry> inputs( nChunks );
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    for( size_t i = 0; i < manifest.entries.size(); i++ )
+      for( uint32_t chunk = 0; chunk < nChunks; chunk++ )
+        if( manifest.entries[i].file == ChunkName( partition, chunk ) )
+          inputs[chunk] = manifest.entries[i];
+  }
+  const std::string name = "part_" + std::to_string( partition ) + ".dat";
+  PartitionManifest::Entry merged = { name, partition, inputs.front().first, inputs.front().last, 0 };
+  if( inputs.size() == 1 )
+    {
+      if( std::rename( ( directory + "/" + inputs[0].file ).c_str(), ( directory + "/" + name ).c_str() ) != 0 )
+        throw std::runtime_error( "cannot rename " + directory + "/" + inputs[0].file + ": " + std::strerror( errno ) );
+      merged.count = inputs[0].count;
+    }
+  else
+    {
+      // k way merge of the sorted chunks, ties go to the earlier chunk
+      const size_t kBlock = 4096;
+      std::vector<FILE*> files( inputs.size(), static_cast<FILE*>( 0 ) );
+      std::vector<std::vector<T> > blocks( inputs.size() );
+      std::vector<size_t> positions( inputs.size(), 0 );
+      typedef std::pair<PackedTime, size_t> Head;
+      std::priority_queue<Head, std::vector<Head>, std::greater<Head> > heads;
+      FILE* out = std::fopen( ( directory + "/" + name + ".tmp" ).c_str(), "wb" );
+      bool ok = out != 0;
+      for( size_t i = 0; ok && i < inputs.size(); i++ )
+        {
+          files[i] = std::fopen( ( directory + "/" + inputs[i].file ).c_str(), "rb" );
+          blocks[i].resize( kBlock );
+          ok = files[i] != 0;
+          if( ok )
+            {
+              blocks[i].resize( std::fread( blocks[i].data(), sizeof( T ), kBlock, files[i] ) );
+              if( !blocks[i].empty() )
+                heads.push( Head( blocks[i][0].time, i ) );
+            }
+        }
+      std::vector<T> output;
+      output.reserve( kBlock );
+      while( ok && !heads.empty() )
+        {
+          const size_t i = heads.top().second;
+          heads.pop();
+          output.push_back( blocks[i][positions[i]++] );
+          if( positions[i] == blocks[i].size() )
+            {
+              blocks[i].resize( kBlock );
+              blocks[i].resize( std::fread( blocks[i].data(), sizeof( T ), kBlock, files[i] ) );
+              positions[i] = 0;
+            }
+          if( positions[i] < blocks[i].size() )
+            heads.push( Head( blocks[i][positions[i]].time, i ) );
+          if( output.size() == kBlock || heads.empty() )
+            {
+              ok = std::fwrite( output.data(), sizeof( T ), output.size(), out ) == output.size();
+              merged.count += output.size();
+              merged.last = output.back().time;
+              output.clear();
+            }
+        }
+      // A read error ends a chunk early like its end of file, so it is told apart here
+      uint64_t expected = 0;
+      for( size_t i = 0; i < files.size(); i++ )
+        {
+          expected += inputs[i].count;
+          if( files[i] != 0 )
+            {
+              ok = !std::ferror( files[i] ) && ok;
+              std::fclose( files[i] );
+            }
+        }
+      ok = out != 0 && std::fclose( out ) == 0 && ok;
+      if( !ok || merged.count != expected )
+        {
+          std::remove( ( directory + "/" + name + ".tmp" ).c_str() );
+          if( !ok )
+            throw std::runtime_error( "cannot merge into " + directory + "/" + name );
+          throw std::runtime_error( "merging into " + directory + "/" + name + " read " + std::to_string( merged.count )
+                                    + " events of " + std::to_string( expected ) );
+        }
+      if( std::rename( ( directory + "/" + name + ".tmp" ).c_str(), ( directory + "/" + name ).c_str() ) != 0 )
+        throw std::runtime_error( "cannot rename " + directory + "/" + name + ": " + std::strerror( errno ) );
+      for( size_t i = 0; i < inputs.size(); i++ )
+        merged.first = std::min( merged.first, inputs[i].first );
+    }
+  std::lock_guard<std::mutex> lock( mutex );
+  std::vector<PartitionManifest::Entry>& entries = manifest.entries;
+  entries.erase( std::remove_if( entries.begin(), entries.end(),
+                                 [partition]( const PartitionManifest::Entry& entry ) { return entry.partition == partition; } ),
+                 entries.end() );
+  Record( merged );
+  // Chunks go only once the manifest points at the merged file
+  for( size_t i = 0; inputs.size() > 1 && i < inputs.size(); i++ )
+    std::remove( ( directory + "/" + inputs[i].file ).c_str() );
+}
+
+template<class T>
+inline void
+PartitionedWriter<T>::Record( const PartitionManifest::Entry& entry )
+{
+  std::vector<PartitionManifest::Entry>& entries = manifest.entries;
+  entries.insert( std::upper_bound( entries.begin(), entries.end(), entry,
+                                    []( const PartitionManifest::Entry& lhs, const PartitionManifest::Entry& rhs )
+                                    { return lhs.partition < rhs.partition; } ), entry );
+  manifest.Save( directory );
+}
+
+template<class T>
+inline size_t
+PartitionedWriter<T>::ReadRange( const std::string& directory, const PackedTime begin, const PackedTime end,
+                                 std::vector<T>& events )
+{
+  const PartitionManifest manifest = PartitionManifest::Load( directory );
+  if( manifest.GetRecordSize() != sizeof( T ) )
+    throw std::runtime_error( "PartitionedWriter: " + directory + " holds a different event type" );
+  const std::vector<PartitionManifest::Entry> selected = manifest.Select( begin, end );
+  const size_t first = events.size();
+  for( size_t f = 0; f < selected.size(); f++ )
+    {
+      const std::string path = directory + "/" + selected[f].file;
+      const int fd = open( path.c_str(), O_RDONLY );
+      if( fd < 0 )
+        throw std::runtime_error( "PartitionedWriter: cannot open " + path + ": " + std::strerror( errno ) );
+      try
+        {
+          // Files are sorted, so the range is one slice of each, found by reading log2(count) records
+          const uint64_t count = selected[f].count;
+          const uint64_t low = begin <= selected[f].first ? 0 : LowerBound( fd, path, 0, count, begin );
+          const uint64_t high = end > selected[f].last ? count : LowerBound( fd, path, low, count, end );
+          const size_t size = events.size();
+          events.resize( size + ( high - low ) );
+          ReadRecords( fd, path, low, high - low, events.data() + size );
+        }
+      catch( ... )
+        {
+          close( fd );
+          throw;
+        }
+      close( fd );
+    }
+  // Chunks of one partition overlap until Close merges them
+  std::stable_sort( events.begin() + first, events.end(), []( const T& lhs, const T& rhs ) { return lhs.time < rhs.time; } );
+  return selected.size();
+}
+
+#endif
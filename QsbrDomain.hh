@@ -0,0 +1,150 @@
+////////////////////////////////////////////////////////////////////
+/// \class QsbrDomain
+///
+/// \brief  Quiescent state based reclamation for lock free readers
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file for RcuPointer.
+///
+/// \details Tells a writer when memory it unlinked can no longer be
+///         seen by any reader. Each reader thread registers a slot and
+///         calls Quiescent between batches of work, promising it holds
+///         no pointers obtained before the call. The writer advances a
+///         global epoch after unlinking, and the memory is free to
+///         delete once every online reader has reported an epoch at
+///         least that new.
+///
+///         Reads themselves cost nothing here, the reader only pays an
+///         acquire load and a release store per Quiescent call, so that
+///         is best done per batch rather than per lookup. A reader that
+///         will block or sleep goes Offline so it does not hold up
+///         reclamation, and Online before it reads again.
+///
+///         Slots are a fixed array claimed with a compare and swap, each
+///         on its own cache line.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_QsbrDomain__
+#define __RAT_DS_QsbrDomain__
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <stdint.h>
+#include <thread>
+
+class QsbrDomain
+{
+public:
+  /// Construct the domain
+  ///
+  /// @param[in] maxReaders_ number of reader slots
+  QsbrDomain( const size_t maxReaders_ = 64 ) : slots(new Slot[maxReaders_]), maxReaders(maxReaders_), epoch(1) { };
+
+  /// Claim a reader slot, the reader starts online
+  ///
+  /// @return reader index, for the other reader calls
+  inline size_t RegisterReader();
+
+  /// Release a reader slot
+  ///
+  /// @param[in] reader index
+  void UnregisterReader( const size_t reader )
+  {
+    Offline( reader );
+    slots[reader].used.store( false, std::memory_order_release );
+  }
+
+  /// Report that the reader holds no pointers read before this call
+  ///
+  /// @param[in] reader index
+  void Quiescent( const size_t reader )
+  {
+    slots[reader].seen.store( epoch.load( std::memory_order_acquire ), std::memory_order_release );
+  }
+
+  /// Stop taking part, e.g. before blocking, the reader must hold no pointers
+  ///
+  /// @param[in] reader index
+  void Offline( const size_t reader ) { slots[reader].seen.store( 0, std::memory_order_release ); }
+
+  /// Take part again, before the next read
+  ///
+  /// @param[in] reader index
+  void Online( const size_t reader )
+  {
+    // The full fence orders the store before the reader's next loads, so
+    // a writer either sees this reader or the reader sees the new data
+    slots[reader].seen.store( epoch.load( std::memory_order_acquire ), std::memory_order_seq_cst );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+  }
+
+  /// Start a grace period, call after unlinking
+  ///
+  /// @return epoch every online reader must reach before the unlinked memory is freed
+  uint64_t Advance() { return epoch.fetch_add( 1, std::memory_order_seq_cst ) + 1; }
+
+  /// Check if a grace period is over, never blocks
+  ///
+  /// @param[in] target epoch from Advance
+  /// @return true if no reader can still see memory unlinked before it
+  inline bool IsSafe( const uint64_t target ) const;
+
+  /// Wait for a grace period, yields while readers catch up
+  ///
+  /// @param[in] target epoch from Advance
+  void Synchronize( const uint64_t target ) const
+  {
+    while( !IsSafe( target ) )
+      std::this_thread::yield();
+  }
+
+  /// Get the number of reader slots
+  ///
+  /// @return count
+  size_t GetMaxReaders() const { return maxReaders; }
+
+protected:
+  struct alignas(64) Slot
+  {
+    Slot() : seen(0), used(false) { };
+
+    std::atomic<uint64_t> seen; ///< Last epoch reported, 0 while offline
+    std::atomic<bool> used; ///< Slot is claimed
+  };
+
+  std::unique_ptr<Slot[]> slots; ///< Reader slots
+  size_t maxReaders; ///< Number of slots
+  alignas(64) std::atomic<uint64_t> epoch; ///< Current epoch, starts at 1
+};
+
+inline size_t
+QsbrDomain::RegisterReader()
+{
+  for( size_t reader = 0; reader < maxReaders; reader++ )
+    {
+      bool expected = false;
+      if( !slots[reader].used.load( std::memory_order_relaxed )
+          && slots[reader].used.compare_exchange_strong( expected, true, std::memory_order_acq_rel ) )
+        {
+          Online( reader );
+          return reader;
+        }
+    }
+  throw std::length_error( "QsbrDomain: no free reader slot" );
+}
+
+inline bool
+QsbrDomain::IsSafe( const uint64_t target ) const
+{
+  for( size_t reader = 0; reader < maxReaders; reader++ )
+    {
+      const uint64_t seen = slots[reader].seen.load( std::memory_order_seq_cst );
+      if( seen != 0 && seen < target )
+        return false;
+    }
+  return true;
+}
+
+#endif
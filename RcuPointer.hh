@@ -0,0 +1,136 @@
+////////////////////////////////////////////////////////////////////
+/// \class RcuPointer
+///
+/// \brief  Publishes immutable versions of an object to lock free readers
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file, replaces the mutex around run and calibration tables.
+///
+/// \details Read copy update: a writer builds a complete new version,
+///         e.g. a TimeIntervalTable for a new run, and Publish swaps it
+///         in with one atomic exchange. Readers call Get, one acquire
+///         load, and use the version they got until their next
+///         QsbrDomain::Quiescent call. They never block and never see a
+///         half built table.
+///
+///         Replaced versions are retired with the domain's epoch and
+///         deleted by a later Publish or Reclaim once every reader has
+///         passed a quiescent state, so reclamation never waits on a
+///         reader either. Synchronize waits for the readers instead, for
+///         writers that want the memory back now. Writers serialise on a
+///         mutex, readers never touch it.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_RcuPointer__
+#define __RAT_DS_RcuPointer__
+
+#include <QsbrDomain.hh>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+template<class T>
+class RcuPointer
+{
+public:
+  /// Construct the pointer
+  ///
+  /// @param[in] domain_ the readers register with, must outlive this
+  /// @param[in] initial version, may be empty
+  RcuPointer( QsbrDomain& domain_, std::unique_ptr<const T> initial = std::unique_ptr<const T>() )
+    : domain(domain_), current(initial.release()) { };
+
+  /// Delete every version, no reader may still use them
+  ~RcuPointer()
+  {
+    delete current.load( std::memory_order_acquire );
+  }
+
+  RcuPointer( const RcuPointer& ) = delete;
+  RcuPointer& operator=( const RcuPointer& ) = delete;
+
+  /// Get the current version, valid until the reader's next quiescent state
+  ///
+  /// @return the version, 0 if none was published
+  const T* Get() const { return current.load( std::memory_order_acquire ); }
+
+  /// Swap in a new version and retire the old one
+  ///
+  /// @param[in] next version, the pointer takes ownership
+  inline void Publish( std::unique_ptr<const T> next );
+
+  /// Delete the retired versions no reader can see, never blocks
+  ///
+  /// @return number of versions still waiting
+  inline size_t Reclaim();
+
+  /// Wait until every retired version can be deleted, then delete them
+  inline void Synchronize();
+
+  /// Get the number of retired versions not yet deleted
+  ///
+  /// @return count
+  size_t GetRetiredCount()
+  {
+    std::lock_guard<std::mutex> lock( writerMutex );
+    return retired.size();
+  }
+
+protected:
+  /// Delete the retired versions no reader can see, writerMutex held
+  inline size_t ReclaimLocked();
+
+  QsbrDomain& domain; ///< Reader registry
+  std::atomic<const T*> current; ///< Published version
+  std::mutex writerMutex; ///< Serialises writers
+  std::vector<std::pair<uint64_t, std::unique_ptr<const T> > > retired; ///< Old versions with their grace epoch
+};
+
+template<class T>
+inline void
+RcuPointer<T>::Publish( std::unique_ptr<const T> next )
+{
+  std::lock_guard<std::mutex> lock( writerMutex );
+  std::unique_ptr<const T> old( current.exchange( next.release(), std::memory_order_acq_rel ) );
+  if( old )
+    retired.push_back( std::make_pair( domain.Advance(), std::move( old ) ) );
+  ReclaimLocked();
+}
+
+template<class T>
+inline size_t
+RcuPointer<T>::Reclaim()
+{
+  std::lock_guard<std::mutex> lock( writerMutex );
+  return ReclaimLocked();
+}
+
+template<class T>
+inline void
+RcuPointer<T>::Synchronize()
+{
+  std::lock_guard<std::mutex> lock( writerMutex );
+  if( retired.empty() )
+    return;
+  domain.Synchronize( retired.back().first );
+  retired.clear();
+}
+
+template<class T>
+inline size_t
+RcuPointer<T>::ReclaimLocked()
+{
+  // Epochs are retired in increasing order, so the safe ones are a prefix
+  size_t safe = 0;
+  while( safe < retired.size() && domain.IsSafe( retired[safe].first ) )
+    safe++;
+  retired.erase( retired.begin(), retired.begin() + safe );
+  return retired.size();
+}
+
+#endif
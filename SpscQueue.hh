@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////
+/// \class SpscQueue
+///
+/// \brief  Bounded lock free queue for one producer and one consumer thread
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file, the per crate input queues of EventBuilder.
+///  2026-10-17 : Claim and Publish to fill items in place, for BinaryLogger.
+///
+/// \details A power of two ring with a head written only by the
+///         consumer and a tail written only by the producer, so Push
+///         and Pop need no atomic read-modify-write, just acquire loads
+///         and release stores. Each side keeps a cached copy of the
+///         other's index and only reloads it when the ring looks full
+///         (or empty), so in steady state the two cores do not share a
+///         written cache line per item.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_SpscQueue__
+#define __RAT_DS_SpscQueue__
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+template<class T>
+class SpscQueue
+{
+public:
+  /// Construct the queue
+  ///
+  /// @param[in] capacity_ number of items, must be a power of two
+  SpscQueue( const size_t capacity_ ) : items(capacity_), mask(capacity_ - 1), head(0), cachedTail(0), tail(0), cachedHead(0)
+  {
+    if( capacity_ == 0 || ( capacity_ & ( capacity_ - 1 ) ) != 0 )
+      throw std::invalid_argument( "SpscQueue: capacity must be a power of two" );
+  }
+
+  /// Add an item, producer thread only
+  ///
+  /// @param[in] item to add
+  /// @return false if the queue is full
+  bool Push( const T& item )
+  {
+    const size_t position = tail.load( std::memory_order_relaxed );
+    if( position - cachedHead > mask )
+      {
+        cachedHead = head.load( std::memory_order_acquire );
+        if( position - cachedHead > mask )
+          return false;
+      }
+    items[position & mask] = item;
+    tail.store( position + 1, std::memory_order_release );
+    return true;
+  }
+
+  /// Get the next free slot to fill in place, producer thread only
+  ///
+  /// @return the slot, 0 if the queue is full, Publish makes it visible
+  T* Claim()
+  {
+    const size_t position = tail.load( std::memory_order_relaxed );
+    if( position - cachedHead > mask )
+      {
+        cachedHead = head.load( std::memory_order_acquire );
+        if( position - cachedHead > mask )
+          return 0;
+      }
+    return &items[position & mask];
+  }
+
+  /// Make the slot from Claim visible to the consumer, producer thread only
+  void Publish() { tail.store( tail.load( std::memory_order_relaxed ) + 1, std::memory_order_release ); }
+
+  /// Remove the oldest item, consumer thread only
+  ///
+  /// @param[out] item removed
+  /// @return false if the queue is empty
+  bool Pop( T& item )
+  {
+    const size_t position = head.load( std::memory_order_relaxed );
+    if( position == cachedTail )
+      {
+        cachedTail = tail.load( std::memory_order_acquire );
+        if( position == cachedTail )
+          return false;
+      }
+    item = items[position & mask];
+    head.store( position + 1, std::memory_order_release );
+    return true;
+  }
+
+  /// Get the number of items, exact only when neither side is active
+  ///
+  /// @return items in the queue
+  size_t GetSize() const { return tail.load( std::memory_order_acquire ) - head.load( std::memory_order_acquire ); }
+
+  /// Get the capacity
+  ///
+  /// @return capacity
+  size_t GetCapacity() const { return mask + 1; }
+
+protected:
+  std::vector<T> items; ///< The ring
+  size_t mask; ///< Capacity - 1
+  alignas(64) std::atomic<size_t> head; ///< Next item to pop, written by the consumer
+  size_t cachedTail; ///< Consumer's copy of tail
+  alignas(64) std::atomic<size_t> tail; ///< Next slot to push, written by the producer
+  size_t cachedHead; ///< Producer's copy of head
+};
+
+#endif
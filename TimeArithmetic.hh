@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////
+/// \class UncheckedArithmetic, CheckedArithmetic, SaturatingArithmetic
+///
+/// \brief  Overflow policies for the UniversalTimeCore field arithmetic
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file, arithmetic policies of BasicUniversalTimeCore.\n
+///  2026-10-17 : constexpr, a checked overflow in a constant expression
+///               is a compile error.
+///
+/// \details Arithmetic can overflow in two places: the whole seconds
+///         held in the nanoSeconds double must fit an int64_t, and the
+///         days after adding another time or a carry must fit the
+///         int32_t days field.
+///         A policy decides what happens there:
+///          - UncheckedArithmetic, plain casts, overflow is undefined.
+///            This compiles to the same code as the unpolicied class.
+///          - CheckedArithmetic, throws std::overflow_error
+///          - SaturatingArithmetic, clamps to the earliest or latest
+///            representable time
+///
+///         Quotient bounds are +-2^62 s so the day arithmetic after it
+///         cannot overflow an int64_t.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_TimeArithmetic__
+#define __RAT_DS_TimeArithmetic__
+
+#include <limits>
+#include <stdexcept>
+#include <stdint.h>
+
+struct UncheckedArithmetic
+{
+  /// Truncate a whole seconds estimate to an integer
+  ///
+  /// @param[in] value nanoSeconds * 1e-9
+  /// @return value truncated towards zero
+  static constexpr int64_t Quotient( const double value ) { return static_cast<int64_t>( value ); }
+
+  /// Add days, a carry or the days of another time, to the days field
+  ///
+  /// @param[in] days field
+  /// @param[in] carry days to add
+  /// @param[in,out] seconds of the normalised time, unused
+  /// @param[in,out] nanoSeconds of the normalised time, unused
+  /// @return new days field
+  static constexpr int32_t Days( const int32_t days, const int64_t carry, int32_t&, double& )
+  {
+    return static_cast<int32_t>( days + carry );
+  }
+};
+
+struct CheckedArithmetic
+{
+  static constexpr double kMaxQuotient = 4611686018427387904.0; ///< 2^62 s
+
+  /// Truncate a whole seconds estimate, throw if it is not finite or too large
+  ///
+  /// @param[in] value nanoSeconds * 1e-9
+  /// @return value truncated towards zero
+  static constexpr int64_t Quotient( const double value )
+  {
+    if( !( value < kMaxQuotient && value > -kMaxQuotient ) ) // Also catches NaN
+      throw std::overflow_error( "UniversalTimeCore: nanoSeconds out of range" );
+    return static_cast<int64_t>( value );
+  }
+
+  /// Add days to the days field, throw if it overflows
+  ///
+  /// @param[in] days field
+  /// @param[in] carry days to add
+  /// @param[in,out] seconds of the normalised time, unused
+  /// @param[in,out] nanoSeconds of the normalised time, unused
+  /// @return new days field
+  static constexpr int32_t Days( const int32_t days, const int64_t carry, int32_t&, double& )
+  {
+    int32_t result = 0;
+    if( __builtin_add_overflow( days, carry, &result ) )
+      throw std::overflow_error( "UniversalTimeCore: days out of range" );
+    return result;
+  }
+};
+
+struct SaturatingArithmetic
+{
+  static constexpr double kMaxQuotient = 4611686018427387904.0; ///< 2^62 s
+
+  /// Truncate a whole seconds estimate, clamped to +-2^62, NaN gives 0
+  ///
+  /// @param[in] value nanoSeconds * 1e-9
+  /// @return value truncated towards zero
+  static constexpr int64_t Quotient( const double value )
+  {
+    if( !( value < kMaxQuotient && value > -kMaxQuotient ) )
+      return value > 0.0 ? static_cast<int64_t>( kMaxQuotient ) : value < 0.0 ? -static_cast<int64_t>( kMaxQuotient ) : 0;
+    return static_cast<int64_t>( value );
+  }
+
+  /// Add days to the days field, on overflow the whole time becomes
+  /// the earliest or latest representable time
+  ///
+  /// @param[in] days field
+  /// @param[in] carry days to add
+  /// @param[in,out] seconds of the normalised time
+  /// @param[in,out] nanoSeconds of the normalised time
+  /// @return new days field
+  static constexpr int32_t Days( const int32_t days, const int64_t carry, int32_t& seconds, double& nanoSeconds )
+  {
+    int32_t result = 0;
+    if( !__builtin_add_overflow( days, carry, &result ) )
+      return result;
+    if( carry > 0 )
+      {
+        seconds = 86399;
+        nanoSeconds = 1.0e9 - 1.0 / 8388608.0; // The double before 1e9
+        return std::numeric_limits<int32_t>::max();
+      }
+    seconds = 0;
+    nanoSeconds = 0.0;
+    return std::numeric_limits<int32_t>::min();
+  }
+};
+
+#endif
@@ -0,0 +1,334 @@
+////////////////////////////////////////////////////////////////////
+/// \class TimeAuditor
+///
+/// \brief  Streaming checks of time consistency, for bad clock readouts
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file for detector health monitoring.
+///
+/// \details Fed with consecutive packed times, in arrays or one at a
+///         time, each time is checked against the one before it:
+///          - kBackward, a step back by more than the tolerance
+///          - kGap, a step forward by more than the maximum gap
+///          - kJump, given a reference clock read with each time (the
+///            10 MHz clock, the host's arrival time...), a change in
+///            time - reference by more than the drift budget
+///         and, auditing raw readout fields before they are packed,
+///          - kNonCanonical, seconds outside [0, 86400) or nanoseconds
+///            outside [0, 1e9) or not finite, which Normalise would
+///            otherwise fold in without a trace, or days beyond the
+///            PackedTime range, whose time is not packed but written
+///            as kUnpacked.
+///
+///         Each finding is a 24 byte Anomaly appended to the caller's
+///         vector. A time that steps back is the new baseline, so a
+///         clock that jumps gives one record, not one per later time.
+///
+///         Arrays are checked in blocks of kBlock times by a branch free
+///         pass the compiler vectorises, only a block with a finding is
+///         walked again to make the records, so a clean stream costs
+///         about a ns per time.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_TimeAuditor__
+#define __RAT_DS_TimeAuditor__
+
+#include <PackedTime.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+class TimeAuditor
+{
+public:
+  static constexpr size_t kBlock = 256; ///< Times per vectorised check
+
+  enum Kind { kBackward = 1, kGap = 2, kJump = 4, kNonCanonical = 8 };
+
+  /// Bits of a kNonCanonical value, kBadDays also for fields that only together overflow a PackedTime
+  enum Field { kBadSeconds = 1, kBadNanoSeconds = 2, kBadDays = 4 };
+
+  static constexpr PackedTime kUnpacked = INT64_MIN; ///< Packed time of fields beyond the PackedTime range
+  /// Largest |days| that packs with any canonical time of day, about 292 years
+  static constexpr int32_t kMaxDays = INT64_MAX / PackedTimes::kNanoSecondsPerDay - 1;
+
+  /// One finding
+  struct Anomaly
+  {
+    uint64_t index : 56; ///< Position in the stream, from 0
+    uint64_t kind : 8; ///< Kind
+    PackedTime time; ///< The time found, packed as Normalise would
+    int64_t value; ///< Step from the previous time, change of time - reference, or Field bits
+  };
+
+  /// Construct the auditor
+  ///
+  /// @param[in] maxGap_ longest normal step forward (ns), <= 0 for none short of 146 years
+  /// @param[in] driftBudget_ largest normal change of time - reference between times (ns)
+  /// @param[in] backwardTolerance_ longest normal step back (ns), 0 for strictly non decreasing
+  TimeAuditor( const PackedTime maxGap_, const PackedTime driftBudget_ = 0, const PackedTime backwardTolerance_ = 0 )
+    : maxGap(Clamp( maxGap_ <= 0 ? kNoLimit : maxGap_ )), driftBudget(Clamp( driftBudget_ )),
+      backwardTolerance(Clamp( backwardTolerance_ )) { Reset(); };
+
+  /// Forget the stream, start again at index 0
+  void Reset()
+  {
+    audited = 0;
+    last = 0;
+    lastOffset = 0;
+    std::fill( counts, counts + 4, 0 );
+  }
+
+  /// Check an array of times continuing the stream
+  ///
+  /// @param[in] times to check
+  /// @param[in] count of times
+  /// @param[out] anomalies appended to
+  /// @return number of anomalies appended
+  size_t Audit( const PackedTime* times, const size_t count, std::vector<Anomaly>& anomalies )
+  {
+    return Check<false>( times, 0, count, anomalies );
+  }
+
+  /// Check an array of times, and their drift against a reference clock, continuing the stream
+  ///
+  /// @param[in] times to check
+  /// @param[in] references reading of the reference clock with each time (ns)
+  /// @param[in] count of times
+  /// @param[out] anomalies appended to
+  /// @return number of anomalies appended
+  size_t Audit( const PackedTime* times, const PackedTime* references, const size_t count, std::vector<Anomaly>& anomalies )
+  {
+    return Check<true>( times, references, count, anomalies );
+  }
+
+  /// Check raw readout fields, then their packed times, continuing the stream
+  ///
+  /// @param[in] days raw field
+  /// @param[in] seconds raw field
+  /// @param[in] nanoSeconds raw field
+  /// @param[in] count of times
+  /// @param[out] anomalies appended to
+  /// @param[out] packed count packed times if not null, non finite nanoseconds taken as 0, kUnpacked if
+  ///                    the fields are beyond the PackedTime range
+  /// @return number of anomalies appended
+  inline size_t AuditFields( const int32_t* days, const int32_t* seconds, const double* nanoSeconds, const size_t count,
+                             std::vector<Anomaly>& anomalies, PackedTime* packed = 0 );
+
+  /// Check one time of a live stream
+  ///
+  /// @param[in] time to check
+  /// @param[out] anomalies appended to
+  /// @return number of anomalies appended
+  size_t Fill( const PackedTime time, std::vector<Anomaly>& anomalies ) { return Audit( &time, 1, anomalies ); }
+
+  /// Check one time of a live stream, and its drift against a reference clock
+  ///
+  /// @param[in] time to check
+  /// @param[in] reference reading of the reference clock (ns)
+  /// @param[out] anomalies appended to
+  /// @return number of anomalies appended
+  size_t Fill( const PackedTime time, const PackedTime reference, std::vector<Anomaly>& anomalies )
+  {
+    return Audit( &time, &reference, 1, anomalies );
+  }
+
+  /// Get the number of times checked
+  ///
+  /// @return count
+  uint64_t GetAudited() const { return audited; }
+
+  /// Get the number of anomalies of a kind found so far
+  ///
+  /// @param[in] kind to count
+  /// @return count
+  uint64_t GetCount( const Kind kind ) const { return counts[__builtin_ctz( kind )]; }
+
+protected:
+  static constexpr PackedTime kNoLimit = INT64_MAX / 2; ///< Largest limit, so limit +- step keeps its sign (146 years)
+
+  /// Limit in [0, kNoLimit]
+  static PackedTime Clamp( const PackedTime limit ) { return std::min( std::max<PackedTime>( limit, 0 ), kNoLimit ); }
+
+  /// Pack raw fields as PackedTimes::Pack does, wrapping rather than overflowing on corrupt ones
+  static PackedTime PackWrapping( const int32_t days, const int32_t seconds, const double nanoSeconds )
+  {
+    return static_cast<PackedTime>( static_cast<uint64_t>( days ) * PackedTimes::kNanoSecondsPerDay
+                                    + static_cast<uint64_t>( seconds ) * PackedTimes::kNanoSecondsPerSecond
+                                    + static_cast<uint64_t>( std::llround( nanoSeconds ) ) );
+  }
+
+  /// Pack raw fields exactly, false if they are beyond the PackedTime range
+  static bool PackExact( const int32_t days, const int32_t seconds, const double nanoSeconds, PackedTime& packed )
+  {
+    if( days < -kMaxDays || days > kMaxDays || !( std::fabs( nanoSeconds ) < 9.0e18 ) )
+      return false;
+    const int64_t day = static_cast<int64_t>( days ) * PackedTimes::kNanoSecondsPerDay;
+    const int64_t second = static_cast<int64_t>( seconds ) * PackedTimes::kNanoSecondsPerSecond;
+    int64_t sum;
+    return !__builtin_add_overflow( day, second, &sum )
+      && !__builtin_add_overflow( sum, static_cast<int64_t>( std::llround( nanoSeconds ) ), &packed );
+  }
+
+  /// Difference that wraps rather than overflows on corrupt times
+  static int64_t Difference( const PackedTime lhs, const PackedTime rhs )
+  {
+    return static_cast<int64_t>( static_cast<uint64_t>( lhs ) - static_cast<uint64_t>( rhs ) );
+  }
+
+  /// Append an anomaly and count it
+  void Record( std::vector<Anomaly>& anomalies, const uint64_t index, const Kind kind, const PackedTime time,
+               const int64_t value )
+  {
+    Anomaly anomaly;
+    anomaly.index = index;
+    anomaly.kind = kind;
+    anomaly.time = time;
+    anomaly.value = value;
+    anomalies.push_back( anomaly );
+    counts[__builtin_ctz( kind )]++;
+  }
+
+  /// Check times in blocks, with or without references
+  template<bool kReferences>
+  inline size_t Check( const PackedTime* times, const PackedTime* references, const size_t count,
+                       std::vector<Anomaly>& anomalies );
+
+  PackedTime maxGap; ///< Longest normal step forward
+  PackedTime driftBudget; ///< Largest normal change of time - reference
+  PackedTime backwardTolerance; ///< Longest normal step back
+  uint64_t audited; ///< Times checked, the index of the next
+  PackedTime last; ///< Previous time
+  PackedTime lastOffset; ///< Previous time - reference
+  uint64_t counts[4]; ///< Anomalies by kind
+};
+
+template<bool kReferences>
+inline size_t
+TimeAuditor::Check( const PackedTime* times, const PackedTime* references, const size_t count,
+                    std::vector<Anomaly>& anomalies )
+{
+  const size_t before = anomalies.size();
+  size_t start = 0;
+  if( audited == 0 && count > 0 )
+    {
+      // The first time of the stream has nothing to be checked against
+      last = times[0];
+      lastOffset = kReferences ? Difference( times[0], references[0] ) : 0;
+      start = 1;
+    }
+  for( size_t block = start; block < count; block += kBlock )
+    {
+      const size_t end = std::min( count, block + kBlock );
+      // Flag the block without branches or 64 bit compares, which SSE2 lacks: a limit
+      // is broken if limit + step or limit - step goes negative, so or the sign bits
+      const uint64_t back = backwardTolerance, gap = maxGap, budget = driftBudget;
+      const uint64_t firstStep = static_cast<uint64_t>( times[block] ) - static_cast<uint64_t>( last );
+      uint64_t flags = ( back + firstStep ) | ( gap - firstStep );
+      if( kReferences )
+        {
+          const uint64_t drift = static_cast<uint64_t>( Difference( Difference( times[block], references[block] ), lastOffset ) );
+          flags |= ( budget + drift ) | ( budget - drift );
+        }
+      for( size_t i = block + 1; i < end; i++ )
+        {
+          const uint64_t step = static_cast<uint64_t>( times[i] ) - static_cast<uint64_t>( times[i - 1] );
+          flags |= ( back + step ) | ( gap - step );
+          if( kReferences )
+            {
+              const uint64_t drift = ( static_cast<uint64_t>( times[i] ) - static_cast<uint64_t>( references[i] ) )
+                - ( static_cast<uint64_t>( times[i - 1] ) - static_cast<uint64_t>( references[i - 1] ) );
+              flags |= ( budget + drift ) | ( budget - drift );
+            }
+        }
+      const bool bad = flags >> 63;
+      if( bad )
+        for( size_t i = block; i < end; i++ )
+          {
+            const int64_t step = Difference( times[i], i == block ? last : times[i - 1] );
+            if( step < -backwardTolerance )
+              Record( anomalies, audited + i, kBackward, times[i], step );
+            else if( step > maxGap )
+              Record( anomalies, audited + i, kGap, times[i], step );
+            if( kReferences )
+              {
+                const int64_t drift = Difference( Difference( times[i], references[i] ),
+                                                  i == block ? lastOffset : Difference( times[i - 1], references[i - 1] ) );
+                if( drift > driftBudget || drift < -driftBudget )
+                  Record( anomalies, audited + i, kJump, times[i], drift );
+              }
+          }
+      last = times[end - 1];
+      if( kReferences )
+        lastOffset = Difference( times[end - 1], references[end - 1] );
+    }
+  audited += count;
+  return anomalies.size() - before;
+}
+
+inline size_t
+TimeAuditor::AuditFields( const int32_t* days, const int32_t* seconds, const double* nanoSeconds, const size_t count,
+                          std::vector<Anomaly>& anomalies, PackedTime* packed )
+{
+  const size_t before = anomalies.size();
+  PackedTime block[kBlock];
+  for( size_t first = 0; first < count; first += kBlock )
+    {
+      const size_t n = std::min( count - first, kBlock );
+      PackedTime* out = packed != 0 ? packed + first : block;
+      bool bad = false;
+      for( size_t i = 0; i < n; i++ )
+        {
+          const int32_t day = days[first + i];
+          const int32_t second = seconds[first + i];
+          const double nanoSecond = nanoSeconds[first + i];
+          // NaN fails both compares, so it is flagged as well
+          const bool badNanoSeconds = !( nanoSecond >= 0.0 && nanoSecond < 1.0e9 );
+          bad |= ( second < 0 ) | ( second >= 86400 ) | badNanoSeconds | ( day < -kMaxDays ) | ( day > kMaxDays );
+          out[i] = PackWrapping( day, second, std::isfinite( nanoSecond ) ? nanoSecond : 0.0 );
+        }
+      const PackedTime* times = out;
+      PackedTime checked[kBlock];
+      if( bad )
+        {
+          bool unpacked = false;
+          for( size_t i = 0; i < n; i++ )
+            {
+              const int32_t day = days[first + i];
+              const int32_t second = seconds[first + i];
+              const double nanoSecond = nanoSeconds[first + i];
+              int64_t fields = ( second < 0 || second >= 86400 ? kBadSeconds : 0 )
+                | ( nanoSecond >= 0.0 && nanoSecond < 1.0e9 ? 0 : kBadNanoSeconds )
+                | ( day < -kMaxDays || day > kMaxDays ? kBadDays : 0 );
+              // Bad seconds or nanoseconds can carry days near the limit past it too
+              if( fields != 0 && !PackExact( day, second, std::isfinite( nanoSecond ) ? nanoSecond : 0.0, out[i] ) )
+                {
+                  out[i] = kUnpacked;
+                  fields |= kBadDays;
+                  unpacked = true;
+                }
+              if( fields != 0 )
+                Record( anomalies, audited + i, kNonCanonical, out[i], fields );
+            }
+          // An unpacked time has no step to check, it stands in as the time before it, or
+          // at the start of the stream the first time after it
+          if( unpacked )
+            {
+              for( size_t i = 0; i < n; i++ )
+                checked[i] = out[i] != kUnpacked ? out[i] : i > 0 ? checked[i - 1] : audited > 0 ? last : kUnpacked;
+              for( size_t i = n; i > 1 && audited == 0; i-- )
+                if( checked[i - 2] == kUnpacked )
+                  checked[i - 2] = checked[i - 1];
+              times = checked;
+            }
+        }
+      // Then the packed times, in index order after the field records of the block
+      Check<false>( times, 0, n, anomalies );
+    }
+  return anomalies.size() - before;
+}
+
+#endif
@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////
+/// \class TimeColumnExtractor
+///
+/// \brief  Packs the times of the objects in a collection into one array
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file, feeds ROOT event collections to the batch kernels.
+///
+/// \details The DS collections, TClonesArray and TObjArray, hold
+///         pointers to objects with a UniversalTime member. Pulling the
+///         times out one GetTime call at a time costs a virtual call and
+///         a cache miss per object. These loops walk a collection once,
+///         prefetching the object a few entries ahead, and pack the
+///         times into a contiguous column the batch kernels can run on.
+///
+///         Any collection with GetEntriesFast and UncheckedAt works, so
+///         this header needs no ROOT. Extract reads the time through an
+///         accessor that the compiler can inline, given the concrete
+///         class, which TClonesArray guarantees:
+///
+///           TimeColumnExtractor::Extract<RAT::DS::PMTHit>( *hits,
+///             []( const RAT::DS::PMTHit& hit ) -> const UniversalTime& { return hit.GetTime(); }, times );
+///
+///         ExtractAtOffset needs only the byte offset of the time within
+///         the objects, from OffsetOf on one of them or from the class
+///         dictionary, and reads the fields directly. The offset is to
+///         the UniversalTimeCore part of the member and from the pointer
+///         UncheckedAt returns. Every object must share it.
+///
+///         Empty slots of a TObjArray are skipped. If an index column
+///         is given it gets each time's entry number, so other columns
+///         can be lined up with the times.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_TimeColumnExtractor__
+#define __RAT_DS_TimeColumnExtractor__
+
+#include <PackedTime.hh>
+#include <UniversalTimeCore.hh>
+
+#include <cstddef>
+#include <stdint.h>
+
+class TimeColumnExtractor
+{
+public:
+  static constexpr size_t kPrefetchDistance = 8; ///< Entries prefetched ahead
+
+  /// Pack the times read by an accessor
+  ///
+  /// @param[in] collection of TObject pointers, all to TClass objects
+  /// @param[in] accessor returning the time of a TClass, or anything PackedTimes::Pack takes
+  /// @param[out] times packed, room for GetEntriesFast
+  /// @param[out] indices entry numbers of the times, optional
+  /// @return number of times written
+  template<class TClass, class TCollection, class TAccessor>
+  static size_t Extract( const TCollection& collection, TAccessor accessor, PackedTime* times, uint32_t* indices = 0 )
+  {
+    const size_t count = static_cast<size_t>( collection.GetEntriesFast() );
+    size_t written = 0;
+    for( size_t i = 0; i < count; i++ )
+      {
+        if( i + kPrefetchDistance < count )
+          __builtin_prefetch( collection.UncheckedAt( static_cast<int>( i + kPrefetchDistance ) ) );
+        const TClass* object = static_cast<const TClass*>( collection.UncheckedAt( static_cast<int>( i ) ) );
+        if( object == 0 )
+          continue;
+        times[written] = PackedTimes::Pack( accessor( *object ) );
+        if( indices != 0 )
+          indices[written] = static_cast<uint32_t>( i );
+        written++;
+      }
+    return written;
+  }
+
+  /// Pack the times at a byte offset within every object
+  ///
+  /// @param[in] collection of object pointers
+  /// @param[in] offset of the UniversalTimeCore from each pointer, see OffsetOf
+  /// @param[out] times packed, room for GetEntriesFast
+  /// @param[out] indices entry numbers of the times, optional
+  /// @return number of times written
+  template<class TCollection>
+  static size_t ExtractAtOffset( const TCollection& collection, const ptrdiff_t offset, PackedTime* times,
+                                 uint32_t* indices = 0 )
+  {
+    const size_t count = static_cast<size_t>( collection.GetEntriesFast() );
+    size_t written = 0;
+    for( size_t i = 0; i < count; i++ )
+      {
+        if( i + kPrefetchDistance < count )
+          {
+            const char* ahead = reinterpret_cast<const char*>( collection.UncheckedAt( static_cast<int>( i + kPrefetchDistance ) ) );
+            if( ahead != 0 )
+              __builtin_prefetch( ahead + offset );
+          }
+        const char* object = reinterpret_cast<const char*>( collection.UncheckedAt( static_cast<int>( i ) ) );
+        if( object == 0 )
+          continue;
+        times[written] = PackedTimes::Pack( *reinterpret_cast<const UniversalTimeCore*>( object + offset ) );
+        if( indices != 0 )
+          indices[written] = static_cast<uint32_t>( i );
+        written++;
+      }
+    return written;
+  }
+
+  /// Get the offset of a time within an object, for ExtractAtOffset
+  ///
+  /// @param[in] object as the collection returns it
+  /// @param[in] time member of that object
+  /// @return byte offset of the time's UniversalTimeCore
+  template<class TObjectBase>
+  static ptrdiff_t OffsetOf( const TObjectBase* object, const UniversalTimeCore& time )
+  {
+    return reinterpret_cast<const char*>( &time ) - reinterpret_cast<const char*>( object );
+  }
+};
+
+#endif
@@ -0,0 +1,245 @@
+////////////////////////////////////////////////////////////////////
+/// \class TimeGenerator
+///
+/// \brief  Batch generator of synthetic packed times for scale tests
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file, replaces the TRandom3 loop in main.C.
+///
+/// \details Random numbers come from Philox4x32-10 (Salmon et al. 2011),
+///         a counter based generator: draw i of stream s with seed k is
+///         a pure function of (i, s, k). Any chunk of any stream can be
+///         made on any thread with no shared state and the output does
+///         not depend on how the work was split. The rounds are plain
+///         32 x 32 -> 64 multiplies and xors, so the batch loops below
+///         vectorise.
+///
+///         Modes:
+///          - Uniform, independent times in [begin, end)
+///          - Poisson, a sorted process of exponential gaps plus a
+///            fixed dead time after each hit
+///          - InjectBursts, adds bursts of closely spaced hits into a
+///            sorted series
+///          - MixedSignFields, raw (days, seconds, ns) with every field
+///            of either sign, the normalisation test inputs of main.C
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_TimeGenerator__
+#define __RAT_DS_TimeGenerator__
+
+#include <PackedTime.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <stdint.h>
+#include <vector>
+
+class TimeGenerator
+{
+public:
+  /// Construct a generator
+  ///
+  /// @param[in] seed_ shared by every stream of a run
+  /// @param[in] stream_ e.g. the thread number, streams are independent
+  TimeGenerator( const uint64_t seed_, const uint64_t stream_ = 0 ) : seed(seed_), stream(stream_), counter(0) { };
+
+  /// Philox4x32-10 block, 4 random words for one counter
+  ///
+  /// @param[in] index of the draw
+  /// @param[in] stream of the draw
+  /// @param[in] key the seed
+  /// @param[out] out 4 random words
+  static inline void Philox( const uint64_t index, const uint64_t stream, const uint64_t key, uint32_t out[4] );
+
+  /// Fill with independent uniform times in [begin, end), uses draws [counter, counter + count)
+  ///
+  /// @param[in] begin of the range
+  /// @param[in] end of the range, exclusive, after begin
+  /// @param[out] times to fill
+  /// @param[in] count of times
+  inline void Uniform( const PackedTime begin, const PackedTime end, PackedTime* times, const size_t count );
+
+  /// Fill with a sorted Poisson process with dead time
+  ///
+  /// @param[in] start time, the first hit is one gap after it
+  /// @param[in] rate of the process (Hz) before dead time
+  /// @param[in] deadTime added to every gap (ns)
+  /// @param[out] times to fill
+  /// @param[in] count of times
+  /// @return the last time, the start of a continuation
+  inline PackedTime Poisson( const PackedTime start, const double rate, const PackedTime deadTime,
+                             PackedTime* times, const size_t count );
+
+  /// Add bursts to a sorted series, burst starts are a Poisson process over its span
+  ///
+  /// @param[in,out] times sorted series, stays sorted
+  /// @param[in] burstRate of burst starts (Hz)
+  /// @param[in] hitsPerBurst number of hits added per burst
+  /// @param[in] spacing mean gap (ns) between the hits of a burst
+  /// @return number of hits added
+  inline size_t InjectBursts( std::vector<PackedTime>& times, const double burstRate,
+                              const uint32_t hitsPerBurst, const PackedTime spacing );
+
+  /// Fill with raw fields of either sign, days in [-100, 100), seconds in
+  /// [-100000, 100000) both even, and ns in (-1e9, 1e9)
+  ///
+  /// @param[out] days to fill
+  /// @param[out] seconds to fill
+  /// @param[out] nanoSeconds to fill
+  /// @param[in] count of entries
+  inline void MixedSignFields( int32_t* days, int32_t* seconds, double* nanoSeconds, const size_t count );
+
+  /// Get the next draw index
+  ///
+  /// @return counter
+  uint64_t GetCounter() const { return counter; }
+
+  /// Jump to a draw index, e.g. to make chunk c of a batch on another thread
+  ///
+  /// @param[in] counter_ index of the next draw
+  void SetCounter( const uint64_t counter_ ) { counter = counter_; }
+
+protected:
+  static constexpr size_t kBlock = 1024; ///< Draws per vectorised block
+
+  /// Convert 64 random bits to a double in [0, 1)
+  static double ToUnit( const uint32_t high, const uint32_t low )
+  {
+    return static_cast<double>( ( ( static_cast<uint64_t>( high ) << 32 ) | low ) >> 11 ) * ( 1.0 / 9007199254740992.0 );
+  }
+
+  /// Scale 64 random bits to [0, range)
+  static uint64_t ToRange( const uint32_t high, const uint32_t low, const uint64_t range )
+  {
+    const unsigned __int128 wide = static_cast<unsigned __int128>( ( static_cast<uint64_t>( high ) << 32 ) | low ) * range;
+    return static_cast<uint64_t>( wide >> 64 );
+  }
+
+  /// Fill a block of exponential gaps (ns), mean 1e9 / rate, uses draws [counter, counter + count)
+  inline void ExponentialGaps( const double rate, const PackedTime deadTime, PackedTime* gaps, const size_t count );
+
+  uint64_t seed; ///< Philox key
+  uint64_t stream; ///< Stream, the high half of the counter
+  uint64_t counter; ///< Index of the next draw
+};
+
+inline void
+TimeGenerator::Philox( const uint64_t index, const uint64_t stream_, const uint64_t key, uint32_t out[4] )
+{
+  uint32_t c0 = static_cast<uint32_t>( index );
+  uint32_t c1 = static_cast<uint32_t>( index >> 32 );
+  uint32_t c2 = static_cast<uint32_t>( stream_ );
+  uint32_t c3 = static_cast<uint32_t>( stream_ >> 32 );
+  uint32_t k0 = static_cast<uint32_t>( key );
+  uint32_t k1 = static_cast<uint32_t>( key >> 32 );
+  for( int round = 0; round < 10; round++ )
+    {
+      const uint64_t product0 = static_cast<uint64_t>( 0xD2511F53u ) * c0;
+      const uint64_t product1 = static_cast<uint64_t>( 0xCD9E8D57u ) * c2;
+      const uint32_t next0 = static_cast<uint32_t>( product1 >> 32 ) ^ c1 ^ k0;
+      const uint32_t next2 = static_cast<uint32_t>( product0 >> 32 ) ^ c3 ^ k1;
+      c1 = static_cast<uint32_t>( product1 );
+      c3 = static_cast<uint32_t>( product0 );
+      c0 = next0;
+      c2 = next2;
+      k0 += 0x9E3779B9u;
+      k1 += 0xBB67AE85u;
+    }
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+}
+
+inline void
+TimeGenerator::Uniform( const PackedTime begin, const PackedTime end, PackedTime* times, const size_t count )
+{
+  if( end <= begin )
+    throw std::invalid_argument( "TimeGenerator::Uniform: empty range" );
+  const uint64_t range = static_cast<uint64_t>( end ) - static_cast<uint64_t>( begin );
+  for( size_t i = 0; i < count; i++ )
+    {
+      uint32_t words[4];
+      Philox( counter + i, stream, seed, words );
+      times[i] = begin + static_cast<PackedTime>( ToRange( words[0], words[1], range ) );
+    }
+  counter += count;
+}
+
+inline void
+TimeGenerator::ExponentialGaps( const double rate, const PackedTime deadTime, PackedTime* gaps, const size_t count )
+{
+  const double mean = 1.0e9 / rate;
+  for( size_t i = 0; i < count; i++ )
+    {
+      uint32_t words[4];
+      Philox( counter + i, stream, seed, words );
+      // 1 - u is in (0, 1] so the log is finite
+      const double gap = -mean * std::log( 1.0 - ToUnit( words[0], words[1] ) );
+      gaps[i] = deadTime + static_cast<PackedTime>( gap );
+    }
+  counter += count;
+}
+
+inline PackedTime
+TimeGenerator::Poisson( const PackedTime start, const double rate, const PackedTime deadTime,
+                        PackedTime* times, const size_t count )
+{
+  PackedTime time = start;
+  for( size_t first = 0; first < count; first += kBlock )
+    {
+      const size_t block = std::min( kBlock, count - first );
+      ExponentialGaps( rate, deadTime, times + first, block );
+      for( size_t i = first; i < first + block; i++ ) // Prefix sum of the gaps
+        {
+          time += times[i];
+          times[i] = time;
+        }
+    }
+  return time;
+}
+
+inline size_t
+TimeGenerator::InjectBursts( std::vector<PackedTime>& times, const double burstRate,
+                             const uint32_t hitsPerBurst, const PackedTime spacing )
+{
+  if( times.size() < 2 || hitsPerBurst == 0 )
+    return 0;
+  const size_t original = times.size();
+  const PackedTime last = times.back();
+  PackedTime burst = times.front();
+  PackedTime gap[1];
+  for( ;; )
+    {
+      ExponentialGaps( burstRate, 0, gap, 1 );
+      burst += gap[0];
+      if( burst > last )
+        break;
+      const size_t first = times.size();
+      times.resize( first + hitsPerBurst );
+      Poisson( burst, 1.0e9 / static_cast<double>( std::max<PackedTime>( spacing, 1 ) ), 0, times.data() + first, hitsPerBurst );
+      times[first] = burst;
+    }
+  // Bursts start in order but may overlap each other, sort them before the merge
+  std::sort( times.begin() + original, times.end() );
+  std::inplace_merge( times.begin(), times.begin() + original, times.end() );
+  return times.size() - original;
+}
+
+inline void
+TimeGenerator::MixedSignFields( int32_t* days, int32_t* seconds, double* nanoSeconds, const size_t count )
+{
+  for( size_t i = 0; i < count; i++ )
+    {
+      uint32_t words[4];
+      Philox( counter + i, stream, seed, words );
+      days[i] = 2 * ( static_cast<int32_t>( ToRange( words[0], 0, 100 ) ) - 50 );
+      seconds[i] = 2 * ( static_cast<int32_t>( ToRange( words[1], 0, 100000 ) ) - 50000 );
+      nanoSeconds[i] = ( ToUnit( words[2], words[3] ) - 0.5 ) * 2.0e9;
+    }
+  counter += count;
+}
+
+#endif
@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////
+/// \class TimeIntervalTable
+///
+/// \brief  Immutable map from time intervals to values
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file for runs, calibrations and veto lists.
+///
+/// \details Holds non-overlapping [begin, end) intervals of packed
+///         time, each with a value such as a run number or calibration
+///         constants. Find is a binary search over the interval starts.
+///         A table is built once and never changed, so it can be shared
+///         between threads without locks and swapped whole with an
+///         RcuPointer when a run starts or a calibration is updated.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_TimeIntervalTable__
+#define __RAT_DS_TimeIntervalTable__
+
+#include <PackedTime.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+template<class T>
+class TimeIntervalTable
+{
+public:
+  struct Interval
+  {
+    PackedTime begin; ///< Start, inclusive
+    PackedTime end; ///< End, exclusive
+    T value; ///< Value over the interval
+  };
+
+  /// Construct the table, the intervals need not be sorted
+  ///
+  /// @param[in] intervals_ non-overlapping and non-empty
+  inline TimeIntervalTable( std::vector<Interval> intervals_ );
+
+  /// Find the value at a time
+  ///
+  /// @param[in] time to look up
+  /// @return the value of the interval holding time, 0 if none
+  const T* Find( const PackedTime time ) const
+  {
+    const size_t i = std::upper_bound( begins.begin(), begins.end(), time ) - begins.begin();
+    if( i == 0 || time >= ends[i - 1] )
+      return 0;
+    return &values[i - 1];
+  }
+
+  /// Get the number of intervals
+  ///
+  /// @return count
+  size_t GetSize() const { return begins.size(); }
+
+protected:
+  std::vector<PackedTime> begins; ///< Interval starts, sorted
+  std::vector<PackedTime> ends; ///< Interval ends
+  std::vector<T> values; ///< Interval values
+};
+
+template<class T>
+inline
+TimeIntervalTable<T>::TimeIntervalTable( std::vector<Interval> intervals_ )
+{
+  std::sort( intervals_.begin(), intervals_.end(),
+             []( const Interval& lhs, const Interval& rhs ) { return lhs.begin < rhs.begin; } );
+  begins.reserve( intervals_.size() );
+  ends.reserve( intervals_.size() );
+  values.reserve( intervals_.size() );
+  for( size_t i = 0; i < intervals_.size(); i++ )
+    {
+      if( !( intervals_[i].begin < intervals_[i].end ) )
+        throw std::invalid_argument( "TimeIntervalTable: empty interval" );
+      if( i > 0 && intervals_[i].begin < intervals_[i - 1].end )
+        throw std::invalid_argument( "TimeIntervalTable: overlapping intervals" );
+      begins.push_back( intervals_[i].begin );
+      ends.push_back( intervals_[i].end );
+      values.push_back( intervals_[i].value );
+    }
+}
+
+#endif
@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////
+/// \class TimeParallel
+///
+/// \brief  Splits a batch of packed times into chunks run on threads
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file for the batch time kernels.
+///
+/// \details Chunks are contiguous and in order, chunk i covers
+///         [begin, end) with the chunks tiling [0, count). The calling
+///         thread runs the last chunk itself so a single chunk never
+///         starts a thread.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_TimeParallel__
+#define __RAT_DS_TimeParallel__
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+class TimeParallel
+{
+public:
+  /// Get the number of threads to use when the caller asks for 0
+  ///
+  /// @return the hardware concurrency, at least 1
+  static unsigned DefaultThreads()
+  {
+    const unsigned threads = std::thread::hardware_concurrency();
+    return threads == 0 ? 1 : threads;
+  }
+
+  /// Get the number of chunks a batch will be split into
+  ///
+  /// @param[in] count of items in the batch
+  /// @param[in] threads to use, 0 for the default
+  /// @param[in] minChunk smallest chunk worth a thread
+  /// @return number of chunks, at least 1
+  static size_t ChunkCount( const size_t count, const unsigned threads, const size_t minChunk )
+  {
+    const size_t maxThreads = threads == 0 ? DefaultThreads() : threads;
+    const size_t bySize = count / std::max<size_t>( minChunk, 1 );
+    return std::max<size_t>( 1, std::min( maxThreads, bySize ) );
+  }
+
+  /// Run fn( chunk, begin, end ) over every chunk of [0, count)
+  ///
+  /// @param[in] count of items in the batch
+  /// @param[in] threads to use, 0 for the default
+  /// @param[in] minChunk smallest chunk worth a thread
+  /// @param[in] fn to run on each chunk
+  template<class TFunction>
+  static void ForEachChunk( const size_t count, const unsigned threads, const size_t minChunk, TFunction fn )
+  {
+    const size_t chunks = ChunkCount( count, threads, minChunk );
+    std::vector<std::thread> workers;
+    workers.reserve( chunks - 1 );
+    for( size_t chunk = 0; chunk + 1 < chunks; chunk++ )
+      workers.emplace_back( fn, chunk, ChunkBegin( count, chunks, chunk ), ChunkBegin( count, chunks, chunk + 1 ) );
+    fn( chunks - 1, ChunkBegin( count, chunks, chunks - 1 ), count );
+    for( size_t i = 0; i < workers.size(); i++ )
+      workers[i].join();
+  }
+
+  /// Get the first index of a chunk
+  ///
+  /// @param[in] count of items in the batch
+  /// @param[in] chunks in the batch
+  /// @param[in] chunk index
+  /// @return first index in the chunk
+  static size_t ChunkBegin( const size_t count, const size_t chunks, const size_t chunk )
+  {
+    return count / chunks * chunk + std::min( chunk, count % chunks );
+  }
+};
+
+#endif
@@ -0,0 +1,611 @@
+////////////////////////////////////////////////////////////////////
+/// \class TimeRangeReader
+///
+/// \brief  Reads the events of time windows from sorted files asynchronously
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file for the reprocessing jobs.
+///
+/// \details Files hold events of type T sorted by their PackedTime
+///         member time, raw and native endian, as PartitionedWriter
+///         writes them (PartitionManifest::Select gives the files a
+///         window needs). Opening one reads the first time of every
+///         block of blockRecords events into a sparse index, so a set
+///         of windows resolves to the blocks holding them without
+///         touching anything else.
+///
+///         Read keeps up to queueDepth block reads in flight through
+///         io_uring, driven with raw syscalls, and hands each completed
+///         block to a pool of decode threads. These cut out the events
+///         inside the windows and call the visitor with each run of
+///         them, in no particular order between blocks. If io_uring is
+///         not available, e.g. disabled by a seccomp profile, or
+///         kPread is asked for, the decode threads read the blocks
+///         themselves with pread instead.
+///
+///         With direct set the files are opened with O_DIRECT, bypassing
+///         the page cache, where the filesystem allows it. Reads are
+///         widened to 4 kB alignment either way.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_TimeRangeReader__
+#define __RAT_DS_TimeRangeReader__
+
+#include <PackedTime.hh>
+#include <TimeParallel.hh>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template<class T>
+class TimeRangeReader
+{
+  static_assert( std::is_trivially_copyable<T>::value, "TimeRangeReader: events are read raw" );
+
+public:
+  typedef std::pair<PackedTime, PackedTime> Window; ///< [begin, end)
+
+  enum Engine { kAuto, kIoUring, kPread };
+
+  static constexpr size_t kAlignment = 4096; ///< Read alignment (bytes)
+
+  /// Open the files and index them
+  ///
+  /// @param[in] paths of files sorted by time
+  /// @param[in] blockRecords_ events per block, the unit of indexing and reading
+  /// @param[in] queueDepth_ block reads in flight, and blocks buffered
+  /// @param[in] decoders_ decode threads, 0 for the hardware concurrency
+  /// @param[in] engine kAuto for io_uring if it can be set up, else pread
+  /// @param[in] direct open with O_DIRECT where the filesystem allows
+  inline TimeRangeReader( const std::vector<std::string>& paths, const size_t blockRecords_ = 16384,
+                          const unsigned queueDepth_ = 32, const unsigned decoders_ = 0, const Engine engine = kAuto,
+                          const bool direct = false );
+
+  /// Close the files and the ring
+  inline ~TimeRangeReader();
+
+  TimeRangeReader( const TimeRangeReader& ) = delete;
+  TimeRangeReader& operator=( const TimeRangeReader& ) = delete;
+
+  /// Read the events of a set of windows
+  ///
+  /// @param[in] windows to read, any order, may overlap
+  /// @param[in] visit called on the decode threads as visit( const T* events, size_t count ), concurrently
+  /// @return number of events visited, throws runtime_error if a read fails
+  template<class TVisitor>
+  inline uint64_t Read( std::vector<Window> windows, TVisitor visit );
+
+  /// Get the engine in use
+  ///
+  /// @return kIoUring or kPread
+  Engine GetEngine() const { return ring.fd >= 0 ? kIoUring : kPread; }
+
+  /// Get the number of blocks the windows of the last Read touched
+  ///
+  /// @return count
+  size_t GetBlocksRead() const { return blocksRead; }
+
+  /// Get the bytes the last Read fetched, alignment included
+  ///
+  /// @return count
+  uint64_t GetBytesRead() const { return bytesRead; }
+
+protected:
+  struct File
+  {
+    int fd; ///< Descriptor reads go through
+    uint64_t size; ///< Bytes
+    std::vector<PackedTime> firsts; ///< First time of each block
+  };
+
+  struct Request
+  {
+    size_t file; ///< Index into files
+    uint64_t offset; ///< Of the block (bytes)
+    uint64_t length; ///< Of the block (bytes)
+  };
+
+  struct Slot
+  {
+    Request request; ///< Block being read
+    uint64_t start; ///< Aligned offset read from
+    uint64_t wanted; ///< Bytes to read from start
+    uint64_t done; ///< Bytes read so far
+    char* buffer; ///< kAlignment aligned
+  };
+
+  /// Mapped io_uring rings, fd < 0 if none
+  struct Ring
+  {
+    int fd;
+    void* sqRing;
+    void* cqRing;
+    size_t sqRingSize;
+    size_t cqRingSize;
+    io_uring_sqe* sqes;
+    size_t sqesSize;
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    io_uring_cqe* cqes;
+  };
+
+  /// Close the files and the ring
+  inline void Close();
+
+  /// Set up the ring, leaves fd < 0 on failure
+  inline void SetUpRing();
+
+  /// Resolve windows, sorted and merged, to blocks
+  inline std::vector<Request> Plan( const std::vector<Window>& windows ) const;
+
+  /// Cut the window events out of a read block
+  template<class TVisitor>
+  inline uint64_t Decode( const Slot& slot, const std::vector<Window>& windows, TVisitor& visit ) const;
+
+  /// Queue a read of the rest of a slot's block
+  inline void Prepare( const size_t slot );
+
+  /// Entries queued that the kernel has not taken yet, it only takes them in io_uring_enter
+  unsigned Unsubmitted() const { return *ring.sqTail - __atomic_load_n( ring.sqHead, __ATOMIC_ACQUIRE ); }
+
+  /// Read with io_uring, decoding on the pool
+  template<class TVisitor>
+  inline uint64_t ReadRing( const std::vector<Request>& requests, const std::vector<Window>& windows, TVisitor& visit );
+
+  /// Read and decode with pread on the pool
+  template<class TVisitor>
+  inline uint64_t ReadPool( const std::vector<Request>& requests, const std::vector<Window>& windows, TVisitor& visit );
+
+  std::vector<File> files; ///< Open files
+  size_t blockRecords; ///< Events per block
+  size_t bufferSize; ///< Bytes per slot buffer
+  unsigned queueDepth; ///< Slots
+  unsigned decoders; ///< Decode threads
+  Ring ring; ///< io_uring, if used
+  std::vector<Slot> slots; ///< Read buffers
+  std::unique_ptr<char, void (*)( void* )> buffers; ///< Memory of the slot buffers
+  size_t blocksRead; ///< Blocks of the last Read
+  uint64_t bytesRead; ///< Bytes of the last Read
+};
+
+template<class T>
+inline
+TimeRangeReader<T>::TimeRangeReader( const std::vector<std::string>& paths, const size_t blockRecords_,
+                                     const unsigned queueDepth_, const unsigned decoders_, const Engine engine,
+                                     const bool direct )
+  : blockRecords(std::max<size_t>( blockRecords_, 1 )), queueDepth(std::max( queueDepth_, 1u )),
+    decoders(decoders_ == 0 ? TimeParallel::DefaultThreads() : decoders_), buffers(0, std::free), blocksRead(0),
+    bytesRead(0)
+{
+  ring.fd = -1;
+  const uint64_t blockBytes = blockRecords * sizeof( T );
+  for( size_t f = 0; f < paths.size(); f++ )
+    {
+      File file;
+      file.fd = open( paths[f].c_str(), O_RDONLY );
+      struct stat status;
+      if( file.fd < 0 || fstat( file.fd, &status ) != 0 )
+        {
+          const std::string error = std::strerror( errno );
+          if( file.fd >= 0 )
+            close( file.fd );
+          Close();
+          throw std::runtime_error( "TimeRangeReader: cannot open " + paths[f] + ": " + error );
+        }
+      file.size = static_cast<uint64_t>( status.st_size ) / sizeof( T ) * sizeof( T );
+      // The index is a small read at the start of every block
+      for( uint64_t offset = 0; offset < file.size; offset += blockBytes )
+        {
+          T first;
+          if( pread( file.fd, &first, sizeof( T ), static_cast<off_t>( offset ) ) != static_cast<ssize_t>( sizeof( T ) ) )
+            {
+              close( file.fd );
+              Close();
+              throw std::runtime_error( "TimeRangeReader: cannot index " + paths[f] );
+            }
+          file.firsts.push_back( first.time );
+        }
+      if( direct )
+        {
+          const int directFd = open( paths[f].c_str(), O_RDONLY | O_DIRECT );
+          if( directFd >= 0 )
+            {
+              close( file.fd );
+              file.fd = directFd;
+            }
+        }
+      files.push_back( file );
+    }
+  bufferSize = ( blockBytes + 2 * kAlignment ) / kAlignment * kAlignment;
+  void* memory = 0;
+  if( posix_memalign( &memory, kAlignment, bufferSize * queueDepth ) != 0 )
+    {
+      Close();
+      throw std::bad_alloc();
+    }
+  buffers.reset( static_cast<char*>( memory ) );
+  slots.resize( queueDepth );
+  for( unsigned s = 0; s < queueDepth; s++ )
+    slots[s].buffer = buffers.get() + s * bufferSize;
+  if( engine != kPread )
+    SetUpRing();
+  if( engine == kIoUring && ring.fd < 0 )
+    {
+      const std::string error = std::strerror( errno );
+      Close();
+      throw std::runtime_error( "TimeRangeReader: io_uring_setup: " + error );
+    }
+}
+
+template<class T>
+inline
+TimeRangeReader<T>::~TimeRangeReader()
+{
+  Close();
+}
+
+template<class T>
+inline void
+TimeRangeReader<T>::Close()
+{
+  for( size_t f = 0; f < files.size(); f++ )
+    close( files[f].fd );
+  files.clear();
+  if( ring.fd >= 0 )
+    {
+      munmap( ring.sqes, ring.sqesSize );
+      if( ring.cqRing != ring.sqRing )
+        munmap( ring.cqRing, ring.cqRingSize );
+      munmap( ring.sqRing, ring.sqRingSize );
+      close( ring.fd );
+      ring.fd = -1;
+    }
+}
+
+template<class T>
+inline void
+TimeRangeReader<T>::SetUpRing()
+{
+  io_uring_params params;
+  std::memset( &params, 0, sizeof( params ) );
+  ring.fd = static_cast<int>( syscall( __NR_io_uring_setup, queueDepth, &params ) );
+  if( ring.fd < 0 )
+    return;
+  ring.sqRingSize = params.sq_off.array + params.sq_entries * sizeof( unsigned );
+  ring.cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof( io_uring_cqe );
+  if( params.features & IORING_FEAT_SINGLE_MMAP )
+    ring.sqRingSize = ring.cqRingSize = std::max( ring.sqRingSize, ring.cqRingSize );
+  ring.sqRing = mmap( 0, ring.sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING );
+  ring.cqRing = ring.sqRing;
+  if( ring.sqRing != MAP_FAILED && !( params.features & IORING_FEAT_SINGLE_MMAP ) )
+    ring.cqRing = mmap( 0, ring.cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING );
+  ring.sqesSize = params.sq_entries * sizeof( io_uring_sqe );
+  ring.sqes = static_cast<io_uring_sqe*>( mmap( 0, ring.sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd,
+                                                IORING_OFF_SQES ) );
+  if( ring.sqRing == MAP_FAILED || ring.cqRing == MAP_FAILED || ring.sqes == MAP_FAILED )
+    {
+      if( ring.sqes != MAP_FAILED )
+        munmap( ring.sqes, ring.sqesSize );
+      if( ring.cqRing != MAP_FAILED && ring.cqRing != ring.sqRing )
+        munmap( ring.cqRing, ring.cqRingSize );
+      if( ring.sqRing != MAP_FAILED )
+        munmap( ring.sqRing, ring.sqRingSize );
+      close( ring.fd );
+      ring.fd = -1;
+      return;
+    }
+  char* sq = static_cast<char*>( ring.sqRing );
+  char* cq = static_cast<char*>( ring.cqRing );
+  ring.sqHead = reinterpret_cast<unsigned*>( sq + params.sq_off.head );
+  ring.sqTail = reinterpret_cast<unsigned*>( sq + params.sq_off.tail );
+  ring.sqMask = reinterpret_cast<unsigned*>( sq + params.sq_off.ring_mask );
+  ring.sqArray = reinterpret_cast<unsigned*>( sq + params.sq_off.array );
+  ring.cqHead = reinterpret_cast<unsigned*>( cq + params.cq_off.head );
+  ring.cqTail = reinterpret_cast<unsigned*>( cq + params.cq_off.tail );
+  ring.cqMask = reinterpret_cast<unsigned*>( cq + params.cq_off.ring_mask );
+  ring.cqes = reinterpret_cast<io_uring_cqe*>( cq + params.cq_off.cqes );
+}
+
+template<class T>
+inline std::vector<typename TimeRangeReader<T>::Request>
+TimeRangeReader<T>::Plan( const std::vector<Window>& windows ) const
+{
+  std::vector<Request> requests;
+  const uint64_t blockBytes = blockRecords * sizeof( T );
+  for( size_t f = 0; f < files.size(); f++ )
+    {
+      const std::vector<PackedTime>& firsts = files[f].firsts;
+      size_t next = 0; // First block not yet requested, windows are sorted
+      for( size_t w = 0; w < windows.size(); w++ )
+        {
+          // From the last block starting before begin, as times repeated at begin may end it,
+          // up to the first starting at or after end
+          const size_t lower = std::lower_bound( firsts.begin(), firsts.end(), windows[w].first ) - firsts.begin();
+          const size_t low = std::max( next, lower > 0 ? lower - 1 : 0 );
+          const size_t high = std::lower_bound( firsts.begin(), firsts.end(), windows[w].second ) - firsts.begin();
+          for( size_t b = low; b < high; b++ )
+            {
+              const Request request = { f, b * blockBytes, std::min<uint64_t>( blockBytes, files[f].size - b * blockBytes ) };
+              requests.push_back( request );
+            }
+          next = std::max( next, high );
+        }
+    }
+  return requests;
+}
+
+template<class T>
+template<class TVisitor>
+inline uint64_t
+TimeRangeReader<T>::Decode( const Slot& slot, const std::vector<Window>& windows, TVisitor& visit ) const
+{
+  const T* events = reinterpret_cast<const T*>( slot.buffer + ( slot.request.offset - slot.start ) );
+  const size_t count = slot.request.length / sizeof( T );
+  const auto before = []( const T& event, const PackedTime time ) { return event.time < time; };
+  uint64_t visited = 0;
+  // Windows ending after the block's first event, until one begins after its last
+  std::vector<Window>::const_iterator window =
+    std::upper_bound( windows.begin(), windows.end(), events[0].time,
+                      []( const PackedTime time, const Window& rhs ) { return time < rhs.second; } );
+  for( ; window != windows.end() && window->first <= events[count - 1].time; ++window )
+    {
+      const T* low = std::lower_bound( events, events + count, window->first, before );
+      const T* high = std::lower_bound( low, events + count, window->second, before );
+      if( high > low )
+        {
+          visit( low, static_cast<size_t>( high - low ) );
+          visited += high - low;
+        }
+    }
+  return visited;
+}
+
+template<class T>
+template<class TVisitor>
+inline uint64_t
+TimeRangeReader<T>::Read( std::vector<Window> windows, TVisitor visit )
+{
+  // Sorted and merged, so every event is visited once
+  std::sort( windows.begin(), windows.end() );
+  std::vector<Window> merged;
+  for( size_t w = 0; w < windows.size(); w++ )
+    {
+      if( windows[w].second <= windows[w].first )
+        continue;
+      if( !merged.empty() && windows[w].first <= merged.back().second )
+        merged.back().second = std::max( merged.back().second, windows[w].second );
+      else
+        merged.push_back( windows[w] );
+    }
+  const std::vector<Request> requests = Plan( merged );
+  blocksRead = requests.size();
+  bytesRead = 0;
+  if( requests.empty() )
+    return 0;
+  return ring.fd >= 0 ? ReadRing( requests, merged, visit ) : ReadPool( requests, merged, visit );
+}
+
+template<class T>
+inline void
+TimeRangeReader<T>::Prepare( const size_t slot )
+{
+  const Slot& read = slots[slot];
+  const unsigned tail = *ring.sqTail;
+  const unsigned index = tail & *ring.sqMask;
+  io_uring_sqe* sqe = &ring.sqes[index];
+  std::memset( sqe, 0, sizeof( *sqe ) );
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = files[read.request.file].fd;
+  sqe->off = read.start + read.done;
+  sqe->addr = reinterpret_cast<uint64_t>( read.buffer + read.done );
+  sqe->len = static_cast<uint32_t>( read.wanted - read.done );
+  sqe->user_data = slot;
+  ring.sqArray[index] = index;
+  __atomic_store_n( ring.sqTail, tail + 1, __ATOMIC_RELEASE );
+}
+
+template<class T>
+template<class TVisitor>
+inline uint64_t
+TimeRangeReader<T>::ReadRing( const std::vector<Request>& requests, const std::vector<Window>& windows, TVisitor& visit )
+{
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::vector<size_t> freeSlots;
+  std::deque<size_t> decodeQueue;
+  bool finished = false;
+  std::string error;
+  std::atomic<uint64_t> visited( 0 );
+  for( size_t s = slots.size(); s > 0; s-- )
+    freeSlots.push_back( s - 1 );
+  std::vector<std::thread> pool;
+  for( unsigned d = 0; d < decoders; d++ )
+    pool.emplace_back( [&]()
+                       {
+                         std::unique_lock<std::mutex> lock( mutex );
+                         for( ;; )
+                           {
+                             changed.wait( lock, [&]() { return finished || !decodeQueue.empty(); } );
+                             if( decodeQueue.empty() )
+                               return;
+                             const size_t slot = decodeQueue.front();
+                             decodeQueue.pop_front();
+                             lock.unlock();
+                             visited += Decode( slots[slot], windows, visit );
+                             lock.lock();
+                             freeSlots.push_back( slot );
+                             changed.notify_all();
+                           }
+                       } );
+
+  size_t next = 0, inFlight = 0;
+  while( ( next < requests.size() || inFlight > 0 ) && error.empty() )
+    {
+      // Fill every free slot, waiting for one only if nothing is in flight
+      {
+        std::unique_lock<std::mutex> lock( mutex );
+        if( inFlight == 0 )
+          changed.wait( lock, [&]() { return !freeSlots.empty(); } );
+        while( next < requests.size() && !freeSlots.empty() )
+          {
+            const size_t slot = freeSlots.back();
+            freeSlots.pop_back();
+            Slot& read = slots[slot];
+            read.request = requests[next++];
+            read.start = read.request.offset / kAlignment * kAlignment;
+            read.wanted = ( read.request.offset + read.request.length - read.start + kAlignment - 1 ) / kAlignment * kAlignment;
+            read.done = 0;
+            Prepare( slot );
+            inFlight++;
+          }
+      }
+      if( syscall( __NR_io_uring_enter, ring.fd, Unsubmitted(), 1, IORING_ENTER_GETEVENTS, 0, 0 ) < 0 && errno != EINTR )
+        {
+          error = std::string( "io_uring_enter: " ) + std::strerror( errno );
+          break;
+        }
+      unsigned head = *ring.cqHead;
+      unsigned resubmit = 0;
+      while( head != __atomic_load_n( ring.cqTail, __ATOMIC_ACQUIRE ) )
+        {
+          const io_uring_cqe& cqe = ring.cqes[head & *ring.cqMask];
+          const size_t slot = static_cast<size_t>( cqe.user_data );
+          Slot& read = slots[slot];
+          head++;
+          if( cqe.res < 0 )
+            {
+              error = std::string( "read: " ) + std::strerror( -cqe.res );
+              inFlight--;
+              continue;
+            }
+          read.done += static_cast<uint64_t>( cqe.res );
+          bytesRead += static_cast<uint64_t>( cqe.res );
+          // The aligned end may be past the end of the file, only the block itself is needed
+          const uint64_t needed = read.request.offset + read.request.length - read.start;
+          if( read.done < needed && cqe.res > 0 )
+            {
+              Prepare( slot );
+              resubmit++;
+              continue;
+            }
+          inFlight--;
+          if( read.done < needed )
+            {
+              error = "unexpected end of file";
+              continue;
+            }
+          std::lock_guard<std::mutex> lock( mutex );
+          decodeQueue.push_back( slot );
+          changed.notify_all();
+        }
+      __atomic_store_n( ring.cqHead, head, __ATOMIC_RELEASE );
+      if( resubmit > 0 && syscall( __NR_io_uring_enter, ring.fd, Unsubmitted(), 0, 0, 0, 0 ) < 0 && errno != EINTR )
+        error = std::string( "io_uring_enter: " ) + std::strerror( errno );
+    }
+  // Reads still in flight after an error land in the slot buffers, wait them out. Entries
+  // a failed enter left in the ring go with the wait, or are taken back if it fails again
+  while( inFlight > 0 )
+    {
+      if( syscall( __NR_io_uring_enter, ring.fd, Unsubmitted(), 1, IORING_ENTER_GETEVENTS, 0, 0 ) < 0 )
+        {
+          if( errno == EINTR )
+            continue;
+          if( error.empty() )
+            error = std::string( "io_uring_enter: " ) + std::strerror( errno );
+          const unsigned unsubmitted = Unsubmitted();
+          __atomic_store_n( ring.sqTail, *ring.sqTail - unsubmitted, __ATOMIC_RELEASE );
+          inFlight -= unsubmitted;
+          break;
+        }
+      unsigned head = *ring.cqHead;
+      for( ; head != __atomic_load_n( ring.cqTail, __ATOMIC_ACQUIRE ); head++ )
+        inFlight--;
+      __atomic_store_n( ring.cqHead, head, __ATOMIC_RELEASE );
+    }
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    finished = true;
+    changed.notify_all();
+  }
+  for( size_t d = 0; d < pool.size(); d++ )
+    pool[d].join();
+  if( !error.empty() )
+    throw std::runtime_error( "TimeRangeReader: " + error );
+  return visited.load();
+}
+
+template<class T>
+template<class TVisitor>
+inline uint64_t
+TimeRangeReader<T>::ReadPool( const std::vector<Request>& requests, const std::vector<Window>& windows, TVisitor& visit )
+{
+  std::atomic<size_t> next( 0 );
+  std::atomic<uint64_t> visited( 0 ), bytes( 0 );
+  std::mutex mutex;
+  std::string error;
+  std::vector<std::thread> pool;
+  const unsigned nThreads = std::min<unsigned>( std::max( decoders, queueDepth ), static_cast<unsigned>( slots.size() ) );
+  for( unsigned t = 0; t < nThreads; t++ )
+    pool.emplace_back( [&, t]()
+                       {
+                         Slot& read = slots[t];
+                         for( size_t r = next++; r < requests.size(); r = next++ )
+                           {
+                             read.request = requests[r];
+                             read.start = read.request.offset / kAlignment * kAlignment;
+                             read.wanted = ( read.request.offset + read.request.length - read.start + kAlignment - 1 )
+                               / kAlignment * kAlignment;
+                             const uint64_t needed = read.request.offset + read.request.length - read.start;
+                             for( read.done = 0; read.done < needed; )
+                               {
+                                 const ssize_t got = pread( files[read.request.file].fd, read.buffer + read.done,
+                                                            read.wanted - read.done, static_cast<off_t>( read.start + read.done ) );
+                                 if( got <= 0 )
+                                   {
+                                     std::lock_guard<std::mutex> lock( mutex );
+                                     error = got < 0 ? std::string( "pread: " ) + std::strerror( errno ) : "unexpected end of file";
+                                     next = requests.size();
+                                     return;
+                                   }
+                                 read.done += static_cast<uint64_t>( got );
+                               }
+                             bytes += read.done;
+                             visited += Decode( read, windows, visit );
+                           }
+                       } );
+  for( size_t t = 0; t < pool.size(); t++ )
+    pool[t].join();
+  bytesRead = bytes.load();
+  if( !error.empty() )
+    throw std::runtime_error( "TimeRangeReader: " + error );
+  return visited.load();
+}
+
+#endif
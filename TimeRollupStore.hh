@@ -0,0 +1,391 @@
+////////////////////////////////////////////////////////////////////
+/// \class TimeRollupStore
+///
+/// \brief  Append only multi resolution rollups of a time series
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file for the monitoring dashboards.
+///
+/// \details Each point (packed time, value) updates one count, sum,
+///         min and max bucket at each of 4 levels, 1 s, 1 min, 1 h and
+///         1 day. Buckets are aligned to t0, so every bucket of a level
+///         is exactly tiled by buckets of the level below. A point costs
+///         O(levels) as points arrive almost in time order and only the
+///         last bucket of each level is touched, late points fall back
+///         to a binary search.
+///
+///         Each level is a RollupSegment, a file of fixed size records
+///         that is memory mapped and grown by doubling, so the store
+///         survives restarts and the OS does the write back.
+///
+///         Range queries use the coarsest level whose buckets fit inside
+///         the range and descend only for the ragged edges, so a query
+///         reads at most 2 x (60 + 60 + 24) buckets plus one per day.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_TimeRollupStore__
+#define __RAT_DS_TimeRollupStore__
+
+#include <PackedTime.hh>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/// Aggregate of the points in one bucket or one query range
+struct RollupBucket
+{
+  PackedTime start; ///< Start of the bucket, a multiple of the level width
+  uint64_t count; ///< Number of points
+  double sum; ///< Sum of the values
+  double minimum; ///< Smallest value
+  double maximum; ///< Largest value
+
+  /// Get an empty aggregate
+  static RollupBucket Empty( const PackedTime start_ = 0 )
+  {
+    RollupBucket bucket = { start_, 0, 0.0, std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() };
+    return bucket;
+  }
+
+  /// Add a point
+  void Fill( const double value )
+  {
+    count++;
+    sum += value;
+    minimum = std::min( minimum, value );
+    maximum = std::max( maximum, value );
+  }
+
+  /// Add another aggregate
+  void Merge( const RollupBucket& rhs )
+  {
+    count += rhs.count;
+    sum += rhs.sum;
+    minimum = std::min( minimum, rhs.minimum );
+    maximum = std::max( maximum, rhs.maximum );
+  }
+};
+
+////////////////////////////////////////////////////////////////////
+/// \class RollupSegment
+///
+/// \brief  Memory mapped, growable file of time ordered RollupBuckets
+///
+////////////////////////////////////////////////////////////////////
+class RollupSegment
+{
+public:
+  /// Open or create a segment file
+  ///
+  /// @param[in] path_ of the file
+  /// @param[in] width_ of the buckets (ns), must match an existing file
+  inline RollupSegment( const std::string& path_, const int64_t width_ );
+
+  inline ~RollupSegment();
+
+  /// Get the bucket width
+  ///
+  /// @return width in ns
+  int64_t GetWidth() const { return header->width; }
+
+  /// Get the number of buckets
+  ///
+  /// @return buckets
+  size_t GetSize() const { return header->size; }
+
+  /// Get a bucket
+  ///
+  /// @param[in] i index
+  /// @return the bucket
+  const RollupBucket& At( const size_t i ) const { return buckets[i]; }
+
+  /// Add a point to the bucket holding time
+  ///
+  /// @param[in] time of the point
+  /// @param[in] value of the point
+  inline void Fill( const PackedTime time, const double value );
+
+  /// Add the buckets starting in [begin, end) to an aggregate
+  ///
+  /// @param[in] begin of the range
+  /// @param[in] end of the range
+  /// @param[in,out] total to add to
+  inline void Aggregate( const PackedTime begin, const PackedTime end, RollupBucket& total ) const;
+
+  /// Flush the mapped pages to the file, throws runtime_error if it fails
+  void Sync()
+  {
+    if( msync( mapping, mappedBytes, MS_SYNC ) != 0 )
+      throw std::runtime_error( "RollupSegment: cannot sync " + path + ": " + std::strerror( errno ) );
+  }
+
+protected:
+  static constexpr uint64_t kMagic = 0x31505552544e5573ULL; ///< File signature
+
+  /// File header, padded to a record multiple
+  struct Header
+  {
+    uint64_t magic;
+    int64_t width;
+    uint64_t size;
+    uint64_t capacity;
+    uint64_t padding;
+  };
+
+  /// Map the file with room for capacity buckets, the old mapping stays if it fails
+  inline void Map( const uint64_t capacity );
+
+  /// Unmap and close the file
+  inline void Close();
+
+  /// Get the first bucket starting at or after start
+  size_t LowerBound( const PackedTime start ) const
+  {
+    const RollupBucket* found = std::lower_bound( buckets, buckets + header->size, start,
+                                                  []( const RollupBucket& bucket, const PackedTime value ) { return bucket.start < value; } );
+    return found - buckets;
+  }
+
+  std::string path; ///< File path
+  int fd; ///< File descriptor
+  void* mapping; ///< Start of the mapping
+  size_t mappedBytes; ///< Length of the mapping
+  Header* header; ///< Header at the start of the mapping
+  RollupBucket* buckets; ///< Records after the header
+
+private:
+  RollupSegment( const RollupSegment& );
+  RollupSegment& operator=( const RollupSegment& );
+};
+
+inline
+RollupSegment::RollupSegment( const std::string& path_, const int64_t width_ )
+  : path(path_), fd(-1), mapping(0), mappedBytes(0), header(0), buckets(0)
+{
+  fd = open( path.c_str(), O_RDWR | O_CREAT, 0644 );
+  if( fd < 0 )
+    throw std::runtime_error( "RollupSegment: cannot open " + path + ": " + std::strerror( errno ) );
+  try
+    {
+      struct stat info;
+      if( fstat( fd, &info ) != 0 )
+        throw std::runtime_error( "RollupSegment: cannot stat " + path + ": " + std::strerror( errno ) );
+      if( info.st_size == 0 )
+        {
+          Map( 1024 );
+          header->magic = kMagic;
+          header->width = width_;
+          header->size = 0;
+        }
+      else
+        {
+          Header existing;
+          if( pread( fd, &existing, sizeof( existing ), 0 ) != static_cast<ssize_t>( sizeof( existing ) ) || existing.magic != kMagic )
+            throw std::runtime_error( "RollupSegment: " + path + " is not a rollup segment" );
+          if( existing.width != width_ )
+            throw std::runtime_error( "RollupSegment: " + path + " has a different bucket width" );
+          // A header that does not describe the file would map too little, or index past the mapping
+          const uint64_t maxCapacity = ( std::numeric_limits<off_t>::max() - sizeof( Header ) ) / sizeof( RollupBucket );
+          if( existing.capacity == 0 || existing.capacity > maxCapacity || existing.size > existing.capacity
+              || sizeof( Header ) + existing.capacity * sizeof( RollupBucket ) != static_cast<uint64_t>( info.st_size ) )
+            throw std::runtime_error( "RollupSegment: " + path + " has a corrupt header" );
+          Map( existing.capacity );
+        }
+    }
+  catch( ... )
+    {
+      // The destructor does not run for a constructor that throws
+      Close();
+      throw;
+    }
+}
+
+inline
+RollupSegment::~RollupSegment()
+{
+  Close();
+}
+
+inline void
+RollupSegment::Close()
+{
+  if( mapping != 0 )
+    munmap( mapping, mappedBytes );
+  mapping = 0;
+  header = 0;
+  buckets = 0;
+  if( fd >= 0 )
+    close( fd );
+  fd = -1;
+}
+
+inline void
+RollupSegment::Map( const uint64_t capacity )
+{
+  // The file only grows, so the old mapping stays valid until the new one is in place
+  const size_t bytes = sizeof( Header ) + capacity * sizeof( RollupBucket );
+  if( ftruncate( fd, bytes ) != 0 )
+    throw std::runtime_error( "RollupSegment: cannot grow " + path + ": " + std::strerror( errno ) );
+  void* grown = mmap( 0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+  if( grown == MAP_FAILED )
+    {
+      std::string message = "RollupSegment: cannot map " + path + ": " + std::strerror( errno );
+      // Back to the size the header describes, so the file still opens
+      if( mapping != 0 && ftruncate( fd, mappedBytes ) != 0 )
+        message += ", nor shrink it back";
+      throw std::runtime_error( message );
+    }
+  if( mapping != 0 )
+    munmap( mapping, mappedBytes );
+  mapping = grown;
+  mappedBytes = bytes;
+  header = static_cast<Header*>( mapping );
+  buckets = reinterpret_cast<RollupBucket*>( header + 1 );
+  header->capacity = capacity;
+}
+
+inline void
+RollupSegment::Fill( const PackedTime time, const double value )
+{
+  const int64_t width = header->width;
+  const PackedTime start = PackedTimes::FloorDivide( time, width ) * width;
+  size_t size = header->size;
+  if( size > 0 && buckets[size - 1].start == start ) // The common case
+    {
+      buckets[size - 1].Fill( value );
+      return;
+    }
+  size_t index = size;
+  if( size > 0 && buckets[size - 1].start > start ) // Late point
+    {
+      index = LowerBound( start );
+      if( buckets[index].start == start )
+        {
+          buckets[index].Fill( value );
+          return;
+        }
+    }
+  if( size == header->capacity )
+    Map( header->capacity * 2 );
+  std::memmove( buckets + index + 1, buckets + index, ( size - index ) * sizeof( RollupBucket ) );
+  buckets[index] = RollupBucket::Empty( start );
+  buckets[index].Fill( value );
+  header->size = size + 1;
+}
+
+inline void
+RollupSegment::Aggregate( const PackedTime begin, const PackedTime end, RollupBucket& total ) const
+{
+  for( size_t i = LowerBound( begin ); i < header->size && buckets[i].start < end; i++ )
+    total.Merge( buckets[i] );
+}
+
+class TimeRollupStore
+{
+public:
+  static constexpr size_t kLevels = 4; ///< 1 s, 1 min, 1 h and 1 day
+
+  /// Open or create a store, one segment file per level
+  ///
+  /// @param[in] directory_ to hold the segment files, must exist
+  TimeRollupStore( const std::string& directory_ )
+  {
+    static const char* names[kLevels] = { "1s", "1min", "1h", "1d" };
+    for( size_t level = 0; level < kLevels; level++ )
+      segments.push_back( std::unique_ptr<RollupSegment>( new RollupSegment( directory_ + "/rollup_" + names[level] + ".seg",
+                                                                             GetWidth( level ) ) ) );
+  }
+
+  /// Add a point to every level
+  ///
+  /// @param[in] time of the point
+  /// @param[in] value of the point
+  void Fill( const PackedTime time, const double value )
+  {
+    for( size_t level = 0; level < kLevels; level++ )
+      segments[level]->Fill( time, value );
+  }
+
+  /// Aggregate the points in a range, which is widened to whole seconds
+  ///
+  /// @param[in] begin of the range
+  /// @param[in] end of the range, exclusive
+  /// @return the aggregate, its start is the widened begin
+  RollupBucket Query( const PackedTime begin, const PackedTime end ) const
+  {
+    const int64_t second = GetWidth( 0 );
+    const PackedTime from = PackedTimes::FloorDivide( begin, second ) * second;
+    const PackedTime to = -PackedTimes::FloorDivide( -end, second ) * second;
+    RollupBucket total = RollupBucket::Empty( from );
+    if( from < to )
+      Aggregate( kLevels - 1, from, to, total );
+    return total;
+  }
+
+  /// Get a level's segment
+  ///
+  /// @param[in] level index, 0 is the finest
+  /// @return the segment
+  const RollupSegment& GetSegment( const size_t level ) const { return *segments[level]; }
+
+  /// Get the bucket width of a level
+  ///
+  /// @param[in] level index, 0 is the finest
+  /// @return width in ns
+  static int64_t GetWidth( const size_t level )
+  {
+    static const int64_t seconds[kLevels] = { 1, 60, 3600, PackedTimes::kSecondsPerDay };
+    return seconds[level] * PackedTimes::kNanoSecondsPerSecond;
+  }
+
+  /// Flush every level to its file
+  void Sync()
+  {
+    for( size_t level = 0; level < kLevels; level++ )
+      segments[level]->Sync();
+  }
+
+protected:
+  /// Add [begin, end), both multiples of the finest width, using level and finer
+  void Aggregate( const size_t level, const PackedTime begin, const PackedTime end, RollupBucket& total ) const
+  {
+    if( level == 0 )
+      {
+        segments[0]->Aggregate( begin, end, total );
+        return;
+      }
+    const int64_t width = GetWidth( level );
+    const PackedTime inner = -PackedTimes::FloorDivide( -begin, width ) * width;
+    const PackedTime outer = PackedTimes::FloorDivide( end, width ) * width;
+    if( inner >= outer ) // No whole bucket fits at this level
+      {
+        Aggregate( level - 1, begin, end, total );
+        return;
+      }
+    segments[level]->Aggregate( inner, outer, total );
+    if( begin < inner )
+      Aggregate( level - 1, begin, inner, total );
+    if( outer < end )
+      Aggregate( level - 1, outer, end, total );
+  }
+
+  std::vector<std::unique_ptr<RollupSegment> > segments; ///< One per level, finest first
+
+private:
+  TimeRollupStore( const TimeRollupStore& );
+  TimeRollupStore& operator=( const TimeRollupStore& );
+};
+
+#endif
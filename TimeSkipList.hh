@@ -0,0 +1,389 @@
+////////////////////////////////////////////////////////////////////
+/// \class TimeSkipList
+///
+/// \brief  Lock free ordered index of recent events by packed time
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file for the online event display.
+///
+/// \details A skiplist of (time, value) nodes that any number of threads
+///         insert into with compare and swaps while others scan time
+///         ranges without ever waiting. Equal times are kept in the
+///         order they were inserted.
+///
+///         Memory goes only from the front: Evict unlinks the events
+///         older than a cutoff, age before the latest time by default,
+///         marking each node's next pointers first, as in Harris' list,
+///         so no insert can link onto a node being removed. Inserts
+///         that meet a marked node help unlink it and retry. Nodes are
+///         deleted once a QsbrDomain grace period has passed, so
+///         inserting and scanning threads are readers of the domain and
+///         call Quiescent between batches, holding no values across it:
+///
+///           const size_t reader = domain.RegisterReader();
+///           index.Insert( time, event );                     // Builder threads
+///           index.Scan( begin, end, []( PackedTime, const T& ) { ... } ); // Display
+///           domain.Quiescent( reader );
+///           index.Evict();                                   // Any thread, now and then
+///
+///         Evict is serialised and stops at a node still being inserted,
+///         and inserts older than the last cutoff are refused, so an
+///         event may outlive its cutoff until the next Evict but is never
+///         lost while newer than it.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_TimeSkipList__
+#define __RAT_DS_TimeSkipList__
+
+#include <PackedTime.hh>
+#include <QsbrDomain.hh>
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+template<class T>
+class TimeSkipList
+{
+public:
+  static constexpr int kMaxHeight = 16; ///< Levels, enough for 4^16 events
+
+  /// Construct an empty index
+  ///
+  /// @param[in] domain_ the inserting and scanning threads register with, must outlive this
+  /// @param[in] maxAge_ kept behind the latest time by Evict() (ns)
+  inline TimeSkipList( QsbrDomain& domain_, const PackedTime maxAge_ );
+
+  /// Delete every node, no thread may still use the index
+  inline ~TimeSkipList();
+
+  TimeSkipList( const TimeSkipList& ) = delete;
+  TimeSkipList& operator=( const TimeSkipList& ) = delete;
+
+  /// Insert an event, from an online reader of the domain
+  ///
+  /// @param[in] time of the event
+  /// @param[in] value of the event
+  /// @return false if the time is before the last eviction cutoff and the event was dropped
+  inline bool Insert( const PackedTime time, const T& value );
+
+  /// Visit the events of a time range in time order, from an online reader of the domain
+  ///
+  /// @param[in] begin of the range
+  /// @param[in] end of the range, exclusive
+  /// @param[in] visit called with each time and value
+  /// @return number of events visited
+  template<class TVisitor>
+  size_t Scan( const PackedTime begin, const PackedTime end, TVisitor visit ) const
+  {
+    const Node* pred = head;
+    for( int level = kMaxHeight - 1; level >= 0; level-- )
+      for( const Node* next = Pointer( pred->next[level].load( std::memory_order_acquire ) );
+           next != 0 && next->time < begin; next = Pointer( pred->next[level].load( std::memory_order_acquire ) ) )
+        pred = next;
+    // Evicted nodes still lead forwards, they are stepped over
+    size_t visited = 0;
+    const Node* node = Pointer( pred->next[0].load( std::memory_order_acquire ) );
+    while( node != 0 && node->time < end )
+      {
+        const uintptr_t next = node->next[0].load( std::memory_order_acquire );
+        if( !Marked( next ) && node->time >= begin )
+          {
+            visit( node->time, node->value );
+            visited++;
+          }
+        node = Pointer( next );
+      }
+    return visited;
+  }
+
+  /// Remove the events more than maxAge before the latest
+  ///
+  /// @return number of events removed
+  size_t Evict()
+  {
+    const PackedTime last = latest.load( std::memory_order_acquire );
+    return last < std::numeric_limits<PackedTime>::min() + maxAge ? 0 : Evict( last - maxAge );
+  }
+
+  /// Remove the events before a cutoff and refuse later inserts before it
+  ///
+  /// @param[in] cutoff time
+  /// @return number of events removed
+  inline size_t Evict( const PackedTime cutoff );
+
+  /// Delete the evicted nodes no reader can see, never blocks
+  ///
+  /// @return number of nodes still waiting
+  size_t Reclaim()
+  {
+    std::lock_guard<std::mutex> lock( evictMutex );
+    return ReclaimSafe();
+  }
+
+  /// Get the number of events, exact when no insert or eviction is running
+  ///
+  /// @return count
+  size_t GetSize() const { return size.load( std::memory_order_relaxed ); }
+
+  /// Get the latest time inserted
+  ///
+  /// @return time, the lowest PackedTime before any insert
+  PackedTime GetLatest() const { return latest.load( std::memory_order_acquire ); }
+
+protected:
+  struct Node
+  {
+    PackedTime time; ///< Key
+    T value; ///< Event
+    int height; ///< Levels the node is on
+    std::atomic<bool> linked; ///< Linked on every level, may be evicted
+    std::atomic<uintptr_t> next[1]; ///< Successor per level, bit 0 set once evicted, height entries
+  };
+
+  /// Strip the mark from a next word
+  static Node* Pointer( const uintptr_t word ) { return reinterpret_cast<Node*>( word & ~static_cast<uintptr_t>( 1 ) ); }
+
+  /// Check the mark of a next word
+  static bool Marked( const uintptr_t word ) { return ( word & 1 ) != 0; }
+
+  /// Delete the evicted nodes no reader can see, evictMutex held
+  ///
+  /// @return number of nodes still waiting
+  inline size_t ReclaimSafe();
+
+  /// Allocate a node with room for its levels
+  inline static Node* NewNode( const PackedTime time, const T& value, const int height );
+
+  /// Destroy and free a node
+  inline static void DeleteNode( Node* node );
+
+  /// Draw a height, geometric with p = 1/4
+  inline static int RandomHeight();
+
+  /// Find the last node at or before a time on each level, unlinking evicted nodes on the way
+  ///
+  /// @param[in] time to find
+  /// @param[out] preds last node at or before time per level
+  /// @param[out] succs node after preds per level
+  inline void Find( const PackedTime time, Node** preds, Node** succs );
+
+  QsbrDomain& domain; ///< Domain of the readers
+  Node* head; ///< Sentinel on every level
+  PackedTime maxAge; ///< Age kept by Evict()
+  std::atomic<PackedTime> floor; ///< Last eviction cutoff
+  std::atomic<PackedTime> latest; ///< Latest time inserted
+  std::atomic<size_t> size; ///< Events held
+
+  std::mutex evictMutex; ///< Serialises Evict and Reclaim
+  std::vector<std::pair<uint64_t, std::vector<Node*> > > retired; ///< Evicted nodes by grace period epoch
+};
+
+template<class T>
+inline
+TimeSkipList<T>::TimeSkipList( QsbrDomain& domain_, const PackedTime maxAge_ )
+  : domain(domain_), head(NewNode( std::numeric_limits<PackedTime>::min(), T(), kMaxHeight )), maxAge(maxAge_),
+    floor(std::numeric_limits<PackedTime>::min()), latest(std::numeric_limits<PackedTime>::min()), size(0)
+{
+  head->linked.store( true, std::memory_order_relaxed );
+}
+
+template<class T>
+inline
+TimeSkipList<T>::~TimeSkipList()
+{
+  for( Node* node = head; node != 0; )
+    {
+      Node* next = Pointer( node->next[0].load( std::memory_order_acquire ) );
+      DeleteNode( node );
+      node = next;
+    }
+  for( size_t i = 0; i < retired.size(); i++ )
+    for( size_t n = 0; n < retired[i].second.size(); n++ )
+      DeleteNode( retired[i].second[n] );
+}
+
+template<class T>
+inline bool
+TimeSkipList<T>::Insert( const PackedTime time, const T& value )
+{
+  if( time < floor.load( std::memory_order_acquire ) )
+    return false;
+  Node* node = NewNode( time, value, RandomHeight() );
+  Node* preds[kMaxHeight];
+  Node* succs[kMaxHeight];
+  // Level 0 makes the event visible, it is in the index from then on
+  for( ;; )
+    {
+      Find( time, preds, succs );
+      for( int level = 0; level < node->height; level++ )
+        node->next[level].store( reinterpret_cast<uintptr_t>( succs[level] ), std::memory_order_relaxed );
+      uintptr_t expected = reinterpret_cast<uintptr_t>( succs[0] );
+      if( preds[0]->next[0].compare_exchange_strong( expected, reinterpret_cast<uintptr_t>( node ),
+                                                     std::memory_order_release, std::memory_order_relaxed ) )
+        break;
+    }
+  // Not yet linked, so not evicted, and only this thread writes the upper levels
+  for( int level = 1; level < node->height; level++ )
+    for( ;; )
+      {
+        uintptr_t expected = reinterpret_cast<uintptr_t>( succs[level] );
+        if( preds[level]->next[level].compare_exchange_strong( expected, reinterpret_cast<uintptr_t>( node ),
+                                                               std::memory_order_release, std::memory_order_relaxed ) )
+          break;
+        Find( time, preds, succs );
+        node->next[level].store( reinterpret_cast<uintptr_t>( succs[level] ), std::memory_order_relaxed );
+      }
+  node->linked.store( true, std::memory_order_release );
+  size.fetch_add( 1, std::memory_order_relaxed );
+  PackedTime last = latest.load( std::memory_order_relaxed );
+  while( last < time && !latest.compare_exchange_weak( last, time, std::memory_order_release, std::memory_order_relaxed ) )
+    {
+    }
+  return true;
+}
+
+template<class T>
+inline void
+TimeSkipList<T>::Find( const PackedTime time, Node** preds, Node** succs )
+{
+retry:
+  Node* pred = head;
+  for( int level = kMaxHeight - 1; level >= 0; level-- )
+    {
+      Node* curr = Pointer( pred->next[level].load( std::memory_order_acquire ) );
+      while( curr != 0 )
+        {
+          const uintptr_t next = curr->next[level].load( std::memory_order_acquire );
+          if( Marked( next ) )
+            {
+              // Evicted, unlink it here, starting again if pred changed under us
+              uintptr_t expected = reinterpret_cast<uintptr_t>( curr );
+              if( !pred->next[level].compare_exchange_strong( expected, next & ~static_cast<uintptr_t>( 1 ),
+                                                              std::memory_order_acq_rel, std::memory_order_acquire ) )
+                goto retry;
+              curr = Pointer( next );
+            }
+          else if( curr->time <= time )
+            {
+              pred = curr;
+              curr = Pointer( next );
+            }
+          else
+            break;
+        }
+      preds[level] = pred;
+      succs[level] = curr;
+    }
+}
+
+template<class T>
+inline size_t
+TimeSkipList<T>::Evict( const PackedTime cutoff )
+{
+  std::lock_guard<std::mutex> lock( evictMutex );
+  if( cutoff > floor.load( std::memory_order_relaxed ) )
+    floor.store( cutoff, std::memory_order_release );
+  // Mark the fully linked front, top level first so level 0, the membership, goes last
+  std::vector<Node*> victims;
+  Node* node = Pointer( head->next[0].load( std::memory_order_acquire ) );
+  while( node != 0 && node->time < cutoff && node->linked.load( std::memory_order_acquire ) )
+    {
+      for( int level = node->height - 1; level >= 0; level-- )
+        node->next[level].fetch_or( 1, std::memory_order_acq_rel );
+      victims.push_back( node );
+      node = Pointer( node->next[0].load( std::memory_order_acquire ) );
+    }
+  const size_t removed = victims.size();
+  if( removed > 0 )
+    {
+      // Walk each level from the head, inserts racing this one may have put
+      // unmarked nodes among the marked, so a search could start past some
+      const PackedTime last = victims.back()->time;
+      for( int level = kMaxHeight - 1; level >= 0; level-- )
+        {
+          Node* pred = head;
+          Node* curr = Pointer( pred->next[level].load( std::memory_order_acquire ) );
+          while( curr != 0 && curr->time <= last )
+            {
+              const uintptr_t next = curr->next[level].load( std::memory_order_acquire );
+              if( !Marked( next ) )
+                {
+                  pred = curr;
+                  curr = Pointer( next );
+                  continue;
+                }
+              // Only the evictor marks, so pred stays unmarked and a failure means an insert or a helper moved it on
+              uintptr_t expected = reinterpret_cast<uintptr_t>( curr );
+              pred->next[level].compare_exchange_strong( expected, next & ~static_cast<uintptr_t>( 1 ),
+                                                         std::memory_order_acq_rel, std::memory_order_acquire );
+              curr = Pointer( pred->next[level].load( std::memory_order_acquire ) );
+            }
+        }
+      size.fetch_sub( removed, std::memory_order_relaxed );
+      retired.push_back( std::make_pair( domain.Advance(), std::vector<Node*>() ) );
+      retired.back().second.swap( victims );
+    }
+  ReclaimSafe();
+  return removed;
+}
+
+template<class T>
+inline size_t
+TimeSkipList<T>::ReclaimSafe()
+{
+  size_t i = 0;
+  for( ; i < retired.size() && domain.IsSafe( retired[i].first ); i++ )
+    for( size_t n = 0; n < retired[i].second.size(); n++ )
+      DeleteNode( retired[i].second[n] );
+  retired.erase( retired.begin(), retired.begin() + i );
+  size_t waiting = 0;
+  for( i = 0; i < retired.size(); i++ )
+    waiting += retired[i].second.size();
+  return waiting;
+}
+
+template<class T>
+inline typename TimeSkipList<T>::Node*
+TimeSkipList<T>::NewNode( const PackedTime time, const T& value, const int height )
+{
+  void* memory = ::operator new( sizeof( Node ) + ( height - 1 ) * sizeof( std::atomic<uintptr_t> ) );
+  Node* node = static_cast<Node*>( memory );
+  new( &node->time ) PackedTime( time );
+  new( &node->value ) T( value );
+  node->height = height;
+  new( &node->linked ) std::atomic<bool>( false );
+  for( int level = 0; level < height; level++ )
+    new( &node->next[level] ) std::atomic<uintptr_t>( 0 );
+  return node;
+}
+
+template<class T>
+inline void
+TimeSkipList<T>::DeleteNode( Node* node )
+{
+  node->value.~T();
+  ::operator delete( node );
+}
+
+template<class T>
+inline int
+TimeSkipList<T>::RandomHeight()
+{
+  // xorshift per thread, seeded from the thread's own state address
+  thread_local uint64_t state = reinterpret_cast<uintptr_t>( &state ) * 0x9e3779b97f4a7c15ull | 1;
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  int height = 1;
+  for( uint64_t bits = state; height < kMaxHeight && ( bits & 3 ) == 0; bits >>= 2 )
+    height++;
+  return height;
+}
+
+#endif
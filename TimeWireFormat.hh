@@ -0,0 +1,427 @@
+////////////////////////////////////////////////////////////////////
+/// \class TimeWireFormat
+///
+/// \brief  Binary timestamps for the monitoring feeds, MessagePack and CBOR
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file, replaces GetTime strings in the event summaries.
+///
+/// \details Times go out as the MessagePack timestamp extension, type
+///         -1, or as CBOR extended time, tag 1001 (RFC 9581), a map of
+///         Unix seconds under key 1 and nanoseconds under key -9. Both
+///         count from 1970, so t0 is added on the way out and taken off
+///         on the way in. UniversalTime goes through PackedTime, at ns
+///         resolution.
+///
+///         Encode writes the smallest form of one time. The bulk Encode
+///         over packed time arrays writes the fixed width form every
+///         time in 1970-2106 takes, a constant header then big endian
+///         fields, which any decoder reads the same: MessagePack
+///         timestamp 64, 10 bytes, and a CBOR map of a 4 byte seconds
+///         and a 4 byte nanoseconds, 16 bytes. Other times fall back to
+///         the general form. Buffers need kMsgPackMaxBytes or
+///         kCborMaxBytes per time.
+///
+///         Decode reads any valid form in place, nothing is allocated,
+///         and returns the bytes used, 0 for a truncated, malformed or
+///         out of range item. CBOR decoding also takes key -3 and -6,
+///         ms and us, but not floating point seconds.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_TimeWireFormat__
+#define __RAT_DS_TimeWireFormat__
+
+#include <PackedTime.hh>
+
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#include <type_traits>
+
+class TimeWireFormat
+{
+public:
+  static constexpr size_t kMsgPackMaxBytes = 15; ///< Timestamp 96
+  static constexpr size_t kCborMaxBytes = 20; ///< Tag, map, 8 byte seconds, 4 byte nanoseconds
+
+  /// Encode a time as a MessagePack timestamp, the smallest form
+  ///
+  /// @param[in] time to encode
+  /// @param[out] out at least kMsgPackMaxBytes
+  /// @return bytes written, 6, 10 or 15
+  static size_t EncodeMsgPack( const PackedTime time, uint8_t* out )
+  {
+    int64_t seconds;
+    uint32_t nanoSeconds;
+    ToUnix( time, seconds, nanoSeconds );
+    if( ( seconds >> 34 ) == 0 )
+      {
+        if( nanoSeconds == 0 && ( seconds >> 32 ) == 0 )
+          {
+            out[0] = 0xd6;
+            out[1] = 0xff;
+            StoreBig32( out + 2, static_cast<uint32_t>( seconds ) );
+            return 6;
+          }
+        std::memcpy( out, kMsgPack64Header, 2 );
+        StoreBig64( out + 2, static_cast<uint64_t>( nanoSeconds ) << 34 | static_cast<uint64_t>( seconds ) );
+        return 10;
+      }
+    out[0] = 0xc7;
+    out[1] = 12;
+    out[2] = 0xff;
+    StoreBig32( out + 3, nanoSeconds );
+    StoreBig64( out + 7, static_cast<uint64_t>( seconds ) );
+    return 15;
+  }
+
+  /// Encode any time class with the UniversalTime accessors
+  template<class TTime, class = typename std::enable_if<!std::is_arithmetic<TTime>::value>::type>
+  static size_t EncodeMsgPack( const TTime& time, uint8_t* out ) { return EncodeMsgPack( PackedTimes::Pack( time ), out ); }
+
+  /// Encode an array of times as consecutive MessagePack timestamps
+  ///
+  /// @param[in] times to encode
+  /// @param[in] count of times
+  /// @param[out] out at least count * kMsgPackMaxBytes
+  /// @return bytes written
+  static size_t EncodeMsgPack( const PackedTime* times, const size_t count, uint8_t* out )
+  {
+    uint8_t* const start = out;
+    for( size_t i = 0; i < count; i++ )
+      {
+        int64_t seconds;
+        uint32_t nanoSeconds;
+        ToUnix( times[i], seconds, nanoSeconds );
+        if( ( seconds >> 34 ) == 0 )
+          {
+            std::memcpy( out, kMsgPack64Header, 2 );
+            StoreBig64( out + 2, static_cast<uint64_t>( nanoSeconds ) << 34 | static_cast<uint64_t>( seconds ) );
+            out += 10;
+          }
+        else
+          out += EncodeMsgPack( times[i], out );
+      }
+    return out - start;
+  }
+
+  /// Decode a MessagePack timestamp
+  ///
+  /// @param[in] in encoded bytes
+  /// @param[in] size bytes available
+  /// @param[out] time decoded
+  /// @return bytes used, 0 if not a valid timestamp
+  static size_t DecodeMsgPack( const uint8_t* in, const size_t size, PackedTime& time )
+  {
+    if( size < 6 || in[0] < 0xc7 || in[0] > 0xd7 )
+      return 0;
+    int64_t seconds;
+    uint32_t nanoSeconds;
+    size_t used;
+    if( in[0] == 0xd6 && in[1] == 0xff )
+      {
+        seconds = LoadBig32( in + 2 );
+        nanoSeconds = 0;
+        used = 6;
+      }
+    else if( in[0] == 0xd7 && in[1] == 0xff && size >= 10 )
+      {
+        const uint64_t bits = LoadBig64( in + 2 );
+        seconds = static_cast<int64_t>( bits & ( ( uint64_t( 1 ) << 34 ) - 1 ) );
+        nanoSeconds = static_cast<uint32_t>( bits >> 34 );
+        used = 10;
+      }
+    else if( in[0] == 0xc7 && in[1] == 12 && in[2] == 0xff && size >= 15 )
+      {
+        nanoSeconds = LoadBig32( in + 3 );
+        seconds = static_cast<int64_t>( LoadBig64( in + 7 ) );
+        used = 15;
+      }
+    else
+      return 0;
+    return FromUnix( seconds, nanoSeconds, time ) ? used : 0;
+  }
+
+  /// Decode consecutive MessagePack timestamps
+  ///
+  /// @param[in] in encoded bytes
+  /// @param[in] size bytes available
+  /// @param[out] times decoded
+  /// @param[in] count most times to decode
+  /// @param[out] used bytes used, if not null
+  /// @return times decoded, stops at the first that is not a valid timestamp
+  static size_t DecodeMsgPack( const uint8_t* in, const size_t size, PackedTime* times, const size_t count,
+                               size_t* used = 0 )
+  {
+    size_t offset = 0, decoded = 0;
+    for( ; decoded < count; decoded++ )
+      {
+        // The bulk encoder's form inline, anything else the long way
+        if( size - offset >= 10 && in[offset] == 0xd7 && in[offset + 1] == 0xff )
+          {
+            const uint64_t bits = LoadBig64( in + offset + 2 );
+            if( !FromUnix( static_cast<int64_t>( bits & ( ( uint64_t( 1 ) << 34 ) - 1 ) ), static_cast<uint32_t>( bits >> 34 ),
+                           times[decoded] ) )
+              break;
+            offset += 10;
+            continue;
+          }
+        const size_t bytes = DecodeMsgPack( in + offset, size - offset, times[decoded] );
+        if( bytes == 0 )
+          break;
+        offset += bytes;
+      }
+    if( used != 0 )
+      *used = offset;
+    return decoded;
+  }
+
+  /// Encode a time as CBOR extended time, the smallest form
+  ///
+  /// @param[in] time to encode
+  /// @param[out] out at least kCborMaxBytes
+  /// @return bytes written
+  static size_t EncodeCbor( const PackedTime time, uint8_t* out )
+  {
+    int64_t seconds;
+    uint32_t nanoSeconds;
+    ToUnix( time, seconds, nanoSeconds );
+    std::memcpy( out, kCborHeader, 3 );
+    out[3] = nanoSeconds == 0 ? 0xa1 : 0xa2;
+    out[4] = 0x01;
+    size_t used = 5;
+    used += seconds < 0 ? StoreCborArgument( out + used, 0x20, static_cast<uint64_t>( -1 - seconds ) )
+                        : StoreCborArgument( out + used, 0x00, static_cast<uint64_t>( seconds ) );
+    if( nanoSeconds != 0 )
+      {
+        out[used++] = 0x28;
+        used += StoreCborArgument( out + used, 0x00, nanoSeconds );
+      }
+    return used;
+  }
+
+  /// Encode any time class with the UniversalTime accessors
+  template<class TTime, class = typename std::enable_if<!std::is_arithmetic<TTime>::value>::type>
+  static size_t EncodeCbor( const TTime& time, uint8_t* out ) { return EncodeCbor( PackedTimes::Pack( time ), out ); }
+
+  /// Encode an array of times as consecutive CBOR extended times
+  ///
+  /// @param[in] times to encode
+  /// @param[in] count of times
+  /// @param[out] out at least count * kCborMaxBytes
+  /// @return bytes written
+  static size_t EncodeCbor( const PackedTime* times, const size_t count, uint8_t* out )
+  {
+    uint8_t* const start = out;
+    for( size_t i = 0; i < count; i++ )
+      {
+        int64_t seconds;
+        uint32_t nanoSeconds;
+        ToUnix( times[i], seconds, nanoSeconds );
+        if( ( seconds >> 32 ) == 0 )
+          {
+            std::memcpy( out, kCborFixedHeader, 6 );
+            StoreBig32( out + 6, static_cast<uint32_t>( seconds ) );
+            out[10] = 0x28;
+            out[11] = 0x1a;
+            StoreBig32( out + 12, nanoSeconds );
+            out += 16;
+          }
+        else
+          out += EncodeCbor( times[i], out );
+      }
+    return out - start;
+  }
+
+  /// Decode a CBOR extended time
+  ///
+  /// @param[in] in encoded bytes
+  /// @param[in] size bytes available
+  /// @param[out] time decoded
+  /// @return bytes used, 0 if not a valid extended time
+  static size_t DecodeCbor( const uint8_t* in, const size_t size, PackedTime& time )
+  {
+    if( size < 6 || std::memcmp( in, kCborHeader, 3 ) != 0 || in[3] < 0xa1 || in[3] > 0xa2 )
+      return 0;
+    const uint8_t* const end = in + size;
+    const uint8_t* next = in + 4;
+    int64_t seconds = 0, fraction = 0, scale = 0;
+    bool haveSeconds = false;
+    for( int entry = 0; entry < in[3] - 0xa0; entry++ )
+      {
+        int64_t key, value;
+        if( !LoadCborInteger( next, end, key ) || !LoadCborInteger( next, end, value ) )
+          return 0;
+        if( key == 1 && !haveSeconds )
+          {
+            seconds = value;
+            haveSeconds = true;
+          }
+        else if( ( key == -9 || key == -6 || key == -3 ) && scale == 0 )
+          {
+            scale = key == -9 ? 1 : key == -6 ? 1000 : 1000000;
+            if( value < 0 || value >= PackedTimes::kNanoSecondsPerSecond / scale )
+              return 0;
+            fraction = value * scale;
+          }
+        else
+          return 0;
+      }
+    if( !haveSeconds || !FromUnix( seconds, static_cast<uint32_t>( fraction ), time ) )
+      return 0;
+    return next - in;
+  }
+
+  /// Decode consecutive CBOR extended times
+  ///
+  /// @param[in] in encoded bytes
+  /// @param[in] size bytes available
+  /// @param[out] times decoded
+  /// @param[in] count most times to decode
+  /// @param[out] used bytes used, if not null
+  /// @return times decoded, stops at the first that is not a valid extended time
+  static size_t DecodeCbor( const uint8_t* in, const size_t size, PackedTime* times, const size_t count, size_t* used = 0 )
+  {
+    size_t offset = 0, decoded = 0;
+    for( ; decoded < count; decoded++ )
+      {
+        // The bulk encoder's form inline, anything else the long way
+        if( size - offset >= 16 && std::memcmp( in + offset, kCborFixedHeader, 6 ) == 0 && in[offset + 10] == 0x28
+            && in[offset + 11] == 0x1a )
+          {
+            if( !FromUnix( LoadBig32( in + offset + 6 ), LoadBig32( in + offset + 12 ), times[decoded] ) )
+              break;
+            offset += 16;
+            continue;
+          }
+        const size_t bytes = DecodeCbor( in + offset, size - offset, times[decoded] );
+        if( bytes == 0 )
+          break;
+        offset += bytes;
+      }
+    if( used != 0 )
+      *used = offset;
+    return decoded;
+  }
+
+protected:
+  static constexpr uint8_t kMsgPack64Header[2] = { 0xd7, 0xff }; ///< fixext 8, type -1
+  static constexpr uint8_t kCborHeader[3] = { 0xd9, 0x03, 0xe9 }; ///< Tag 1001
+  static constexpr uint8_t kCborFixedHeader[6] = { 0xd9, 0x03, 0xe9, 0xa2, 0x01, 0x1a }; ///< Tag, map of 2, key 1, uint32
+
+  /// Split into Unix seconds, floored, and nanoseconds in [0, 1e9)
+  static void ToUnix( const PackedTime time, int64_t& seconds, uint32_t& nanoSeconds )
+  {
+    const int64_t second = PackedTimes::FloorDivide( time, PackedTimes::kNanoSecondsPerSecond );
+    nanoSeconds = static_cast<uint32_t>( time - second * PackedTimes::kNanoSecondsPerSecond );
+    seconds = second + PackedTimes::kUnixT0Seconds;
+  }
+
+  /// Join Unix seconds and nanoseconds, false if out of PackedTime range
+  static bool FromUnix( const int64_t seconds, const uint32_t nanoSeconds, PackedTime& time )
+  {
+    if( nanoSeconds >= PackedTimes::kNanoSecondsPerSecond )
+      return false;
+    // The earliest second only fits with its nanoseconds, so negative seconds count down from the next one
+    int64_t second, scaled;
+    if( __builtin_sub_overflow( seconds, PackedTimes::kUnixT0Seconds, &second ) )
+      return false;
+    if( second < 0 )
+      return !__builtin_mul_overflow( second + 1, PackedTimes::kNanoSecondsPerSecond, &scaled )
+        && !__builtin_sub_overflow( scaled, PackedTimes::kNanoSecondsPerSecond - nanoSeconds, &time );
+    return !__builtin_mul_overflow( second, PackedTimes::kNanoSecondsPerSecond, &scaled )
+      && !__builtin_add_overflow( scaled, static_cast<int64_t>( nanoSeconds ), &time );
+  }
+
+  /// Store a CBOR major type and argument in the smallest form
+  static size_t StoreCborArgument( uint8_t* out, const uint8_t major, const uint64_t argument )
+  {
+    if( argument < 24 )
+      {
+        out[0] = static_cast<uint8_t>( major | argument );
+        return 1;
+      }
+    if( argument <= 0xff )
+      {
+        out[0] = major | 24;
+        out[1] = static_cast<uint8_t>( argument );
+        return 2;
+      }
+    if( argument <= 0xffff )
+      {
+        out[0] = major | 25;
+        out[1] = static_cast<uint8_t>( argument >> 8 );
+        out[2] = static_cast<uint8_t>( argument );
+        return 3;
+      }
+    if( argument <= 0xffffffff )
+      {
+        out[0] = major | 26;
+        StoreBig32( out + 1, static_cast<uint32_t>( argument ) );
+        return 5;
+      }
+    out[0] = major | 27;
+    StoreBig64( out + 1, argument );
+    return 9;
+  }
+
+  /// Load a CBOR integer, major type 0 or 1, advancing in
+  static bool LoadCborInteger( const uint8_t*& in, const uint8_t* end, int64_t& value )
+  {
+    if( in >= end )
+      return false;
+    const uint8_t major = in[0] & 0xe0;
+    const uint8_t info = in[0] & 0x1f;
+    if( major > 0x20 || info > 27 )
+      return false;
+    const size_t bytes = info < 24 ? 0 : size_t( 1 ) << ( info - 24 );
+    if( static_cast<size_t>( end - in ) < 1 + bytes )
+      return false;
+    uint64_t argument = info < 24 ? info : 0;
+    for( size_t b = 0; b < bytes; b++ )
+      argument = argument << 8 | in[1 + b];
+    if( argument > static_cast<uint64_t>( INT64_MAX ) )
+      return false;
+    value = major == 0 ? static_cast<int64_t>( argument ) : -1 - static_cast<int64_t>( argument );
+    in += 1 + bytes;
+    return true;
+  }
+
+  static void StoreBig32( uint8_t* out, uint32_t value )
+  {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    value = __builtin_bswap32( value );
+#endif
+    std::memcpy( out, &value, 4 );
+  }
+
+  static void StoreBig64( uint8_t* out, uint64_t value )
+  {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    value = __builtin_bswap64( value );
+#endif
+    std::memcpy( out, &value, 8 );
+  }
+
+  static uint32_t LoadBig32( const uint8_t* in )
+  {
+    uint32_t value;
+    std::memcpy( &value, in, 4 );
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    value = __builtin_bswap32( value );
+#endif
+    return value;
+  }
+
+  static uint64_t LoadBig64( const uint8_t* in )
+  {
+    uint64_t value;
+    std::memcpy( &value, in, 8 );
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    value = __builtin_bswap64( value );
+#endif
+    return value;
+  }
+};
+
+#endif
@@ -0,0 +1,265 @@
+////////////////////////////////////////////////////////////////////
+/// \class BasicUniversalTimeCore
+///
+/// \brief  This class represents a time in the SNO+ Universal time system
+///
+/// \author Phil G Jones <p.g.jones@qmul.ac.uk>
+///
+/// REVISION HISTORY:\n
+///  2013-1-21 : P. Jones - New file as part of ds review.\n
+///  2026-10-17 : Split out of UniversalTime as a dependency free core,
+///               UniversalTime is now a thin ROOT adapter over it.\n
+///  2026-10-17 : Branchless floor normalisation, one canonical form for
+///               either sign.\n
+///  2026-10-17 : Template on an overflow policy, UniversalTimeCore is the
+///               unchecked instance.\n
+///  2026-10-17 : constexpr throughout bar GetTime, see UniversalTimeLiterals.hh.
+///
+/// \details Universal time is the time elapsed since the start of the
+///         SNO+ epoch, t0, which is midnight on 01 Jan 2010 (GMT).
+///
+///         This header only needs the standard library, so tools that
+///         do not persist times (DAQ utilities, the batch kernels, the
+///         tests) can use it without linking or initialising ROOT.
+///
+///         Times are held in a canonical form with floor semantics,
+///         0 <= nanoSeconds < 1e9 and 0 <= seconds < 86400 with only
+///         days carrying the sign, so -1 ns is (-1, 86399, 999999999).
+///         Fields compare lexicographically in this form.
+///
+///         TArithmetic (see TimeArithmetic.hh) decides what happens when
+///         the fields overflow: UncheckedArithmetic (UniversalTimeCore,
+///         the plain integer code), CheckedArithmetic (throws) or
+///         SaturatingArithmetic (clamps). Times of different policies
+///         convert explicitly.
+///
+///         Everything except GetTime is constexpr, so constant times
+///         (windows, delays, offsets) are built and normalised by the
+///         compiler rather than at static initialisation.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_UniversalTimeCore__
+#define __RAT_DS_UniversalTimeCore__
+
+#include <TimeArithmetic.hh>
+
+#include <ctime>
+#include <stdint.h>
+
+template<class TArithmetic>
+class BasicUniversalTimeCore
+{
+public:
+  typedef TArithmetic Arithmetic;
+
+  /// Construct the class
+  constexpr BasicUniversalTimeCore() : days(0), seconds(0), nanoSeconds(0) { };
+
+  /// Construct the class with relevant timing values
+  ///
+  /// @param[in] days_ since t0
+  /// @param[in] seconds_ since t0
+  /// @param[in] nanoSeconds_ since t0
+  constexpr BasicUniversalTimeCore( const int32_t days_, const int32_t seconds_, const double nanoSeconds_ );
+
+  /// Construct the class from a time with another overflow policy
+  ///
+  /// @param[in] time to copy
+  template<class TOther>
+  explicit constexpr BasicUniversalTimeCore( const BasicUniversalTimeCore<TOther>& time )
+    : days(time.GetDays()), seconds(time.GetSeconds()), nanoSeconds(time.GetNanoSeconds()) { };
+
+  /// Get the days
+  ///
+  /// @return days
+  constexpr int32_t GetDays() const { return days; }
+
+  /// Get the seconds
+  ///
+  /// @return seconds
+  constexpr int32_t GetSeconds() const { return seconds; }
+
+  /// Get the nano seconds
+  ///
+  /// @return nano seconds
+  constexpr double GetNanoSeconds() const { return nanoSeconds; }
+
+  /// Get the time as a std time structure
+  ///
+  /// @param[in] snoPlus should the (default) snoplus (true) or sno (false) offset be used?
+  /// @return the time as a time structure
+  inline std::tm GetTime( const bool snoPlus=true ) const;
+
+  /// Add a universal time to this
+  ///
+  /// @param[in] rhs to add
+  /// @return reference to this
+  constexpr BasicUniversalTimeCore& operator+=( const BasicUniversalTimeCore& rhs );
+
+  /// Add a universal time
+  ///
+  /// @param[in] rhs to add
+  /// @return new universal time
+  constexpr BasicUniversalTimeCore operator+( const BasicUniversalTimeCore& rhs ) const { return BasicUniversalTimeCore(*this) += rhs; }
+
+  /// Subtract a universal time to this
+  ///
+  /// @param[in] rhs to subtract
+  /// @return reference to this
+  constexpr BasicUniversalTimeCore& operator-=( const BasicUniversalTimeCore& rhs );
+
+  /// Subtract a universal time
+  ///
+  /// @param[in] rhs to subtract
+  /// @return new universal time
+  constexpr BasicUniversalTimeCore operator-( const BasicUniversalTimeCore& rhs ) const { return BasicUniversalTimeCore(*this) -= rhs; }
+
+  /// Negate, e.g. -400_ns
+  ///
+  /// @return the time as far before t0 as this is after it
+  constexpr BasicUniversalTimeCore operator-() const { return BasicUniversalTimeCore() - *this; }
+
+  /// Check if this time is the same as another
+  ///
+  /// @param[in] rhs to test
+  /// @return true if they are the same
+  constexpr bool operator==( const BasicUniversalTimeCore& rhs ) const { return days == rhs.days && seconds == rhs.seconds && nanoSeconds == rhs.nanoSeconds; }
+
+  /// Check if this time is NOT the same as another
+  ///
+  /// @param[in] rhs to test
+  /// @return true if they are NOT the same
+  constexpr bool operator!=( const BasicUniversalTimeCore& rhs ) const { return !(*this == rhs ); }
+
+  /// Check if this time is less than (before) another
+  ///
+  /// @param[in] rhs to test
+  /// @return true if this is less than (before) rhs
+  constexpr bool operator<( const BasicUniversalTimeCore& rhs ) const;
+
+  /// Check if this time is less than (before) or equal to another
+  ///
+  /// @param[in] rhs to test
+  /// @return true if this is less than (before) or equal to rhs
+  constexpr bool operator<=( const BasicUniversalTimeCore& rhs ) const { return *this < rhs || *this == rhs; }
+
+  /// Check if this time is greater than (before) another
+  ///
+  /// @param[in] rhs to test
+  /// @return true if this is greater than (before) rhs
+  constexpr bool operator>( const BasicUniversalTimeCore& rhs ) const { return !(*this <= rhs); }
+
+  /// Check if this time is greater than (before) or equal to another
+  ///
+  /// @param[in] rhs to test
+  /// @return true if this is greater than (before) or equal to rhs
+  constexpr bool operator>=( const BasicUniversalTimeCore& rhs ) const { return *this > rhs || *this == rhs; }
+
+protected:
+  /// Normalises the time i.e. ensures that 0 <= nanoSeconds < 1 second and 0 <= seconds < 1 day
+  constexpr void Normalise();
+
+  /// Is the time before t0?
+  constexpr bool IsNegative() const { return days < 0; }
+
+  int32_t days; ///< Universal time i.e. relative to the world (days since SNO+ day0)
+  int32_t seconds; ///< Universal time i.e. relative to the world (secs)
+  double nanoSeconds; ///< Universal time i.e. relative to the world (nsecs)
+};
+
+template<class TArithmetic>
+constexpr
+BasicUniversalTimeCore<TArithmetic>::BasicUniversalTimeCore( const int32_t days_, const int32_t seconds_, const double nanoSeconds_ )
+  : days(days_), seconds(seconds_), nanoSeconds(nanoSeconds_)
+{
+  Normalise();
+}
+
+template<class TArithmetic>
+inline std::tm
+BasicUniversalTimeCore<TArithmetic>::GetTime( const bool snoPlus ) const
+{
+  std::tm time;
+  time.tm_sec = seconds;
+  time.tm_min = 0;
+  time.tm_hour = 0;
+  time.tm_mday = 1 + days;
+  time.tm_mon = 0;
+  if( snoPlus ) // SNO+ starts at 2010, SNO at 1996, tm_year is years since 1900
+    time.tm_year = 110;
+  else
+    time.tm_year = 96;
+  time.tm_isdst = 0;
+  mktime(&time); // Normalises i.e. deals with roll-overs etc...
+  return time;
+}
+
+template<class TArithmetic>
+constexpr BasicUniversalTimeCore<TArithmetic>&
+BasicUniversalTimeCore<TArithmetic>::operator+=( const BasicUniversalTimeCore& rhs )
+{
+  // Into a copy, so a throwing TArithmetic leaves this time as it was
+  BasicUniversalTimeCore result( *this );
+  result.nanoSeconds += rhs.nanoSeconds;
+  result.seconds += rhs.seconds;
+  result.days = TArithmetic::Days( days, rhs.days, result.seconds, result.nanoSeconds );
+  result.Normalise();
+  *this = result;
+  return *this;
+}
+
+template<class TArithmetic>
+constexpr BasicUniversalTimeCore<TArithmetic>&
+BasicUniversalTimeCore<TArithmetic>::operator-=( const BasicUniversalTimeCore& rhs )
+{
+  // Into a copy, so a throwing TArithmetic leaves this time as it was
+  BasicUniversalTimeCore result( *this );
+  result.nanoSeconds -= rhs.nanoSeconds;
+  result.seconds -= rhs.seconds;
+  result.days = TArithmetic::Days( days, -static_cast<int64_t>( rhs.days ), result.seconds, result.nanoSeconds );
+  result.Normalise();
+  *this = result;
+  return *this;
+}
+
+template<class TArithmetic>
+constexpr bool
+BasicUniversalTimeCore<TArithmetic>::operator<( const BasicUniversalTimeCore& rhs ) const
+{
+  if( days > rhs.days ) return false;
+  else if( days == rhs.days && seconds > rhs.seconds ) return false;
+  else if( days == rhs.days && seconds == rhs.seconds && nanoSeconds >= rhs.nanoSeconds ) return false;
+  return true;
+}
+
+template<class TArithmetic>
+constexpr void
+BasicUniversalTimeCore<TArithmetic>::Normalise()
+{
+  // Floor division with the remainder fixed up by comparisons rather than
+  // branches, so the cost is the same whatever the signs of the fields.
+  // The estimate is a multiply rather than a divide and can be one out
+  // either way, as can a tiny negative remainder that rounds up to 1e9.
+  int64_t carrySeconds = TArithmetic::Quotient( nanoSeconds * 1.0e-9 );
+  nanoSeconds -= static_cast<double>( carrySeconds ) * 1.0e9;
+  const bool borrowSecond = nanoSeconds < 0.0;
+  carrySeconds -= borrowSecond;
+  nanoSeconds += borrowSecond ? 1.0e9 : 0.0; // Compiles to a compare mask
+  const bool wholeSecond = nanoSeconds >= 1.0e9;
+  carrySeconds += wholeSecond;
+  nanoSeconds -= wholeSecond * 1.0e9; // GCC makes a rarely true select a branch, so multiply
+
+  const int64_t totalSeconds = static_cast<int64_t>( seconds ) + carrySeconds;
+  int64_t carryDays = totalSeconds / 86400;
+  int64_t remainder = totalSeconds % 86400;
+  const bool borrow = remainder < 0;
+  carryDays -= borrow;
+  remainder += borrow * 86400;
+  seconds = static_cast<int32_t>( remainder );
+  days = TArithmetic::Days( days, carryDays, seconds, nanoSeconds );
+}
+
+/// The time class used throughout, overflow is not checked
+typedef BasicUniversalTimeCore<UncheckedArithmetic> UniversalTimeCore;
+
+#endif
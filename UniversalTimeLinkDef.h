@@ -0,0 +1,10 @@
+#ifdef __CINT__
+
+#pragma link off all globals;
+#pragma link off all classes;
+#pragma link off all functions;
+
+#pragma link C++ class BasicUniversalTimeCore<UncheckedArithmetic>+;
+#pragma link C++ class UniversalTime+;
+
+#endif
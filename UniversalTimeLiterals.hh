@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////
+/// \namespace UniversalTimeLiterals
+///
+/// \brief  Time literals, 400_ns, 20_us, 1.5_h, 1_d
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file.
+///
+/// \details Each literal is a UniversalTimeCore duration made by the
+///         compiler. They are consteval where the compiler supports it
+///         (C++20), so a literal can never cost anything at run time or
+///         at static initialisation. Otherwise they are constexpr and
+///         fold whenever the result is used as a constant:
+///
+///           using namespace UniversalTimeLiterals;
+///           static constexpr UniversalTimeCore kTriggerWindow = 400_ns;
+///           if( hit - trigger < kTriggerWindow ) ...
+///
+///         Integer literals are exact. Floating literals are exact to
+///         the precision of long double. A literal beyond the range of
+///         the days field does not compile.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_UniversalTimeLiterals__
+#define __RAT_DS_UniversalTimeLiterals__
+
+#include <UniversalTimeCore.hh>
+
+#include <stdexcept>
+
+#if defined( __cpp_consteval )
+#define UT_CONSTEVAL consteval
+#else
+#define UT_CONSTEVAL constexpr
+#endif
+
+namespace UniversalTimeLiterals
+{
+  /// Build a time from whole seconds and a remainder
+  ///
+  /// @param[in] wholeSeconds since t0
+  /// @param[in] nanoSeconds on top
+  /// @return the time
+  UT_CONSTEVAL UniversalTimeCore FromSeconds( const unsigned long long wholeSeconds, const double nanoSeconds )
+  {
+    if( wholeSeconds / 86400 > 2147483647ull )
+      throw std::overflow_error( "UniversalTimeLiterals: time out of range" );
+    return UniversalTimeCore( static_cast<int32_t>( wholeSeconds / 86400 ), static_cast<int32_t>( wholeSeconds % 86400 ),
+                              nanoSeconds );
+  }
+
+  /// Build a time from a whole number of units
+  ///
+  /// @param[in] count of units
+  /// @param[in] unit length in seconds, 0 for units below a second
+  /// @param[in] nanoSecondsPerUnit of units below a second
+  /// @return the time
+  UT_CONSTEVAL UniversalTimeCore FromCount( const unsigned long long count, const unsigned long long unit,
+                                            const unsigned long long nanoSecondsPerUnit )
+  {
+    if( unit == 0 )
+      return FromSeconds( count / ( 1000000000ull / nanoSecondsPerUnit ),
+                          static_cast<double>( count % ( 1000000000ull / nanoSecondsPerUnit ) * nanoSecondsPerUnit ) );
+    if( count > ~0ull / unit )
+      throw std::overflow_error( "UniversalTimeLiterals: time out of range" );
+    return FromSeconds( count * unit, 0.0 );
+  }
+
+  /// Build a time from a fractional number of units
+  ///
+  /// @param[in] value in units
+  /// @param[in] nanoSecondsPerUnit unit length in ns
+  /// @return the time
+  UT_CONSTEVAL UniversalTimeCore FromValue( const long double value, const long double nanoSecondsPerUnit )
+  {
+    const long double nanoSeconds = value * nanoSecondsPerUnit;
+    if( !( nanoSeconds < 1.0e9L * 86400.0L * 2147483648.0L ) )
+      throw std::overflow_error( "UniversalTimeLiterals: time out of range" );
+    const unsigned long long wholeSeconds = static_cast<unsigned long long>( nanoSeconds / 1.0e9L );
+    return FromSeconds( wholeSeconds, static_cast<double>( nanoSeconds - static_cast<long double>( wholeSeconds ) * 1.0e9L ) );
+  }
+
+  UT_CONSTEVAL UniversalTimeCore operator"" _ns( const unsigned long long count ) { return FromCount( count, 0, 1ull ); }
+  UT_CONSTEVAL UniversalTimeCore operator"" _us( const unsigned long long count ) { return FromCount( count, 0, 1000ull ); }
+  UT_CONSTEVAL UniversalTimeCore operator"" _ms( const unsigned long long count ) { return FromCount( count, 0, 1000000ull ); }
+  UT_CONSTEVAL UniversalTimeCore operator"" _s( const unsigned long long count ) { return FromCount( count, 1ull, 0 ); }
+  UT_CONSTEVAL UniversalTimeCore operator"" _min( const unsigned long long count ) { return FromCount( count, 60ull, 0 ); }
+  UT_CONSTEVAL UniversalTimeCore operator"" _h( const unsigned long long count ) { return FromCount( count, 3600ull, 0 ); }
+  UT_CONSTEVAL UniversalTimeCore operator"" _d( const unsigned long long count ) { return FromCount( count, 86400ull, 0 ); }
+
+  UT_CONSTEVAL UniversalTimeCore operator"" _ns( const long double value ) { return FromValue( value, 1.0L ); }
+  UT_CONSTEVAL UniversalTimeCore operator"" _us( const long double value ) { return FromValue( value, 1.0e3L ); }
+  UT_CONSTEVAL UniversalTimeCore operator"" _ms( const long double value ) { return FromValue( value, 1.0e6L ); }
+  UT_CONSTEVAL UniversalTimeCore operator"" _s( const long double value ) { return FromValue( value, 1.0e9L ); }
+  UT_CONSTEVAL UniversalTimeCore operator"" _min( const long double value ) { return FromValue( value, 6.0e10L ); }
+  UT_CONSTEVAL UniversalTimeCore operator"" _h( const long double value ) { return FromValue( value, 3.6e12L ); }
+  UT_CONSTEVAL UniversalTimeCore operator"" _d( const long double value ) { return FromValue( value, 8.64e13L ); }
+}
+
+#endif
@@ -0,0 +1,216 @@
+////////////////////////////////////////////////////////////////////
+/// \class BenchHarness
+///
+/// \brief  Minimal benchmark runner for the time library benchmarks
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file with the CMake build.
+///
+/// \details Each benchmark is a name, the number of items one call
+///         processes and the call. The call is repeated until the
+///         minimum time passes, this is done for several repetitions
+///         and the fastest is kept. Results are printed as a table and,
+///         with --json=file, written one JSON object per line so runs
+///         can be compared by scripts.
+///
+///         Where the system allows, PerfCounters count the fastest
+///         repetition too, and cycles, instructions, branch and cache
+///         misses per item are printed and written with the times, so
+///         variants can be chosen per microarchitecture. Without them
+///         only times are reported.
+///
+///         Options: --filter=substring --min-time=seconds
+///                  --repetitions=n --json=file --counters=0|1
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_BenchHarness__
+#define __RAT_DS_BenchHarness__
+
+#include <PerfCounters.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+class BenchHarness
+{
+public:
+  typedef std::function<void()> Body;
+
+  /// Keep a value alive so the compiler cannot remove the work making it
+  ///
+  /// @param[in] value to keep
+  template<class T>
+  static void DoNotOptimize( const T& value )
+  {
+    asm volatile( "" : : "r,m"( value ) : "memory" );
+  }
+
+  /// Register a benchmark
+  ///
+  /// @param[in] name of the benchmark, family/variant
+  /// @param[in] items processed by one call of body
+  /// @param[in] body the work
+  void Add( const std::string& name, const size_t items, const Body& body )
+  {
+    Entry entry = { name, items, body };
+    entries.push_back( entry );
+  }
+
+  /// Parse options and run the matching benchmarks
+  ///
+  /// @param[in] argc from main
+  /// @param[in] argv from main
+  /// @return exit code
+  inline int Run( int argc, char** argv );
+
+protected:
+  struct Entry
+  {
+    std::string name;
+    size_t items;
+    Body body;
+  };
+
+  /// Time calls of an entry, return the best ns per item and, if counting, its counts per item
+  inline double Measure( const Entry& entry, const double minTime, const int repetitions, size_t& calls,
+                         PerfCounters* counters, std::vector<double>& counts ) const;
+
+  std::vector<Entry> entries; ///< Registered benchmarks
+};
+
+inline double
+BenchHarness::Measure( const Entry& entry, const double minTime, const int repetitions, size_t& calls,
+                       PerfCounters* counters, std::vector<double>& counts ) const
+{
+  typedef std::chrono::steady_clock Clock;
+  entry.body(); // Warm up caches and page in buffers
+  // Find the number of calls that takes at least the minimum time
+  calls = 1;
+  for( ;; )
+    {
+      const Clock::time_point start = Clock::now();
+      for( size_t i = 0; i < calls; i++ )
+        entry.body();
+      const double elapsed = std::chrono::duration<double>( Clock::now() - start ).count();
+      if( elapsed >= minTime || calls >= ( size_t( 1 ) << 40 ) )
+        break;
+      calls = elapsed <= 0.0 ? calls * 10 : std::max<size_t>( calls * 2, static_cast<size_t>( calls * 1.2 * minTime / elapsed ) );
+    }
+  double best = 0.0;
+  for( int repetition = 0; repetition < repetitions; repetition++ )
+    {
+      if( counters != 0 )
+        counters->Start();
+      const Clock::time_point start = Clock::now();
+      for( size_t i = 0; i < calls; i++ )
+        entry.body();
+      const double elapsed = std::chrono::duration<double>( Clock::now() - start ).count();
+      if( counters != 0 )
+        counters->Stop();
+      const double items = static_cast<double>( calls ) * entry.items;
+      const double perItem = elapsed * 1.0e9 / items;
+      if( repetition == 0 || perItem < best )
+        {
+          best = perItem;
+          counts.clear();
+          if( counters != 0 )
+            {
+              const std::vector<double> totals = counters->Read();
+              for( size_t c = 0; c < totals.size(); c++ )
+                counts.push_back( totals[c] < 0.0 ? -1.0 : totals[c] / items );
+            }
+        }
+    }
+  return best;
+}
+
+inline int
+BenchHarness::Run( int argc, char** argv )
+{
+  std::string filter;
+  std::string jsonPath;
+  double minTime = 0.2;
+  int repetitions = 3;
+  bool count = true;
+  for( int i = 1; i < argc; i++ )
+    {
+      const std::string argument = argv[i];
+      if( argument.compare( 0, 9, "--filter=" ) == 0 )
+        filter = argument.substr( 9 );
+      else if( argument.compare( 0, 11, "--min-time=" ) == 0 )
+        minTime = std::atof( argument.c_str() + 11 );
+      else if( argument.compare( 0, 14, "--repetitions=" ) == 0 )
+        repetitions = std::max( 1, std::atoi( argument.c_str() + 14 ) );
+      else if( argument.compare( 0, 7, "--json=" ) == 0 )
+        jsonPath = argument.substr( 7 );
+      else if( argument.compare( 0, 11, "--counters=" ) == 0 )
+        count = std::atoi( argument.c_str() + 11 ) != 0;
+      else
+        {
+          std::fprintf( stderr, "usage: %s [--filter=s] [--min-time=s] [--repetitions=n] [--json=file] [--counters=0|1]\n", argv[0] );
+          return 1;
+        }
+    }
+  FILE* json = 0;
+  if( !jsonPath.empty() && ( json = std::fopen( jsonPath.c_str(), "w" ) ) == 0 )
+    {
+      std::fprintf( stderr, "cannot write %s\n", jsonPath.c_str() );
+      return 1;
+    }
+  PerfCounters perfCounters;
+  PerfCounters* counters = count && perfCounters.IsAvailable() ? &perfCounters : 0;
+  const std::vector<std::string> names = counters != 0 ? counters->GetNames() : std::vector<std::string>();
+  if( count && counters == 0 )
+    std::printf( "# no performance counters, times only\n" );
+  std::printf( "%-40s %14s %14s", "benchmark", "ns/item", "Mitems/s" );
+  for( size_t c = 0; c < names.size(); c++ )
+    std::printf( " %*s", static_cast<int>( std::max<size_t>( names[c].size(), 8 ) ), names[c].c_str() );
+  std::printf( names.empty() ? "\n" : "    (counts per item)\n" );
+  for( size_t i = 0; i < entries.size(); i++ )
+    {
+      const Entry& entry = entries[i];
+      if( !filter.empty() && entry.name.find( filter ) == std::string::npos )
+        continue;
+      size_t calls = 0;
+      std::vector<double> counts;
+      const double nsPerItem = Measure( entry, minTime, repetitions, calls, counters, counts );
+      std::printf( "%-40s %14.3f %14.2f", entry.name.c_str(), nsPerItem, 1.0e3 / nsPerItem );
+      for( size_t c = 0; c < counts.size(); c++ )
+        {
+          const int width = static_cast<int>( std::max<size_t>( names[c].size(), 8 ) );
+          if( counts[c] < 0.0 )
+            std::printf( " %*s", width, "-" );
+          else
+            std::printf( " %*.3f", width, counts[c] );
+        }
+      std::printf( "\n" );
+      std::fflush( stdout );
+      if( json != 0 )
+        {
+          std::fprintf( json, "{\"name\":\"%s\",\"items\":%zu,\"calls\":%zu,\"ns_per_item\":%.6g,\"items_per_second\":%.6g",
+                        entry.name.c_str(), entry.items, calls, nsPerItem, 1.0e9 / nsPerItem );
+          // Counts per item, null for a counter the kernel never scheduled
+          std::fprintf( json, ",\"counters\":{" );
+          for( size_t c = 0; c < counts.size(); c++ )
+            {
+              if( counts[c] < 0.0 )
+                std::fprintf( json, "%s\"%s\":null", c == 0 ? "" : ",", names[c].c_str() );
+              else
+                std::fprintf( json, "%s\"%s\":%.6g", c == 0 ? "" : ",", names[c].c_str(), counts[c] );
+            }
+          std::fprintf( json, "}}\n" );
+        }
+    }
+  if( json != 0 )
+    std::fclose( json );
+  return 0;
+}
+
+#endif
@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////
+/// Throughput benchmark of EventBuilder.
+///
+/// Usage: EventBuilderBench [events] [crates]
+///
+/// Fragments for a 1 MHz trigger stream are made up front, crate
+/// clocks disagree by up to 20 ns. Prints the events/s of the builder
+/// alone (one thread pushing for every crate then processing), then
+/// with a producer thread per crate and the builder thread.
+////////////////////////////////////////////////////////////////////
+#include <EventBuilder.hh>
+#include <TimeGenerator.hh>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+int main( int argc, char** argv )
+{
+  const size_t nEvents = argc > 1 ? std::strtoul( argv[1], 0, 10 ) : 2000000;
+  const unsigned nCrates = argc > 2 ? static_cast<unsigned>( std::strtoul( argv[2], 0, 10 ) ) : 19;
+  const PackedTime tolerance = 50;
+
+  TimeGenerator generator( 2 );
+  std::vector<PackedTime> triggers( nEvents );
+  generator.Poisson( 0, 1.0e6, 200, triggers.data(), nEvents );
+  std::vector<std::vector<EventBuilder::Fragment> > fragments( nCrates );
+  for( unsigned crate = 0; crate < nCrates; crate++ )
+    {
+      fragments[crate].resize( nEvents );
+      for( size_t i = 0; i < nEvents; i++ )
+        {
+          const EventBuilder::Fragment fragment = { triggers[i] + static_cast<PackedTime>( ( crate * 7 + i * 13 ) % 41 ) - 20,
+                                                    static_cast<uint32_t>( i & EventBuilder::kGtidMask ), crate, i };
+          fragments[crate][i] = fragment;
+        }
+    }
+  std::printf( "# events %zu crates %u\n", nEvents, nCrates );
+
+  {
+    EventBuilder builder( nCrates, tolerance, 60.0 );
+    size_t built = 0;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const size_t block = 256;
+    for( size_t first = 0; first < nEvents; first += block )
+      {
+        const size_t last = std::min( nEvents, first + block );
+        for( unsigned crate = 0; crate < nCrates; crate++ )
+          for( size_t i = first; i < last; i++ )
+            builder.Push( fragments[crate][i] );
+        built += builder.Process( []( const EventBuilder::Event& ) {} );
+      }
+    built += builder.Flush( []( const EventBuilder::Event& ) {} );
+    const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    std::printf( "single thread  %zu events %.4f s %.4g events/s %.4g fragments/s\n",
+                 built, seconds, built / seconds, built * static_cast<double>( nCrates ) / seconds );
+  }
+
+  {
+    EventBuilder builder( nCrates, tolerance, 60.0 );
+    std::atomic<size_t> built( 0 );
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    builder.Start( [&built]( const EventBuilder::Event& ) { built.fetch_add( 1, std::memory_order_relaxed ); } );
+    std::vector<std::thread> producers;
+    for( unsigned crate = 0; crate < nCrates; crate++ )
+      producers.emplace_back( [&builder, &fragments, crate, nEvents]()
+                              {
+                                for( size_t i = 0; i < nEvents; )
+                                  if( builder.Push( fragments[crate][i] ) )
+                                    i++;
+                                  else
+                                    std::this_thread::yield();
+                              } );
+    for( size_t i = 0; i < producers.size(); i++ )
+      producers[i].join();
+    builder.Stop();
+    const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    std::printf( "%u producers   %zu events %.4f s %.4g events/s late %llu\n", nCrates, built.load(), seconds,
+                 built.load() / seconds, static_cast<unsigned long long>( builder.GetLate() ) );
+  }
+  return 0;
+}
@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////
+/// \class PerfCounters
+///
+/// \brief  Hardware performance counters of the calling thread, for the benchmarks
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file, counters per benchmark in BenchHarness.
+///
+/// \details Opens cycles, instructions, branches, branch misses, L1
+///         data read misses and cache misses, the last level cache on
+///         most CPUs, user space only, with perf_event_open, plus page
+///         faults, a software event. Each counter is opened on its own,
+///         so any the CPU, the VM or perf_event_paranoid does not allow
+///         is left out and the rest still count. Without cycles and
+///         instructions, as in most VMs, the software page faults alone
+///         say little, so IsAvailable is false and the harness reports
+///         times.
+///
+///         Counters inherit to threads started while counting, and are
+///         scaled by enabled over running time if the kernel had to
+///         multiplex them.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_PerfCounters__
+#define __RAT_DS_PerfCounters__
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class PerfCounters
+{
+public:
+  /// Open every counter the system allows
+  inline PerfCounters();
+
+  /// Close the counters
+  ~PerfCounters()
+  {
+    for( size_t c = 0; c < counters.size(); c++ )
+      close( counters[c].fd );
+  }
+
+  PerfCounters( const PerfCounters& ) = delete;
+  PerfCounters& operator=( const PerfCounters& ) = delete;
+
+  /// Get whether the hardware counters opened
+  ///
+  /// @return true if cycles or instructions count
+  bool IsAvailable() const
+  {
+    for( size_t c = 0; c < counters.size(); c++ )
+      if( counters[c].name == "cycles" || counters[c].name == "instructions" )
+        return true;
+    return false;
+  }
+
+  /// Get the names of the open counters, in Read order
+  ///
+  /// @return names as perf stat prints them
+  std::vector<std::string> GetNames() const
+  {
+    std::vector<std::string> names;
+    for( size_t c = 0; c < counters.size(); c++ )
+      names.push_back( counters[c].name );
+    return names;
+  }
+
+  /// Zero and start every counter
+  void Start()
+  {
+    for( size_t c = 0; c < counters.size(); c++ )
+      ioctl( counters[c].fd, PERF_EVENT_IOC_RESET, 0 );
+    for( size_t c = 0; c < counters.size(); c++ )
+      ioctl( counters[c].fd, PERF_EVENT_IOC_ENABLE, 0 );
+  }
+
+  /// Stop every counter
+  void Stop()
+  {
+    for( size_t c = 0; c < counters.size(); c++ )
+      ioctl( counters[c].fd, PERF_EVENT_IOC_DISABLE, 0 );
+  }
+
+  /// Read the counts since Start
+  ///
+  /// @return one count per name, scaled for multiplexing, -1 if never scheduled
+  std::vector<double> Read() const
+  {
+    std::vector<double> values;
+    for( size_t c = 0; c < counters.size(); c++ )
+      {
+        uint64_t data[3] = { 0, 0, 0 }; // Value, time enabled, time running
+        if( read( counters[c].fd, data, sizeof( data ) ) != static_cast<ssize_t>( sizeof( data ) ) || data[2] == 0 )
+          values.push_back( -1.0 );
+        else
+          values.push_back( static_cast<double>( data[0] ) * static_cast<double>( data[1] ) / static_cast<double>( data[2] ) );
+      }
+    return values;
+  }
+
+protected:
+  struct Counter
+  {
+    std::string name;
+    int fd;
+  };
+
+  /// Open one counter, leave it out if the system refuses
+  void Open( const char* name, const uint32_t type, const uint64_t config )
+  {
+    perf_event_attr attributes;
+    std::memset( &attributes, 0, sizeof( attributes ) );
+    attributes.size = sizeof( attributes );
+    attributes.type = type;
+    attributes.config = config;
+    attributes.disabled = 1;
+    attributes.inherit = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    const int fd = static_cast<int>( syscall( __NR_perf_event_open, &attributes, 0, -1, -1, 0 ) );
+    if( fd >= 0 )
+      {
+        const Counter counter = { name, fd };
+        counters.push_back( counter );
+      }
+  }
+
+  std::vector<Counter> counters; ///< Open counters
+};
+
+inline
+PerfCounters::PerfCounters()
+{
+  const uint64_t l1dReadMiss = PERF_COUNT_HW_CACHE_L1D | ( PERF_COUNT_HW_CACHE_OP_READ << 8 )
+    | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 );
+  Open( "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES );
+  Open( "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS );
+  Open( "branches", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS );
+  Open( "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES );
+  Open( "L1-dcache-load-misses", PERF_TYPE_HW_CACHE, l1dReadMiss );
+  Open( "cache-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES );
+  Open( "page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS );
+}
+
+#endif
@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////
+/// Scaling benchmark of the PeriodicitySearch Rayleigh and
+/// Lomb-Scargle paths.
+///
+/// Usage: PeriodicityBench [events] [frequencies]
+///
+/// Prints one line per thread count with the Rayleigh rate in
+/// event x frequency evaluations per second, then the fast
+/// Lomb-Scargle time for the same events.
+////////////////////////////////////////////////////////////////////
+#include <PeriodicitySearch.hh>
+#include <TimeGenerator.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+int main( int argc, char** argv )
+{
+  const size_t nEvents = argc > 1 ? std::strtoul( argv[1], 0, 10 ) : 1000000;
+  const size_t nFrequencies = argc > 2 ? std::strtoul( argv[2], 0, 10 ) : 1024;
+  const PackedTime year = 365 * PackedTimes::kNanoSecondsPerDay;
+
+  TimeGenerator generator( 1 );
+  std::vector<PackedTime> times( nEvents );
+  generator.Uniform( 10 * year, 11 * year, times.data(), times.size() );
+  std::vector<double> frequencies( nFrequencies );
+  for( size_t f = 0; f < nFrequencies; f++ )
+    frequencies[f] = 1.0e-7 * ( f + 1 );
+  std::vector<double> powers( nFrequencies );
+
+  const unsigned maxThreads = std::max( 1u, std::thread::hardware_concurrency() );
+  std::printf( "# events %zu frequencies %zu\n", nEvents, nFrequencies );
+  std::printf( "# threads seconds evaluations/s\n" );
+  for( unsigned threads = 1; threads <= maxThreads; threads *= 2 )
+    {
+      PeriodicitySearch search( 10 * year, threads );
+      search.SetTimes( times.data(), times.size() );
+      const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      search.Rayleigh( frequencies.data(), frequencies.size(), powers.data() );
+      const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+      std::printf( "%u %.4f %.4g\n", threads, seconds, nEvents * static_cast<double>( nFrequencies ) / seconds );
+    }
+
+  std::vector<double> values( nEvents );
+  for( size_t i = 0; i < nEvents; i++ )
+    values[i] = static_cast<double>( i % 7 );
+  PeriodicitySearch search( 10 * year );
+  search.SetTimes( times.data(), times.size() );
+  std::vector<double> lsFrequencies, lsPowers;
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  search.LombScargle( values.data(), 4.0, nFrequencies, lsFrequencies, lsPowers );
+  const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+  std::printf( "# Lomb-Scargle %zu frequencies %.4f s\n", nFrequencies, seconds );
+  return 0;
+}
@@ -0,0 +1,280 @@
+////////////////////////////////////////////////////////////////////
+/// End to end benchmark of a synthetic run through the time pipeline.
+///
+/// Usage: PipelineBench [run seconds] [trigger rate Hz] [seed]
+///
+/// A run is made up front from the seed alone: Poisson triggers with
+/// dead time plus bursts, a fragment per crate per trigger, and the
+/// quirks of real crate clocks, fixed offsets and jitter, fields that
+/// are not normalised (days, seconds and ns of either sign as in
+/// main.C), fragments read out a little out of order and now and then
+/// a time a second off. Each crate's fragments are packed as raw
+/// records in 10 ms blocks.
+///
+/// The blocks then go through the stages in turn, one block at a time:
+/// decode the records, convert the fields to packed times, sort each
+/// crate's block, reorder and build events across crates with the
+/// EventBuilder, find coincidences between events with the
+/// EventClusterer, and fill the inter-arrival histogram. Prints the
+/// throughput of each stage, the percentiles of its time per block
+/// and the peak RSS.
+////////////////////////////////////////////////////////////////////
+#include <EventBuilder.hh>
+#include <EventClusterer.hh>
+#include <InterArrivalStats.hh>
+#include <KllSketch.hh>
+#include <PackedTime.hh>
+#include <TimeGenerator.hh>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  const unsigned kCrates = 19; ///< Crates in the detector
+  const PackedTime kBlock = 10000000; ///< Run time per block (ns)
+  const PackedTime kTolerance = 50; ///< Largest crate clock disagreement (ns)
+  const PackedTime kMaxGap = 1000; ///< Largest gap between coincident events (ns)
+
+  /// A fragment as a crate reads it out
+  struct RawRecord
+  {
+    int32_t days;
+    int32_t seconds;
+    double nanoSeconds;
+    uint32_t gtid;
+    uint32_t spare;
+  };
+
+  /// Header of a crate's records in a block
+  struct BlockHeader
+  {
+    uint32_t crate;
+    uint32_t count;
+  };
+
+  enum Stage { kDecode, kConvert, kSort, kBuild, kCoincidence, kHistogram, kStages };
+  const char* const kStageNames[kStages] = { "decode", "convert", "sort", "build", "coincidence", "histogram" };
+
+  /// Fields of a time with quirks added, packing them gives the time back
+  RawRecord Encode( const PackedTime time, const uint32_t gtid, const uint64_t i )
+  {
+    RawRecord record;
+    PackedTimes::Unpack( time, record.days, record.seconds, record.nanoSeconds );
+    if( i % 5 == 1 )
+      {
+        record.days -= 1;
+        record.seconds += 86400;
+      }
+    if( i % 7 == 2 )
+      {
+        record.seconds += 1;
+        record.nanoSeconds -= 1.0e9;
+      }
+    if( i % 11 == 3 )
+      {
+        record.days += 2;
+        record.seconds -= 2 * 86400 + 1;
+        record.nanoSeconds += 1.0e9;
+      }
+    record.gtid = gtid;
+    record.spare = 0;
+    return record;
+  }
+
+  /// Make the run as the stream of blocks a reader would get
+  ///
+  /// @return triggers made
+  size_t MakeRun( const double seconds, const double rate, const uint64_t seed, std::vector<char>& stream,
+                  std::vector<size_t>& blockOffsets )
+  {
+    TimeGenerator generator( seed );
+    std::vector<PackedTime> triggers( static_cast<size_t>( seconds * rate ) );
+    generator.Poisson( 0, rate, 200, triggers.data(), triggers.size() );
+    // A burst of 2000 triggers 500 ns apart every 5 s on average
+    generator.InjectBursts( triggers, 0.2, 2000, 500 );
+
+    std::vector<PackedTime> jitter( triggers.size() * kCrates );
+    generator.Uniform( -2, 3, jitter.data(), jitter.size() );
+    std::vector<std::vector<RawRecord> > crates( kCrates );
+    size_t next = 0;
+    for( PackedTime blockStart = 0; next < triggers.size(); blockStart += kBlock )
+      {
+        blockOffsets.push_back( stream.size() );
+        const size_t first = next;
+        while( next < triggers.size() && triggers[next] < blockStart + kBlock )
+          next++;
+        for( unsigned crate = 0; crate < kCrates; crate++ )
+          {
+            std::vector<RawRecord>& records = crates[crate];
+            records.clear();
+            for( size_t t = first; t < next; t++ )
+              {
+                const uint64_t i = t * kCrates + crate;
+                PackedTime time = triggers[t] + static_cast<PackedTime>( crate * 7 % 41 ) - 20 + jitter[i];
+                if( i % 100003 == 17 )
+                  time += PackedTimes::kNanoSecondsPerSecond; // Clock glitch
+                records.push_back( Encode( time, static_cast<uint32_t>( t & EventBuilder::kGtidMask ), i ) );
+              }
+            // Read out a little out of order
+            for( size_t r = 1; r < records.size(); r += 97 )
+              std::swap( records[r - 1], records[r] );
+            const BlockHeader header = { crate, static_cast<uint32_t>( records.size() ) };
+            const size_t offset = stream.size();
+            stream.resize( offset + sizeof( header ) + records.size() * sizeof( RawRecord ) );
+            std::memcpy( &stream[offset], &header, sizeof( header ) );
+            if( !records.empty() )
+              std::memcpy( &stream[offset + sizeof( header )], records.data(), records.size() * sizeof( RawRecord ) );
+          }
+      }
+    blockOffsets.push_back( stream.size() );
+    return triggers.size();
+  }
+
+  /// Time spent per stage and its spread over blocks
+  struct StageClock
+  {
+    StageClock() : items(0), nanoSeconds(0), perBlock(200, 1) { }
+    uint64_t items;
+    int64_t nanoSeconds;
+    KllSketch perBlock;
+  };
+}
+
+int main( int argc, char** argv )
+{
+  const double seconds = argc > 1 ? std::strtod( argv[1], 0 ) : 5.0;
+  const double rate = argc > 2 ? std::strtod( argv[2], 0 ) : 20000.0;
+  const uint64_t seed = argc > 3 ? std::strtoull( argv[3], 0, 10 ) : 1;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::vector<char> stream;
+  std::vector<size_t> blockOffsets;
+  const size_t nTriggers = MakeRun( seconds, rate, seed, stream, blockOffsets );
+  const double generation = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+  const size_t nFragments = ( stream.size() - ( blockOffsets.size() - 1 ) * kCrates * sizeof( BlockHeader ) )
+    / sizeof( RawRecord );
+  std::printf( "# run %g s rate %g Hz seed %llu: %zu triggers, %zu fragments in %zu blocks, made in %.2f s\n", seconds,
+               rate, static_cast<unsigned long long>( seed ), nTriggers, nFragments, blockOffsets.size() - 1, generation );
+
+  EventBuilder builder( kCrates, kTolerance, 1.0e9, 1 << 16 );
+  const EventClusterer clusterer( kMaxGap, 1 );
+  InterArrivalStats gaps;
+  StageClock clocks[kStages];
+  KllSketch total( 200, 1 );
+  std::vector<std::vector<RawRecord> > records( kCrates );
+  std::vector<std::vector<PackedTime> > times( kCrates );
+  std::vector<std::vector<std::pair<PackedTime, uint32_t> > > order( kCrates );
+  std::vector<PackedTime> eventTimes;
+  std::vector<EventClusterer::Range> clusters;
+  uint64_t coincidences = 0;
+  const auto collect = [&eventTimes]( const EventBuilder::Event& event ) { eventTimes.push_back( event.time ); };
+
+  for( size_t block = 0; block + 1 < blockOffsets.size(); block++ )
+    {
+      const bool last = block + 2 == blockOffsets.size();
+      std::chrono::steady_clock::time_point mark = std::chrono::steady_clock::now();
+      const std::chrono::steady_clock::time_point blockStart = mark;
+      size_t fragments = 0;
+      const auto lap = [&]( const Stage stage, const size_t items )
+        {
+          const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+          const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>( now - mark ).count();
+          clocks[stage].items += items;
+          clocks[stage].nanoSeconds += ns;
+          clocks[stage].perBlock.Fill( ns );
+          mark = now;
+        };
+
+      // Decode the raw records of each crate
+      const char* in = &stream[blockOffsets[block]];
+      for( unsigned c = 0; c < kCrates; c++ )
+        {
+          BlockHeader header;
+          std::memcpy( &header, in, sizeof( header ) );
+          in += sizeof( header );
+          records[header.crate].resize( header.count );
+          if( header.count > 0 )
+            std::memcpy( records[header.crate].data(), in, header.count * sizeof( RawRecord ) );
+          in += header.count * sizeof( RawRecord );
+          fragments += header.count;
+        }
+      lap( kDecode, fragments );
+
+      // Fields to packed times, normalising on the way
+      for( unsigned c = 0; c < kCrates; c++ )
+        {
+          times[c].resize( records[c].size() );
+          for( size_t r = 0; r < records[c].size(); r++ )
+            times[c][r] = PackedTimes::Pack( records[c][r].days, records[c][r].seconds, records[c][r].nanoSeconds );
+        }
+      lap( kConvert, fragments );
+
+      // Each crate's block into time order
+      for( unsigned c = 0; c < kCrates; c++ )
+        {
+          order[c].resize( times[c].size() );
+          for( size_t r = 0; r < times[c].size(); r++ )
+            order[c][r] = std::make_pair( times[c][r], static_cast<uint32_t>( r ) );
+          std::sort( order[c].begin(), order[c].end() );
+        }
+      lap( kSort, fragments );
+
+      // Across crates into events in time order
+      const size_t carried = eventTimes.size();
+      for( unsigned c = 0; c < kCrates; c++ )
+        for( size_t r = 0; r < order[c].size(); r++ )
+          {
+            const EventBuilder::Fragment fragment = { order[c][r].first, records[c][order[c][r].second].gtid, c, r };
+            while( !builder.Push( fragment ) )
+              builder.Process( collect );
+          }
+      builder.Process( collect );
+      if( last )
+        builder.Flush( collect );
+      lap( kBuild, fragments );
+
+      // Coincidences, the last cluster waits for the next block unless this is the end
+      const size_t built = eventTimes.size() - carried;
+      clusterer.Cluster( eventTimes.data(), eventTimes.size(), clusters );
+      const size_t closed = last || clusters.empty() ? clusters.size() : clusters.size() - 1;
+      for( size_t i = 0; i < closed; i++ )
+        coincidences += clusters[i].second - clusters[i].first > 1;
+      lap( kCoincidence, built );
+
+      const size_t keep = closed < clusters.size() ? clusters[closed].first : eventTimes.size();
+      gaps.Fill( eventTimes.data(), keep );
+      eventTimes.erase( eventTimes.begin(), eventTimes.begin() + keep );
+      lap( kHistogram, keep );
+      total.Fill( std::chrono::duration_cast<std::chrono::nanoseconds>( mark - blockStart ).count() );
+    }
+
+  std::printf( "%-12s %10s %10s %9s %9s %9s\n", "stage", "items", "Mitems/s", "p50 us", "p90 us", "p99 us" );
+  int64_t pipeline = 0;
+  for( int s = 0; s < kStages; s++ )
+    {
+      const StageClock& clock = clocks[s];
+      pipeline += clock.nanoSeconds;
+      std::printf( "%-12s %10llu %10.2f %9.1f %9.1f %9.1f\n", kStageNames[s], static_cast<unsigned long long>( clock.items ),
+                   clock.nanoSeconds > 0 ? 1.0e3 * clock.items / clock.nanoSeconds : 0.0,
+                   clock.perBlock.GetQuantile( 0.5 ) * 1.0e-3, clock.perBlock.GetQuantile( 0.9 ) * 1.0e-3,
+                   clock.perBlock.GetQuantile( 0.99 ) * 1.0e-3 );
+    }
+  std::printf( "%-12s %10zu %10.2f %9.1f %9.1f %9.1f\n", "total", nFragments, 1.0e3 * nFragments / pipeline,
+               total.GetQuantile( 0.5 ) * 1.0e-3, total.GetQuantile( 0.9 ) * 1.0e-3, total.GetQuantile( 0.99 ) * 1.0e-3 );
+  std::printf( "# %.3g x real time, events %llu built %llu partial %llu late, %llu coincidences, mean gap %.0f ns\n",
+               seconds * 1.0e9 / pipeline, static_cast<unsigned long long>( builder.GetBuilt() ),
+               static_cast<unsigned long long>( builder.GetPartial() ), static_cast<unsigned long long>( builder.GetLate() ),
+               static_cast<unsigned long long>( coincidences ), gaps.GetMean() );
+  rusage usage;
+  getrusage( RUSAGE_SELF, &usage );
+  std::printf( "# peak RSS %.1f MB, input %.1f MB\n", usage.ru_maxrss / 1024.0, stream.size() / 1048576.0 );
+  return 0;
+}
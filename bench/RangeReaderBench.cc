@@ -0,0 +1,167 @@
+////////////////////////////////////////////////////////////////////
+/// Throughput of reading time windows out of a sorted event file.
+///
+/// Usage: RangeReaderBench [file MB] [queue depth] [decoders] [path]
+///
+/// Writes a file of 32 byte events 1 us apart, then reads a thousand
+/// windows covering about half of it, one block at a time with pread
+/// on one thread as the reprocessing jobs did, and with TimeRangeReader
+/// through io_uring and a pread pool, buffered and with O_DIRECT. The
+/// page cache is dropped for the file before every buffered pass.
+/// Prints MB/s fetched and events/s visited.
+////////////////////////////////////////////////////////////////////
+#include <TimeGenerator.hh>
+#include <TimeRangeReader.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+  struct Event
+  {
+    PackedTime time;
+    uint64_t id;
+    double charge;
+    uint64_t flags;
+  };
+
+  const size_t kBlockRecords = 16384; ///< 512 kB blocks
+  const size_t kWindows = 1000;
+
+  typedef TimeRangeReader<Event>::Window Window;
+
+  void DropCache( const std::string& path )
+  {
+    const int fd = open( path.c_str(), O_RDONLY );
+    if( fd < 0 )
+      return;
+    fdatasync( fd );
+    posix_fadvise( fd, 0, 0, POSIX_FADV_DONTNEED );
+    close( fd );
+  }
+
+  void Print( const char* name, const double seconds, const uint64_t bytes, const uint64_t events )
+  {
+    std::printf( "%-15s %8.1f MB/s %10.4g events/s\n", name, bytes / seconds / 1e6, events / seconds );
+  }
+
+  /// Every block the windows touch, in order, on this thread
+  void Synchronous( const std::string& path, const std::vector<Window>& windows )
+  {
+    DropCache( path );
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const int fd = open( path.c_str(), O_RDONLY );
+    std::vector<Event> block( kBlockRecords );
+    uint64_t bytes = 0, events = 0, sum = 0;
+    for( off_t offset = 0;; offset += kBlockRecords * sizeof( Event ) )
+      {
+        const ssize_t got = pread( fd, block.data(), kBlockRecords * sizeof( Event ), offset );
+        if( got <= 0 )
+          break;
+        const size_t count = static_cast<size_t>( got ) / sizeof( Event );
+        // Skip blocks no window touches, as the index would
+        std::vector<Window>::const_iterator window =
+          std::upper_bound( windows.begin(), windows.end(), block[0].time,
+                            []( const PackedTime time, const Window& rhs ) { return time < rhs.second; } );
+        if( window == windows.end() || window->first > block[count - 1].time )
+          continue;
+        bytes += got;
+        for( size_t i = 0; i < count; i++ )
+          {
+            while( window != windows.end() && window->second <= block[i].time )
+              ++window;
+            if( window != windows.end() && block[i].time >= window->first )
+              {
+                sum += block[i].id;
+                events++;
+              }
+          }
+      }
+    close( fd );
+    Print( "pread, 1 thread", std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count(), bytes,
+           events + ( sum == 1 ) );
+  }
+
+  void Reader( const char* name, const std::string& path, const std::vector<Window>& windows, const unsigned queueDepth,
+               const unsigned decoders, const TimeRangeReader<Event>::Engine engine, const bool direct )
+  {
+    DropCache( path );
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    TimeRangeReader<Event> reader( std::vector<std::string>( 1, path ), kBlockRecords, queueDepth, decoders, engine, direct );
+    std::atomic<uint64_t> sum( 0 );
+    const uint64_t events = reader.Read( windows, [&sum]( const Event* run, const size_t count )
+                                         {
+                                           uint64_t local = 0;
+                                           for( size_t i = 0; i < count; i++ )
+                                             local += run[i].id;
+                                           sum += local;
+                                         } );
+    Print( name, std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count(), reader.GetBytesRead(),
+           events + ( sum == 1 ) );
+  }
+}
+
+int main( int argc, char** argv )
+{
+  const size_t megabytes = argc > 1 ? std::strtoul( argv[1], 0, 10 ) : 1024;
+  const unsigned queueDepth = argc > 2 ? static_cast<unsigned>( std::strtoul( argv[2], 0, 10 ) ) : 32;
+  const unsigned decoders = argc > 3 ? static_cast<unsigned>( std::strtoul( argv[3], 0, 10 ) ) : 0;
+  const std::string path = argc > 4 ? argv[4] : "RangeReaderBench.dat";
+
+  const size_t nEvents = megabytes * 1000000 / sizeof( Event );
+  {
+    FILE* file = std::fopen( path.c_str(), "wb" );
+    if( file == 0 )
+      {
+        std::perror( path.c_str() );
+        return 1;
+      }
+    std::vector<Event> chunk( kBlockRecords );
+    for( size_t i = 0; i < nEvents; i += chunk.size() )
+      {
+        const size_t count = std::min( chunk.size(), nEvents - i );
+        for( size_t j = 0; j < count; j++ )
+          {
+            const Event event = { static_cast<PackedTime>( i + j ) * 1000, i + j, 1.0, 0 };
+            chunk[j] = event;
+          }
+        std::fwrite( chunk.data(), sizeof( Event ), count, file );
+      }
+    std::fclose( file );
+  }
+  // Windows of half the file's span in total, at random
+  const PackedTime span = static_cast<PackedTime>( nEvents ) * 1000;
+  const PackedTime width = span / ( 2 * kWindows );
+  std::vector<PackedTime> starts( kWindows );
+  TimeGenerator generator( 3 );
+  generator.Uniform( 0, span - width, starts.data(), starts.size() );
+  std::vector<Window> windows;
+  for( size_t w = 0; w < kWindows; w++ )
+    windows.push_back( Window( starts[w], starts[w] + width ) );
+  std::sort( windows.begin(), windows.end() );
+  std::printf( "# %zu MB, %zu windows, queue depth %u, decoders %u\n", megabytes, kWindows, queueDepth,
+               decoders == 0 ? TimeParallel::DefaultThreads() : decoders );
+
+  Synchronous( path, windows );
+  Reader( "pread pool", path, windows, queueDepth, decoders, TimeRangeReader<Event>::kPread, false );
+  Reader( "pread direct", path, windows, queueDepth, decoders, TimeRangeReader<Event>::kPread, true );
+  try
+    {
+      Reader( "io_uring", path, windows, queueDepth, decoders, TimeRangeReader<Event>::kIoUring, false );
+      Reader( "io_uring direct", path, windows, queueDepth, decoders, TimeRangeReader<Event>::kIoUring, true );
+    }
+  catch( const std::runtime_error& error )
+    {
+      std::printf( "%s\n", error.what() );
+    }
+  std::remove( path.c_str() );
+  return 0;
+}
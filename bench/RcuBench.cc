@@ -0,0 +1,143 @@
+////////////////////////////////////////////////////////////////////
+/// Reader throughput of a time-keyed table under frequent updates.
+///
+/// Usage: RcuBench [readers] [update period us] [seconds]
+///
+/// Readers look up random times in a table of 10k runs while a writer
+/// publishes a new table every period. Prints lookups/s with the table
+/// behind a mutex, as before, and behind an RcuPointer.
+////////////////////////////////////////////////////////////////////
+#include <QsbrDomain.hh>
+#include <RcuPointer.hh>
+#include <TimeGenerator.hh>
+#include <TimeIntervalTable.hh>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  const size_t kRuns = 10000; ///< Intervals per table
+  const PackedTime kRunLength = 3600000000000ll; ///< One hour runs
+  const size_t kQuiescentEvery = 256; ///< Lookups per quiescent state
+
+  typedef TimeIntervalTable<uint32_t> RunTable;
+
+  /// Runs numbered from first, back to back with a gap before each
+  std::unique_ptr<const RunTable> MakeTable( const uint32_t first )
+  {
+    std::vector<RunTable::Interval> intervals( kRuns );
+    for( size_t i = 0; i < kRuns; i++ )
+      {
+        intervals[i].begin = static_cast<PackedTime>( i ) * kRunLength + 1000000000;
+        intervals[i].end = static_cast<PackedTime>( i + 1 ) * kRunLength;
+        intervals[i].value = first + static_cast<uint32_t>( i );
+      }
+    return std::unique_ptr<const RunTable>( new RunTable( intervals ) );
+  }
+
+  /// Run readers and a writer for a while
+  ///
+  /// @param[in] lookup of a time by reader r, returns the run or 0
+  /// @param[in] publish a new table
+  /// @param[in] quiescent called by reader r between batches
+  /// @return lookups/s over all readers, and the publishes made
+  template<class TLookup, class TPublish, class TQuiescent>
+  std::pair<double, size_t> Run( const unsigned nReaders, const double period, const double seconds,
+                                 const std::vector<PackedTime>& times, TLookup lookup, TPublish publish,
+                                 TQuiescent quiescent )
+  {
+    std::atomic<bool> done( false );
+    std::atomic<size_t> lookups( 0 );
+    std::vector<std::thread> readers;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for( unsigned r = 0; r < nReaders; r++ )
+      readers.emplace_back( [&, r]()
+                            {
+                              size_t count = 0;
+                              uint64_t sum = 0;
+                              while( !done.load( std::memory_order_relaxed ) )
+                                {
+                                  for( size_t i = 0; i < kQuiescentEvery; i++ )
+                                    sum += lookup( r, times[( count + i ) % times.size()] );
+                                  count += kQuiescentEvery;
+                                  quiescent( r );
+                                }
+                              lookups += count + ( sum == 42 );
+                            } );
+    size_t publishes = 0;
+    std::chrono::steady_clock::time_point next = start;
+    while( std::chrono::steady_clock::now() - start < std::chrono::duration<double>( seconds ) )
+      {
+        next += std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double>( period ) );
+        std::this_thread::sleep_until( next );
+        publish( static_cast<uint32_t>( ++publishes ) );
+      }
+    done.store( true );
+    for( size_t r = 0; r < readers.size(); r++ )
+      readers[r].join();
+    const double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    return std::make_pair( lookups.load() / elapsed, publishes );
+  }
+}
+
+int main( int argc, char** argv )
+{
+  const unsigned nReaders = argc > 1 ? static_cast<unsigned>( std::strtoul( argv[1], 0, 10 ) ) : 4;
+  const double period = ( argc > 2 ? std::strtod( argv[2], 0 ) : 1000.0 ) * 1.0e-6;
+  const double seconds = argc > 3 ? std::strtod( argv[3], 0 ) : 2.0;
+
+  TimeGenerator generator( 3 );
+  std::vector<PackedTime> times( 1 << 16 );
+  generator.Uniform( 0, static_cast<PackedTime>( kRuns ) * kRunLength, times.data(), times.size() );
+  std::printf( "# readers %u update period %g us runs %zu\n", nReaders, period * 1.0e6, kRuns );
+
+  {
+    std::mutex mutex;
+    std::unique_ptr<const RunTable> table( MakeTable( 0 ) );
+    const std::pair<double, size_t> result =
+      Run( nReaders, period, seconds, times,
+           [&]( const unsigned, const PackedTime time ) -> uint32_t
+           {
+             std::lock_guard<std::mutex> lock( mutex );
+             const uint32_t* run = table->Find( time );
+             return run == 0 ? 0 : *run;
+           },
+           [&]( const uint32_t first )
+           {
+             std::unique_ptr<const RunTable> next( MakeTable( first ) );
+             std::lock_guard<std::mutex> lock( mutex );
+             table.swap( next );
+           },
+           []( const unsigned ) {} );
+    std::printf( "mutex   %.4g lookups/s %zu publishes\n", result.first, result.second );
+  }
+
+  {
+    QsbrDomain domain;
+    RcuPointer<RunTable> table( domain, MakeTable( 0 ) );
+    std::vector<size_t> slots( nReaders );
+    for( unsigned r = 0; r < nReaders; r++ )
+      slots[r] = domain.RegisterReader();
+    const std::pair<double, size_t> result =
+      Run( nReaders, period, seconds, times,
+           [&]( const unsigned, const PackedTime time ) -> uint32_t
+           {
+             const uint32_t* run = table.Get()->Find( time );
+             return run == 0 ? 0 : *run;
+           },
+           [&]( const uint32_t first ) { table.Publish( MakeTable( first ) ); },
+           [&]( const unsigned r ) { domain.Quiescent( slots[r] ); } );
+    for( unsigned r = 0; r < nReaders; r++ )
+      domain.UnregisterReader( slots[r] );
+    std::printf( "rcu     %.4g lookups/s %zu publishes %zu retired\n", result.first, result.second,
+                 table.GetRetiredCount() );
+  }
+  return 0;
+}
@@ -0,0 +1,161 @@
+////////////////////////////////////////////////////////////////////
+/// Insert and scan throughput of an index of recent events.
+///
+/// Usage: SkipListBench [writers] [readers] [seconds]
+///
+/// Writers insert events 100 ns apart, each evicting those more than
+/// 10 ms behind the latest every 1024 inserts, while readers scan the
+/// last 100 us, about 1000 events. Prints inserts/s and scans/s with a
+/// multiset behind a reader/writer lock, as before, and a TimeSkipList.
+////////////////////////////////////////////////////////////////////
+#include <QsbrDomain.hh>
+#include <TimeSkipList.hh>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  const PackedTime kSpacing = 100; ///< Between events (ns)
+  const PackedTime kMaxAge = 10000000; ///< Kept behind the latest
+  const PackedTime kWindow = 100000; ///< Scanned behind the latest
+  const size_t kEvictEvery = 1024; ///< Inserts per eviction
+  const size_t kQuiescentEvery = 64; ///< Inserts or scans per quiescent state
+
+  struct Result
+  {
+    double inserts; ///< Per second over all writers
+    double scans; ///< Per second over all readers
+    double events; ///< Events visited per scan
+  };
+
+  /// Run writers and readers for a while
+  ///
+  /// @param[in] insert by writer w, evict by writer w, scan by reader r returning events visited
+  /// @param[in] quiescent called by thread t between batches, writers first
+  template<class TInsert, class TEvict, class TScan, class TQuiescent>
+  Result Run( const unsigned nWriters, const unsigned nReaders, const double seconds, TInsert insert, TEvict evict,
+              TScan scan, TQuiescent quiescent )
+  {
+    std::atomic<bool> done( false );
+    std::atomic<size_t> inserts( 0 ), scans( 0 ), events( 0 );
+    std::vector<std::thread> threads;
+    for( unsigned w = 0; w < nWriters; w++ )
+      threads.emplace_back( [&, w]()
+                            {
+                              size_t count = 0;
+                              while( !done.load( std::memory_order_relaxed ) )
+                                {
+                                  for( size_t i = 0; i < kQuiescentEvery; i++, count++ )
+                                    {
+                                      insert( w, static_cast<PackedTime>( count * nWriters + w ) * kSpacing );
+                                      if( count % kEvictEvery == 0 )
+                                        evict( w );
+                                    }
+                                  quiescent( w );
+                                }
+                              inserts += count;
+                            } );
+    for( unsigned r = 0; r < nReaders; r++ )
+      threads.emplace_back( [&, r]()
+                            {
+                              size_t count = 0, visited = 0;
+                              while( !done.load( std::memory_order_relaxed ) )
+                                {
+                                  for( size_t i = 0; i < kQuiescentEvery; i++, count++ )
+                                    visited += scan( r );
+                                  quiescent( nWriters + r );
+                                }
+                              scans += count;
+                              events += visited;
+                            } );
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for( std::chrono::duration<double>( seconds ) );
+    done.store( true );
+    for( size_t t = 0; t < threads.size(); t++ )
+      threads[t].join();
+    const double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    const Result result = { inserts.load() / elapsed, scans.load() / elapsed,
+                            scans.load() == 0 ? 0.0 : static_cast<double>( events.load() ) / scans.load() };
+    return result;
+  }
+
+  void Print( const char* name, const Result& result )
+  {
+    std::printf( "%-9s %.4g inserts/s %.4g scans/s %.0f events/scan\n", name, result.inserts, result.scans, result.events );
+  }
+}
+
+int main( int argc, char** argv )
+{
+  const unsigned nWriters = argc > 1 ? static_cast<unsigned>( std::strtoul( argv[1], 0, 10 ) ) : 2;
+  const unsigned nReaders = argc > 2 ? static_cast<unsigned>( std::strtoul( argv[2], 0, 10 ) ) : 2;
+  const double seconds = argc > 3 ? std::strtod( argv[3], 0 ) : 2.0;
+  std::printf( "# writers %u readers %u\n", nWriters, nReaders );
+
+  {
+    typedef std::multiset<std::pair<PackedTime, uint64_t> > Index;
+    Index index;
+    std::shared_mutex mutex;
+    std::atomic<PackedTime> latest( 0 );
+    const Result result =
+      Run( nWriters, nReaders, seconds,
+           [&]( const unsigned w, const PackedTime time )
+           {
+             std::unique_lock<std::shared_mutex> lock( mutex );
+             index.insert( std::make_pair( time, static_cast<uint64_t>( w ) ) );
+             if( time > latest.load( std::memory_order_relaxed ) )
+               latest.store( time, std::memory_order_relaxed );
+           },
+           [&]( const unsigned )
+           {
+             std::unique_lock<std::shared_mutex> lock( mutex );
+             index.erase( index.begin(), index.lower_bound( std::make_pair( latest.load() - kMaxAge, uint64_t( 0 ) ) ) );
+           },
+           [&]( const unsigned ) -> size_t
+           {
+             std::shared_lock<std::shared_mutex> lock( mutex );
+             const PackedTime end = latest.load( std::memory_order_relaxed );
+             size_t visited = 0;
+             uint64_t sum = 0;
+             for( Index::const_iterator it = index.lower_bound( std::make_pair( end - kWindow, uint64_t( 0 ) ) );
+                  it != index.end() && it->first < end; ++it, visited++ )
+               sum += it->second;
+             return visited + ( sum == 1 );
+           },
+           []( const unsigned ) {} );
+    Print( "rwlock", result );
+  }
+
+  {
+    QsbrDomain domain;
+    TimeSkipList<uint64_t> index( domain, kMaxAge );
+    std::vector<size_t> slots( nWriters + nReaders );
+    for( size_t t = 0; t < slots.size(); t++ )
+      slots[t] = domain.RegisterReader();
+    const Result result =
+      Run( nWriters, nReaders, seconds,
+           [&]( const unsigned w, const PackedTime time ) { index.Insert( time, w ); },
+           [&]( const unsigned ) { index.Evict(); },
+           [&]( const unsigned ) -> size_t
+           {
+             const PackedTime end = index.GetLatest();
+             uint64_t sum = 0;
+             const size_t visited = index.Scan( end - kWindow, end, [&sum]( const PackedTime, const uint64_t value ) { sum += value; } );
+             return visited + ( sum == 1 );
+           },
+           [&]( const unsigned t ) { domain.Quiescent( slots[t] ); } );
+    for( size_t t = 0; t < slots.size(); t++ )
+      domain.UnregisterReader( slots[t] );
+    Print( "skiplist", result );
+  }
+  return 0;
+}
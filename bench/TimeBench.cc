@@ -0,0 +1,442 @@
+////////////////////////////////////////////////////////////////////
+/// Benchmarks of the UniversalTime core and the batch time kernels.
+///
+/// Usage: TimeBench [--filter=s] [--min-time=s] [--repetitions=n] [--json=file]
+///                  [--counters=0|1]
+////////////////////////////////////////////////////////////////////
+#include <BenchHarness.hh>
+
+#include <AsOfJoin.hh>
+#include <BinaryLogger.hh>
+#include <ChannelRateTable.hh>
+#include <Deduplicator.hh>
+#include <EventClusterer.hh>
+#include <InterArrivalStats.hh>
+#include <PackedTime.hh>
+#include <TimeAuditor.hh>
+#include <TimeColumnExtractor.hh>
+#include <TimeGenerator.hh>
+#include <TimeRollupStore.hh>
+#include <TimeWireFormat.hh>
+#include <UniversalTimeCore.hh>
+#include <UniversalTimeLiterals.hh>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <set>
+#include <string>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  const size_t kBatch = 4096; ///< Times per call of the per time benchmarks
+  const size_t kStream = 1 << 20; ///< Times per call of the batch kernels
+
+  /// Raw fields with a given sign pattern
+  struct Fields
+  {
+    std::vector<int32_t> days;
+    std::vector<int32_t> seconds;
+    std::vector<double> nanoSeconds;
+  };
+
+  /// sign < 0 all fields negative, > 0 all positive, 0 main.C's mixed signs
+  Fields MakeFields( const int sign )
+  {
+    Fields fields;
+    fields.days.resize( kBatch );
+    fields.seconds.resize( kBatch );
+    fields.nanoSeconds.resize( kBatch );
+    TimeGenerator generator( 5 );
+    generator.MixedSignFields( fields.days.data(), fields.seconds.data(), fields.nanoSeconds.data(), kBatch );
+    for( size_t i = 0; sign != 0 && i < kBatch; i++ )
+      {
+        fields.days[i] = sign * std::abs( fields.days[i] );
+        fields.seconds[i] = sign * std::abs( fields.seconds[i] );
+        fields.nanoSeconds[i] = sign * std::abs( fields.nanoSeconds[i] );
+      }
+    return fields;
+  }
+
+  /// A DS hit as a TObject would hold it, UncheckedAt returns the base
+  class BenchObject
+  {
+  public:
+    virtual ~BenchObject() { }
+    uint32_t uniqueID = 0;
+    uint32_t bits = 0;
+  };
+
+  class BenchHit : public BenchObject
+  {
+  public:
+    BenchHit( const UniversalTimeCore& time_ ) : pmt(0), charge(0.0), time(time_) { }
+    virtual UniversalTimeCore GetTime() const { return time; }
+    int pmt;
+    double charge;
+    UniversalTimeCore time;
+  };
+
+  /// Stands in for TObjArray
+  struct BenchArray
+  {
+    int GetEntriesFast() const { return static_cast<int>( objects.size() ); }
+    BenchObject* UncheckedAt( const int i ) const { return objects[i]; }
+    std::vector<BenchObject*> objects;
+  };
+
+  template<class TTime>
+  void AddNormalise( BenchHarness& harness, const std::string& name, const int sign )
+  {
+    const Fields fields = MakeFields( sign );
+    harness.Add( name, kBatch, [fields]()
+                 {
+                   for( size_t i = 0; i < kBatch; i++ )
+                     {
+                       const TTime time( fields.days[i], fields.seconds[i], fields.nanoSeconds[i] );
+                       BenchHarness::DoNotOptimize( time );
+                     }
+                 } );
+  }
+
+  template<class TTime>
+  void AddSum( BenchHarness& harness, const std::string& name )
+  {
+    const Fields fields = MakeFields( 0 );
+    std::vector<TTime> times;
+    for( size_t i = 0; i < kBatch; i++ )
+      times.push_back( TTime( fields.days[i], fields.seconds[i], fields.nanoSeconds[i] ) );
+    harness.Add( name, kBatch - 1, [times]()
+                 {
+                   for( size_t i = 0; i + 1 < kBatch; i++ )
+                     BenchHarness::DoNotOptimize( times[i] + times[i + 1] );
+                 } );
+  }
+}
+
+int main( int argc, char** argv )
+{
+  BenchHarness harness;
+
+  AddNormalise<UniversalTimeCore>( harness, "Normalise/mixed", 0 );
+  AddNormalise<UniversalTimeCore>( harness, "Normalise/positive", 1 );
+  AddNormalise<UniversalTimeCore>( harness, "Normalise/negative", -1 );
+  AddNormalise<BasicUniversalTimeCore<CheckedArithmetic> >( harness, "Normalise/checked", 0 );
+  AddNormalise<BasicUniversalTimeCore<SaturatingArithmetic> >( harness, "Normalise/saturating", 0 );
+  AddSum<UniversalTimeCore>( harness, "Add/unchecked" );
+  AddSum<BasicUniversalTimeCore<CheckedArithmetic> >( harness, "Add/checked" );
+  AddSum<BasicUniversalTimeCore<SaturatingArithmetic> >( harness, "Add/saturating" );
+
+  const Fields mixed = MakeFields( 0 );
+  std::vector<UniversalTimeCore> times;
+  for( size_t i = 0; i < kBatch; i++ )
+    times.push_back( UniversalTimeCore( mixed.days[i], mixed.seconds[i], mixed.nanoSeconds[i] ) );
+  harness.Add( "Compare/operator<", kBatch - 1, [&times]()
+               {
+                 size_t before = 0;
+                 for( size_t i = 0; i + 1 < kBatch; i++ )
+                   before += times[i] < times[i + 1];
+                 BenchHarness::DoNotOptimize( before );
+               } );
+  harness.Add( "Subtract/UniversalTimeCore", kBatch - 1, [&times]()
+               {
+                 for( size_t i = 0; i + 1 < kBatch; i++ )
+                   BenchHarness::DoNotOptimize( times[i + 1] - times[i] );
+               } );
+  // A trigger window as a literal folded into the compare, and built at run time as before
+  harness.Add( "Window/literal", kBatch - 1, [&times]()
+               {
+                 using namespace UniversalTimeLiterals;
+                 size_t inside = 0;
+                 for( size_t i = 0; i + 1 < kBatch; i++ )
+                   inside += times[i + 1] - times[i] < 400_ns;
+                 BenchHarness::DoNotOptimize( inside );
+               } );
+  harness.Add( "Window/runtime", kBatch - 1, [&times]()
+               {
+                 static volatile double windowNs = 400.0;
+                 size_t inside = 0;
+                 for( size_t i = 0; i + 1 < kBatch; i++ )
+                   inside += times[i + 1] - times[i] < UniversalTimeCore( 0, 0, windowNs );
+                 BenchHarness::DoNotOptimize( inside );
+               } );
+  std::vector<PackedTime> packed( kBatch );
+  harness.Add( "Pack/UniversalTimeCore", kBatch, [&times, &packed]()
+               {
+                 PackedTimes::Pack( times.data(), kBatch, packed.data() );
+                 BenchHarness::DoNotOptimize( packed[0] );
+               } );
+
+  // Sorted hits, a 1 MHz Poisson process with a 100 ns dead time
+  TimeGenerator generator( 7 );
+  std::vector<PackedTime> hits( kStream );
+  generator.Poisson( 0, 1.0e6, 100, hits.data(), hits.size() );
+
+  harness.Add( "TimeGenerator/Poisson", kStream, [&generator]()
+               {
+                 static std::vector<PackedTime> out( kStream );
+                 generator.Poisson( 0, 1.0e6, 100, out.data(), out.size() );
+                 BenchHarness::DoNotOptimize( out[0] );
+               } );
+  harness.Add( "TimeGenerator/Uniform", kStream, [&generator]()
+               {
+                 static std::vector<PackedTime> out( kStream );
+                 generator.Uniform( 0, PackedTimes::kNanoSecondsPerDay, out.data(), out.size() );
+                 BenchHarness::DoNotOptimize( out[0] );
+               } );
+  harness.Add( "EventClusterer/gap1us", kStream, [&hits]()
+               {
+                 const EventClusterer clusterer( 1000 );
+                 std::vector<EventClusterer::Range> events;
+                 clusterer.Cluster( hits.data(), hits.size(), events );
+                 BenchHarness::DoNotOptimize( events.size() );
+               } );
+  harness.Add( "InterArrivalStats/Fill", kStream, [&hits]()
+               {
+                 InterArrivalStats stats;
+                 stats.Fill( hits.data(), hits.size() );
+                 BenchHarness::DoNotOptimize( stats.GetMean() );
+               } );
+
+  // Auditing the hits inline, a clean stream so only the block checks run
+  std::vector<PackedTime> arrivals( kStream );
+  for( size_t i = 0; i < kStream; i++ )
+    arrivals[i] = hits[i] + 250000 + static_cast<PackedTime>( i % 7 );
+  std::vector<int32_t> hitDays( kStream ), hitSeconds( kStream );
+  std::vector<double> hitNanoSeconds( kStream );
+  for( size_t i = 0; i < kStream; i++ )
+    PackedTimes::Unpack( hits[i], hitDays[i], hitSeconds[i], hitNanoSeconds[i] );
+  harness.Add( "TimeAuditor/Audit", kStream, [&hits]()
+               {
+                 TimeAuditor auditor( 1000000 );
+                 std::vector<TimeAuditor::Anomaly> anomalies;
+                 BenchHarness::DoNotOptimize( auditor.Audit( hits.data(), kStream, anomalies ) );
+               } );
+  harness.Add( "TimeAuditor/AuditReference", kStream, [&hits, &arrivals]()
+               {
+                 TimeAuditor auditor( 1000000, 100 );
+                 std::vector<TimeAuditor::Anomaly> anomalies;
+                 BenchHarness::DoNotOptimize( auditor.Audit( hits.data(), arrivals.data(), kStream, anomalies ) );
+               } );
+  harness.Add( "TimeAuditor/AuditFields", kStream, [&hitDays, &hitSeconds, &hitNanoSeconds]()
+               {
+                 static std::vector<PackedTime> packed( kStream );
+                 TimeAuditor auditor( 1000000 );
+                 std::vector<TimeAuditor::Anomaly> anomalies;
+                 BenchHarness::DoNotOptimize( auditor.AuditFields( hitDays.data(), hitSeconds.data(), hitNanoSeconds.data(),
+                                                                   kStream, anomalies, packed.data() ) );
+               } );
+
+  // The hits merged from two tiers, a fifth arriving twice up to 50 ns apart, GTID per hit
+  std::vector<PackedTime> mergedTimes;
+  std::vector<uint32_t> mergedGtids;
+  for( size_t i = 0; i < kStream; i++ )
+    {
+      mergedTimes.push_back( hits[i] );
+      mergedGtids.push_back( static_cast<uint32_t>( i ) & 0xFFFFFF );
+      if( i % 5 == 0 )
+        {
+          mergedTimes.push_back( hits[i] + static_cast<PackedTime>( i % 51 ) );
+          mergedGtids.push_back( static_cast<uint32_t>( i ) & 0xFFFFFF );
+        }
+    }
+  harness.Add( "Deduplicator/Add", mergedTimes.size(), [&mergedTimes, &mergedGtids]()
+               {
+                 Deduplicator deduplicator( 50 );
+                 for( size_t i = 0; i < mergedTimes.size(); i++ )
+                   deduplicator.Add( mergedTimes[i], mergedGtids[i] );
+                 BenchHarness::DoNotOptimize( deduplicator.GetDuplicates() );
+               } );
+  harness.Add( "Deduplicator/stdSet", mergedTimes.size(), [&mergedTimes, &mergedGtids]()
+               {
+                 // The global set of (time, GTID) it replaces, an exact time match
+                 std::set<std::pair<PackedTime, uint32_t> > seen;
+                 size_t duplicates = 0;
+                 for( size_t i = 0; i < mergedTimes.size(); i++ )
+                   duplicates += !seen.insert( std::make_pair( mergedTimes[i], mergedGtids[i] ) ).second;
+                 BenchHarness::DoNotOptimize( duplicates );
+               } );
+
+  // Four slow control series, one reading per ms, joined onto the hits
+  AsOfJoin join;
+  for( size_t s = 0; s < 4; s++ )
+    {
+      std::vector<PackedTime> readings( hits.back() / 1000000 + 2 );
+      std::vector<double> values( readings.size() );
+      for( size_t j = 0; j < readings.size(); j++ )
+        {
+          readings[j] = static_cast<PackedTime>( j ) * 1000000 - 500000;
+          values[j] = static_cast<double>( ( j * ( s + 3 ) ) % 17 );
+        }
+      join.AddSeries( readings.data(), values.data(), readings.size() );
+    }
+  harness.Add( "AsOfJoin/latest", kStream * 4, [&hits, &join]()
+               {
+                 static std::vector<double> out( kStream * 4 );
+                 join.Join( hits.data(), hits.size(), AsOfJoin::kLatest, out.data() );
+                 BenchHarness::DoNotOptimize( out[0] );
+               } );
+  harness.Add( "AsOfJoin/interpolate", kStream * 4, [&hits, &join]()
+               {
+                 static std::vector<double> out( kStream * 4 );
+                 join.Join( hits.data(), hits.size(), AsOfJoin::kInterpolate, out.data() );
+                 BenchHarness::DoNotOptimize( out[0] );
+               } );
+  harness.Add( "AsOfJoin/binarySearch", kStream * 4, [&hits, &join]()
+               {
+                 static std::vector<double> out( kStream * 4 );
+                 for( size_t s = 0; s < 4; s++ )
+                   for( size_t i = 0; i < kStream; i++ )
+                     out[s * kStream + i] = join.Lookup( s, hits[i], AsOfJoin::kInterpolate );
+                 BenchHarness::DoNotOptimize( out[0] );
+               } );
+
+  // The hits spread over 10k PMT channels, rates decayed with tau = 1 s
+  std::vector<PackedTime> picks( kStream );
+  generator.Uniform( 0, 10000, picks.data(), picks.size() );
+  const std::vector<uint32_t> channels( picks.begin(), picks.end() );
+  ChannelRateTable rates( 10000, 1.0 );
+  harness.Add( "ChannelRateTable/Fill", kStream, [&hits, &channels, &rates]()
+               {
+                 rates.Fill( channels.data(), hits.data(), kStream );
+                 BenchHarness::DoNotOptimize( rates.GetRate( 0, hits.back() ) );
+               } );
+  harness.Add( "ChannelRateTable/stdExp", kStream, [&hits, &channels]()
+               {
+                 static std::vector<PackedTime> lasts( 10000 );
+                 static std::vector<double> weights( 10000 );
+                 for( size_t i = 0; i < kStream; i++ )
+                   {
+                     const uint32_t channel = channels[i];
+                     weights[channel] = weights[channel] * std::exp( -( hits[i] - lasts[channel] ) * 1.0e-9 ) + 1.0;
+                     lasts[channel] = hits[i];
+                   }
+                 BenchHarness::DoNotOptimize( weights[0] );
+               } );
+  harness.Add( "ChannelRateTable/Snapshot", 10000, [&hits, &rates]()
+               {
+                 static std::vector<double> out( 10000 );
+                 rates.Snapshot( hits.back(), out.data() );
+                 BenchHarness::DoNotOptimize( out[0] );
+               } );
+
+  // A DAQ log line, binary with the formatting deferred, and formatted in place as before
+  BinaryLogger logger;
+  const uint32_t format = logger.RegisterFormat( "crate %d card %d gtid %u lost %s" );
+  BinaryLogger::Producer& producer = logger.AddProducer( kBatch );
+  harness.Add( "BinaryLogger/Log", kBatch, [&hits, &logger, &producer, format]()
+               {
+                 static std::vector<BinaryLogger::Record> records;
+                 for( size_t i = 0; i < kBatch; i++ )
+                   producer.Log( format, hits[i], static_cast<int>( i & 31 ), static_cast<int>( i & 15 ),
+                                 static_cast<uint32_t>( i ), "timeout" );
+                 BenchHarness::DoNotOptimize( logger.Drain( records ) );
+               } );
+  harness.Add( "BinaryLogger/snprintf", kBatch, [&times]()
+               {
+                 char stamp[64];
+                 char line[256];
+                 for( size_t i = 0; i < kBatch; i++ )
+                   {
+                     const std::tm calendar = times[i].GetTime();
+                     std::strftime( stamp, sizeof( stamp ), "%Y-%m-%d %H:%M:%S", &calendar );
+                     std::snprintf( line, sizeof( line ), "%s.%09.0f crate %d card %d gtid %u lost %s", stamp,
+                                    times[i].GetNanoSeconds(), static_cast<int>( i & 31 ), static_cast<int>( i & 15 ),
+                                    static_cast<unsigned>( i ), "timeout" );
+                     BenchHarness::DoNotOptimize( line[0] );
+                   }
+               } );
+
+  // A monitoring summary's timestamps, a JSON string from GetTime as before, and binary
+  harness.Add( "TimeWireFormat/jsonString", kBatch, [&times]()
+               {
+                 static std::vector<char> out( kBatch * 40 );
+                 char stamp[32];
+                 char* text = out.data();
+                 for( size_t i = 0; i < kBatch; i++ )
+                   {
+                     const std::tm calendar = times[i].GetTime();
+                     std::strftime( stamp, sizeof( stamp ), "%Y-%m-%dT%H:%M:%S", &calendar );
+                     text += std::snprintf( text, 40, "\"%s.%09.0fZ\"", stamp, times[i].GetNanoSeconds() );
+                   }
+                 BenchHarness::DoNotOptimize( out[0] );
+               } );
+  harness.Add( "TimeWireFormat/EncodeMsgPack", kBatch, [&hits]()
+               {
+                 static std::vector<uint8_t> out( kBatch * TimeWireFormat::kMsgPackMaxBytes );
+                 BenchHarness::DoNotOptimize( TimeWireFormat::EncodeMsgPack( hits.data(), kBatch, out.data() ) );
+               } );
+  harness.Add( "TimeWireFormat/EncodeCbor", kBatch, [&hits]()
+               {
+                 static std::vector<uint8_t> out( kBatch * TimeWireFormat::kCborMaxBytes );
+                 BenchHarness::DoNotOptimize( TimeWireFormat::EncodeCbor( hits.data(), kBatch, out.data() ) );
+               } );
+  std::vector<uint8_t> encoded( kBatch * TimeWireFormat::kCborMaxBytes );
+  const size_t encodedSize = TimeWireFormat::EncodeCbor( hits.data(), kBatch, encoded.data() );
+  harness.Add( "TimeWireFormat/DecodeCbor", kBatch, [&encoded, encodedSize]()
+               {
+                 static std::vector<PackedTime> out( kBatch );
+                 BenchHarness::DoNotOptimize( TimeWireFormat::DecodeCbor( encoded.data(), encodedSize, out.data(), kBatch ) );
+               } );
+
+  // Hits allocated one by one, interleaved with other objects as an event's would be
+  std::vector<std::unique_ptr<BenchHit> > heapHits;
+  std::vector<std::unique_ptr<char[]> > clutter;
+  BenchArray array;
+  for( size_t i = 0; i < kStream; i++ )
+    {
+      heapHits.emplace_back( new BenchHit( times[i % kBatch] ) );
+      clutter.emplace_back( new char[64 + 32 * ( i % 7 )] );
+      array.objects.push_back( heapHits.back().get() );
+    }
+  harness.Add( "TimeColumnExtractor/naive", kStream, [&array]()
+               {
+                 static std::vector<PackedTime> out( kStream );
+                 for( int i = 0; i < array.GetEntriesFast(); i++ )
+                   out[i] = PackedTimes::Pack( static_cast<const BenchHit*>( array.UncheckedAt( i ) )->GetTime() );
+                 BenchHarness::DoNotOptimize( out[0] );
+               } );
+  harness.Add( "TimeColumnExtractor/Extract", kStream, [&array]()
+               {
+                 static std::vector<PackedTime> out( kStream );
+                 TimeColumnExtractor::Extract<BenchHit>( array, []( const BenchHit& hit ) { return hit.BenchHit::GetTime(); },
+                                                         out.data() );
+                 BenchHarness::DoNotOptimize( out[0] );
+               } );
+  const ptrdiff_t offset = TimeColumnExtractor::OffsetOf( array.UncheckedAt( 0 ), heapHits[0]->time );
+  harness.Add( "TimeColumnExtractor/ExtractAtOffset", kStream, [&array, offset]()
+               {
+                 static std::vector<PackedTime> out( kStream );
+                 TimeColumnExtractor::ExtractAtOffset( array, offset, out.data() );
+                 BenchHarness::DoNotOptimize( out[0] );
+               } );
+
+  char directory[] = "/tmp/TimeBenchXXXXXX";
+  const bool haveDirectory = mkdtemp( directory ) != 0;
+  TimeRollupStore* store = haveDirectory ? new TimeRollupStore( directory ) : 0;
+  if( store != 0 )
+    harness.Add( "TimeRollupStore/Fill", kStream, [&hits, store]()
+                 {
+                   // Shift each call past the last so points keep arriving in time order
+                   static PackedTime offset = 0;
+                   for( size_t i = 0; i < kStream; i++ )
+                     store->Fill( hits[i] + offset, 1.0 );
+                   offset += hits.back() + 1;
+                 } );
+
+  const int result = harness.Run( argc, argv );
+  delete store;
+  if( haveDirectory )
+    {
+      const char* names[] = { "1s", "1min", "1h", "1d" };
+      for( size_t level = 0; level < TimeRollupStore::kLevels; level++ )
+        std::remove( ( std::string( directory ) + "/rollup_" + names[level] + ".seg" ).c_str() );
+      rmdir( directory );
+    }
+  return result;
+}
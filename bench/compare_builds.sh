@@ -0,0 +1,38 @@
+#!/bin/sh
+# Build the release, LTO and PGO (+LTO) variants with the CMake presets,
+# train the PGO build on TimeBench, then run TimeBench on each variant
+# and print the speedup of every benchmark over the plain release build.
+#
+# Usage: bench/compare_builds.sh [TimeBench options, e.g. --min-time=0.5]
+set -e
+cd "$(dirname "$0")/.."
+results=build/compare
+mkdir -p "$results"
+
+build() {
+  cmake --preset "$1" >/dev/null
+  cmake --build "build/$1" --target TimeBench -j"$(nproc)" >/dev/null
+}
+
+build release
+build release-lto
+rm -rf build/pgo-profiles
+build release-pgo-generate
+./build/release-pgo-generate/TimeBench --min-time=0.05 --repetitions=1 >/dev/null
+build release-pgo-use
+
+for variant in release release-lto release-pgo-use; do
+  echo "running $variant" >&2
+  ./build/$variant/TimeBench --json="$results/$variant.json" "$@" >/dev/null
+done
+
+# name and ns_per_item of each JSON line
+extract() {
+  sed -e 's/.*"name":"\([^"]*\)".*"ns_per_item":\([^,]*\),.*/\1 \2/' "$1"
+}
+extract "$results/release.json" > "$results/release.txt"
+extract "$results/release-lto.json" > "$results/release-lto.txt"
+extract "$results/release-pgo-use.json" > "$results/release-pgo-use.txt"
+printf "%-32s %12s %10s %10s\n" benchmark "release ns" "lto x" "pgo+lto x"
+join "$results/release.txt" "$results/release-lto.txt" | join - "$results/release-pgo-use.txt" |
+  awk '{ printf "%-32s %12.3f %10.2f %10.2f\n", $1, $2, $2 / $3, $2 / $4 }'
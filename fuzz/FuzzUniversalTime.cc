@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////
+/// Fuzz target for UniversalTimeCore normalisation and arithmetic.
+///
+/// Each input is read as two raw (days, seconds, ns) triplets, both
+/// times are normalised and added/subtracted, and the results are
+/// checked against exact integer ns arithmetic on the packed times.
+/// Normalised fields must be canonical and order as the packed times.
+///
+/// Built with -DUT_LIBFUZZER (clang -fsanitize=fuzzer) this is a
+/// libFuzzer target. Otherwise it has its own main: each argument is
+/// an input file, and with no files it runs --iterations random
+/// inputs from TimeGenerator (default 1000000).
+////////////////////////////////////////////////////////////////////
+#include <PackedTime.hh>
+#include <TimeGenerator.hh>
+#include <UniversalTimeCore.hh>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+  /// Largest raw field magnitudes, beyond these the int fields of the class overflow
+  const int32_t kMaxDays = 1000000;
+  const int32_t kMaxSeconds = 1000000000;
+  const double kMaxNanoSeconds = 1.0e18;
+
+  struct Raw
+  {
+    int32_t days;
+    int32_t seconds;
+    double nanoSeconds;
+  };
+
+  bool InRange( const Raw& raw )
+  {
+    return std::isfinite( raw.nanoSeconds ) && std::fabs( raw.nanoSeconds ) < kMaxNanoSeconds
+      && raw.days > -kMaxDays && raw.days < kMaxDays && raw.seconds > -kMaxSeconds && raw.seconds < kMaxSeconds;
+  }
+
+  void Fail( const char* what, const Raw& a, const Raw& b )
+  {
+    std::fprintf( stderr, "FuzzUniversalTime: %s for (%d, %d, %.17g) and (%d, %d, %.17g)\n",
+                  what, a.days, a.seconds, a.nanoSeconds, b.days, b.seconds, b.nanoSeconds );
+    std::abort();
+  }
+
+  /// Packed times differ by at most the rounding of the double ns
+  bool Close( const PackedTime lhs, const PackedTime rhs )
+  {
+    return std::llabs( lhs - rhs ) <= 2;
+  }
+
+  void CheckPair( const Raw& a, const Raw& b )
+  {
+    if( !InRange( a ) || !InRange( b ) )
+      return;
+    const UniversalTimeCore timeA( a.days, a.seconds, a.nanoSeconds );
+    const UniversalTimeCore timeB( b.days, b.seconds, b.nanoSeconds );
+    const PackedTime packedA = PackedTimes::Pack( a.days, a.seconds, a.nanoSeconds );
+    const PackedTime packedB = PackedTimes::Pack( b.days, b.seconds, b.nanoSeconds );
+    if( !Close( PackedTimes::Pack( timeA ), packedA ) )
+      Fail( "normalisation changed the time", a, b );
+    if( !( timeA.GetNanoSeconds() >= 0.0 && timeA.GetNanoSeconds() < 1.0e9 )
+        || timeA.GetSeconds() < 0 || timeA.GetSeconds() >= 86400 )
+      Fail( "normalised fields not canonical", a, b );
+    // Rounding can make different times pack the same, otherwise the orders agree
+    const PackedTime normalisedA = PackedTimes::Pack( timeA );
+    const PackedTime normalisedB = PackedTimes::Pack( timeB );
+    if( normalisedA != normalisedB && ( timeA < timeB ) != ( normalisedA < normalisedB ) )
+      Fail( "order differs from the packed order", a, b );
+    if( !Close( PackedTimes::Pack( timeA + timeB ), packedA + packedB ) )
+      Fail( "sum is wrong", a, b );
+    if( !Close( PackedTimes::Pack( timeA - timeB ), packedA - packedB ) )
+      Fail( "difference is wrong", a, b );
+  }
+}
+
+extern "C" int
+LLVMFuzzerTestOneInput( const uint8_t* data, size_t size )
+{
+  Raw raws[2];
+  if( size < sizeof( raws ) )
+    return 0;
+  for( size_t i = 0; i < 2; i++ ) // Field by field, the struct padding is not input
+    {
+      const uint8_t* bytes = data + i * 16;
+      std::memcpy( &raws[i].days, bytes, 4 );
+      std::memcpy( &raws[i].seconds, bytes + 4, 4 );
+      std::memcpy( &raws[i].nanoSeconds, bytes + 8, 8 );
+    }
+  CheckPair( raws[0], raws[1] );
+  return 0;
+}
+
+#ifndef UT_LIBFUZZER
+int
+main( int argc, char** argv )
+{
+  size_t iterations = 1000000;
+  std::vector<std::string> files;
+  for( int i = 1; i < argc; i++ )
+    {
+      const std::string argument = argv[i];
+      if( argument.compare( 0, 13, "--iterations=" ) == 0 )
+        iterations = std::strtoul( argument.c_str() + 13, 0, 10 );
+      else
+        files.push_back( argument );
+    }
+  for( size_t i = 0; i < files.size(); i++ )
+    {
+      FILE* file = std::fopen( files[i].c_str(), "rb" );
+      if( file == 0 )
+        {
+          std::fprintf( stderr, "cannot read %s\n", files[i].c_str() );
+          return 1;
+        }
+      std::vector<uint8_t> input( 32 );
+      input.resize( std::fread( input.data(), 1, input.size(), file ) );
+      std::fclose( file );
+      LLVMFuzzerTestOneInput( input.data(), input.size() );
+    }
+  if( !files.empty() )
+    return 0;
+  // Mixed sign fields as main.C makes them, then wider ones
+  const size_t block = 4096;
+  std::vector<int32_t> days( 2 * block ), seconds( 2 * block );
+  std::vector<double> nanoSeconds( 2 * block );
+  TimeGenerator generator( 11 );
+  for( size_t done = 0; done < iterations; done += block )
+    {
+      generator.MixedSignFields( days.data(), seconds.data(), nanoSeconds.data(), 2 * block );
+      const double scale = ( done / block ) % 2 == 0 ? 1.0 : 1.0e6;
+      for( size_t i = 0; i < block && done + i < iterations; i++ )
+        {
+          const Raw a = { days[2 * i], seconds[2 * i], nanoSeconds[2 * i] * scale };
+          const Raw b = { days[2 * i + 1], seconds[2 * i + 1], nanoSeconds[2 * i + 1] };
+          CheckPair( a, b );
+        }
+    }
+  std::printf( "FuzzUniversalTime: %zu inputs passed\n", iterations );
+  return 0;
+}
+#endif
@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////
+/// \class Check
+///
+/// \brief  Minimal assertion macros for the unit test executables
+///
+/// REVISION HISTORY:\n
+///  2026-10-17 : New file with the CMake build.
+///
+/// \details Each test is an executable, a failed check prints the
+///         location and expression and the test returns Check::Result(),
+///         non zero if anything failed, to ctest.
+///
+////////////////////////////////////////////////////////////////////
+#ifndef __RAT_DS_Check__
+#define __RAT_DS_Check__
+
+#include <cmath>
+#include <cstdio>
+
+class Check
+{
+public:
+  /// Record a failure
+  static void Fail( const char* file, const int line, const char* expression )
+  {
+    std::fprintf( stderr, "%s:%d: check failed: %s\n", file, line, expression );
+    Failures()++;
+  }
+
+  /// Get the exit code
+  ///
+  /// @return 0 if every check passed
+  static int Result()
+  {
+    if( Failures() != 0 )
+      std::fprintf( stderr, "%d check(s) failed\n", Failures() );
+    return Failures() == 0 ? 0 : 1;
+  }
+
+protected:
+  static int& Failures()
+  {
+    static int failures = 0;
+    return failures;
+  }
+};
+
+#define UT_CHECK( expression ) \
+  do { if( !( expression ) ) Check::Fail( __FILE__, __LINE__, #expression ); } while( 0 )
+
+#define UT_CHECK_CLOSE( lhs, rhs, tolerance ) \
+  do { if( !( std::fabs( ( lhs ) - ( rhs ) ) <= ( tolerance ) ) ) Check::Fail( __FILE__, __LINE__, #lhs " ~= " #rhs ); } while( 0 )
+
+#endif
@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of AsOfJoin against its binary search lookup.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <AsOfJoin.hh>
+#include <TimeGenerator.hh>
+
+#include <cmath>
+#include <vector>
+
+int main()
+{
+  // Hand checked values, with a repeated reading time
+  AsOfJoin join;
+  const PackedTime readingTimes[] = { 100, 200, 200, 400 };
+  const double readingValues[] = { 1.0, 2.0, 5.0, 9.0 };
+  UT_CHECK( join.AddSeries( readingTimes, readingValues, 4 ) == 0 );
+  const PackedTime events[] = { 50, 100, 150, 199, 200, 300, 400, 1000000 };
+  const std::vector<double> latest = join.Join( events, 8, AsOfJoin::kLatest );
+  UT_CHECK( std::isnan( latest[0] ) );
+  UT_CHECK( latest[1] == 1.0 && latest[2] == 1.0 && latest[3] == 1.0 );
+  UT_CHECK( latest[4] == 5.0 && latest[5] == 5.0 && latest[6] == 9.0 && latest[7] == 9.0 );
+  const std::vector<double> interpolated = join.Join( events, 8, AsOfJoin::kInterpolate );
+  UT_CHECK( std::isnan( interpolated[0] ) );
+  UT_CHECK_CLOSE( interpolated[2], 1.5, 1e-12 );
+  UT_CHECK_CLOSE( interpolated[3], 1.99, 1e-12 );
+  UT_CHECK_CLOSE( interpolated[4], 5.0, 1e-12 );
+  UT_CHECK_CLOSE( interpolated[5], 7.0, 1e-12 );
+  UT_CHECK_CLOSE( interpolated[7], 9.0, 1e-12 ); // Held after the last reading
+
+  const PackedTime unsorted[] = { 2, 1 };
+  bool threw = false;
+  try
+    {
+      join.AddSeries( unsorted, readingValues, 2 );
+    }
+  catch( const std::invalid_argument& )
+    {
+      threw = true;
+    }
+  UT_CHECK( threw );
+
+  // Several series, one with gaps too wide for the SIMD path, several chunks, against the lookups
+  TimeGenerator generator( 9 );
+  const size_t nEvents = 200003;
+  std::vector<PackedTime> eventTimes( nEvents );
+  generator.Poisson( -5000000000ll, 1.0e5, 0, eventTimes.data(), nEvents );
+  AsOfJoin many( 4 );
+  const double rates[] = { 1.0, 1000.0 };
+  for( size_t s = 0; s < 3; s++ )
+    {
+      std::vector<PackedTime> times( s < 2 ? 1000 + s * 5000 : 1000 );
+      if( s < 2 )
+        generator.Poisson( -6000000000ll, rates[s], 0, times.data(), times.size() );
+      else // Readings 2^52 ns apart, wider than the SIMD offset conversion takes
+        for( size_t j = 0; j < times.size(); j++ )
+          times[j] = ( static_cast<PackedTime>( j ) - 2 ) * ( PackedTime( 1 ) << 52 );
+      std::vector<double> values( times.size() );
+      for( size_t j = 0; j < values.size(); j++ )
+        values[j] = std::sin( 0.01 * j ) * 20.0 + s;
+      many.AddSeries( times.data(), values.data(), times.size() );
+    }
+  const AsOfJoin::Mode modes[] = { AsOfJoin::kLatest, AsOfJoin::kInterpolate };
+  for( size_t m = 0; m < 2; m++ )
+    {
+      const std::vector<double> out = many.Join( eventTimes.data(), nEvents, modes[m] );
+      bool same = true;
+      for( size_t s = 0; s < 3; s++ )
+        for( size_t i = 0; i < nEvents; i++ )
+          {
+            const double expected = many.Lookup( s, eventTimes[i], modes[m] );
+            const double value = out[s * nEvents + i];
+            same = same && ( std::isnan( expected ) ? std::isnan( value ) : std::fabs( value - expected ) <= 1e-9 );
+          }
+      UT_CHECK( same );
+      UT_CHECK( !std::isnan( out[2 * nEvents] ) ); // The wide series has readings before the events
+    }
+  return Check::Result();
+}
@@ -0,0 +1,180 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of BinaryLogger against snprintf, and of its binary
+/// file round trip.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <BinaryLogger.hh>
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  typedef std::vector<std::pair<PackedTime, std::string> > Lines;
+
+  /// Sink collecting the lines
+  struct Collect
+  {
+    Collect( Lines& lines_ ) : lines(lines_) { };
+    void operator()( const PackedTime time, const std::string& text ) const { lines.push_back( std::make_pair( time, text ) ); }
+    Lines& lines;
+  };
+}
+
+int main()
+{
+  // Calendar conversion either side of t0, over leap days and centuries
+  UT_CHECK( BinaryLogger::FormatTime( 0 ) == "2010-01-01 00:00:00.000000000" );
+  UT_CHECK( BinaryLogger::FormatTime( -1 ) == "2009-12-31 23:59:59.999999999" );
+  UT_CHECK( BinaryLogger::FormatTime( 789 * PackedTimes::kNanoSecondsPerDay + 3723000000123ll )
+            == "2012-02-29 01:02:03.000000123" );
+  UT_CHECK( BinaryLogger::FormatTime( 790 * PackedTimes::kNanoSecondsPerDay ) == "2012-03-01 00:00:00.000000000" );
+  UT_CHECK( BinaryLogger::FormatTime( -3653 * PackedTimes::kNanoSecondsPerDay ) == "2000-01-01 00:00:00.000000000" );
+  UT_CHECK( BinaryLogger::FormatTime( 32872 * PackedTimes::kNanoSecondsPerDay ) == "2100-01-01 00:00:00.000000000" );
+  UT_CHECK( BinaryLogger::FormatTime( 32931 * PackedTimes::kNanoSecondsPerDay ) == "2100-03-01 00:00:00.000000000" );
+
+  // Formatting matches snprintf for each kind of argument
+  BinaryLogger logger;
+  const uint32_t numbers = logger.RegisterFormat( "crate %d gtid %u hex %08lx %5.2f%% %-4s| %c %e" );
+  const uint32_t strings = logger.RegisterFormat( "%s and %s" );
+  const uint32_t mismatched = logger.RegisterFormat( "%d %f %s %d" );
+  BinaryLogger::Producer& producer = logger.AddProducer( 4 );
+  UT_CHECK( producer.Log( numbers, 20, -3, 16777215u, 0xbeefl, 99.5, "ab", 'x', 1.0e-3 ) );
+  UT_CHECK( producer.Log( strings, 10, std::string( "first" ), std::string( 100, 'y' ) ) );
+  UT_CHECK( producer.Log( mismatched, 30, 2.5, 7, 8 ) );
+  UT_CHECK( producer.Log( numbers, 40 ) );
+  UT_CHECK( !producer.Log( numbers, 50 ) );
+  UT_CHECK( producer.GetDropped() == 1 && logger.GetDropped() == 1 );
+
+  Lines lines;
+  UT_CHECK( logger.Process( Collect( lines ) ) == 4 );
+  UT_CHECK( lines.size() == 4 );
+  char expected[256];
+  std::snprintf( expected, sizeof( expected ), "crate %d gtid %u hex %08lx %5.2f%% %-4s| %c %e", -3, 16777215u, 0xbeefl,
+                 99.5, "ab", 'x', 1.0e-3 );
+  UT_CHECK( lines[0].first == 10 && lines[1].first == 20 && lines[2].first == 30 ); // Time order
+  UT_CHECK( lines[1].second == "2010-01-01 00:00:00.000000020 " + std::string( expected ) );
+  // The second string is cut to what is left of the record
+  UT_CHECK( lines[0].second == "2010-01-01 00:00:00.000000010 first and " + std::string( 48 - 9, 'y' ) );
+  UT_CHECK( lines[2].second == "2010-01-01 00:00:00.000000030 2.5 7.000000 8 <?>" );
+  UT_CHECK( lines[3].second.find( "crate <?> gtid <?>" ) != std::string::npos );
+  UT_CHECK( logger.Process( Collect( lines ) ) == 0 );
+
+  // Several producer threads on the logging thread, written then decoded
+  FILE* file = std::tmpfile();
+  UT_CHECK( file != 0 );
+  const size_t nRecords = 20000;
+  {
+    BinaryLogger threaded;
+    const uint32_t format = threaded.RegisterFormat( "thread %d record %d" );
+    threaded.Start( file );
+    std::vector<std::thread> threads;
+    for( int t = 0; t < 3; t++ )
+      {
+        BinaryLogger::Producer& own = threaded.AddProducer();
+        threads.emplace_back( [&own, format, t, nRecords]()
+                              {
+                                for( size_t i = 0; i < nRecords; )
+                                  if( own.Log( format, static_cast<PackedTime>( i * 3 + t ), t, static_cast<int>( i ) ) )
+                                    i++;
+                                  else
+                                    std::this_thread::yield();
+                              } );
+      }
+    const uint32_t late = threaded.RegisterFormat( "registered while running %s" );
+    threaded.AddProducer().Log( late, -5, "ok" );
+    for( size_t t = 0; t < threads.size(); t++ )
+      threads[t].join();
+    threaded.Stop();
+  }
+  std::rewind( file );
+  Lines decoded;
+  UT_CHECK( BinaryLogger::Decode( file, Collect( decoded ) ) == 3 * nRecords + 1 );
+  std::fclose( file );
+  size_t bad = 0;
+  std::vector<size_t> next( 3, 0 );
+  for( size_t i = 0; i < decoded.size(); i++ )
+    {
+      if( decoded[i].first < 0 )
+        {
+          bad += decoded[i].second != "2009-12-31 23:59:59.999999995 registered while running ok";
+          continue;
+        }
+      const int t = static_cast<int>( decoded[i].first % 3 );
+      char text[64];
+      std::snprintf( text, sizeof( text ), " thread %d record %zu", t, next[t] );
+      bad += decoded[i].second != BinaryLogger::FormatTime( decoded[i].first ) + text;
+      next[t]++;
+    }
+  UT_CHECK( bad == 0 );
+  UT_CHECK( next[0] == nRecords && next[1] == nRecords && next[2] == nRecords );
+
+  bool threw = false;
+  FILE* junk = std::tmpfile();
+  std::fputs( "not a log", junk );
+  std::rewind( junk );
+  try
+    {
+      BinaryLogger::Decode( junk, Collect( decoded ) );
+    }
+  catch( const std::runtime_error& )
+    {
+      threw = true;
+    }
+  std::fclose( junk );
+  UT_CHECK( threw );
+
+  // A corrupt format length is refused rather than allocated
+  threw = false;
+  junk = std::tmpfile();
+  const uint32_t id = 0, length = 0xFFFFFFF0;
+  std::fputs( "UTBLOG1\nF", junk );
+  std::fwrite( &id, sizeof( id ), 1, junk );
+  std::fwrite( &length, sizeof( length ), 1, junk );
+  std::rewind( junk );
+  try
+    {
+      BinaryLogger::Decode( junk, Collect( decoded ) );
+    }
+  catch( const std::runtime_error& )
+    {
+      threw = true;
+    }
+  std::fclose( junk );
+  UT_CHECK( threw );
+
+  // A file that cannot be written fails Write, and Stop for the logging thread
+  {
+    BinaryLogger failing;
+    failing.AddProducer().Log( failing.RegisterFormat( "lost %d" ), 1, 1 );
+    FILE* readOnly = std::fopen( "/dev/null", "rb" );
+    threw = false;
+    try
+      {
+        failing.Write( readOnly );
+      }
+    catch( const std::runtime_error& )
+      {
+        threw = true;
+      }
+    UT_CHECK( threw );
+    failing.Start( readOnly );
+    failing.AddProducer().Log( 0, 2, 2 );
+    threw = false;
+    try
+      {
+        failing.Stop();
+      }
+    catch( const std::runtime_error& )
+      {
+        threw = true;
+      }
+    UT_CHECK( threw );
+    std::fclose( readOnly );
+  }
+  return Check::Result();
+}
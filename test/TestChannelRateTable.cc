@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of ChannelRateTable against std::exp.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <ChannelRateTable.hh>
+#include <TimeGenerator.hh>
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+int main()
+{
+  // The fast exponential over its whole range
+  double worst = 0.0;
+  for( double x = 0.0; x < 700.0; x += 0.0137 )
+    worst = std::max( worst, std::fabs( ChannelRateTable::ExpNegative( x ) / std::exp( -x ) - 1.0 ) );
+  UT_CHECK( worst < 1.0e-8 );
+  UT_CHECK( ChannelRateTable::ExpNegative( 0.0 ) == 1.0 );
+  UT_CHECK( ChannelRateTable::ExpNegative( -5.0 ) == 1.0 );
+  UT_CHECK( ChannelRateTable::ExpNegative( 1.0e6 ) < 1.0e-300 );
+
+  // Hand checked decay, tau = 1 s
+  ChannelRateTable table( 100, 1.0 );
+  UT_CHECK( table.GetChannelCount() == 100 );
+  UT_CHECK( table.GetRate( 7, 1000 ) == 0.0 );
+  table.Fill( 7, 1000000000 );
+  UT_CHECK_CLOSE( table.GetRate( 7, 1000000000 ), 1.0, 1e-12 );
+  UT_CHECK_CLOSE( table.GetRate( 7, 2000000000 ), std::exp( -1.0 ), 1e-9 );
+  table.Fill( 7, 1500000000 );
+  UT_CHECK_CLOSE( table.GetRate( 7, 1500000000 ), 1.0 + std::exp( -0.5 ), 1e-9 );
+  table.Fill( 7, 1400000000 ); // Out of order counts as at the last hit
+  UT_CHECK_CLOSE( table.GetRate( 7, 1500000000 ), 2.0 + std::exp( -0.5 ), 1e-9 );
+  UT_CHECK( table.GetRate( 8, 1500000000 ) == 0.0 );
+
+  bool threw = false;
+  try
+    {
+      table.GetRate( 100, 0 );
+    }
+  catch( const std::out_of_range& )
+    {
+      threw = true;
+    }
+  UT_CHECK( threw );
+  threw = false;
+  try
+    {
+      table.Fill( 100, 0 );
+    }
+  catch( const std::out_of_range& )
+    {
+      threw = true;
+    }
+  UT_CHECK( threw );
+  // A batch with one bad channel adds none of its hits
+  const uint32_t batchChannels[] = { 8, 100 };
+  const PackedTime batchTimes[] = { 1500000000, 1500000000 };
+  threw = false;
+  try
+    {
+      table.Fill( batchChannels, batchTimes, 2 );
+    }
+  catch( const std::out_of_range& )
+    {
+      threw = true;
+    }
+  UT_CHECK( threw && table.GetRate( 8, 1500000000 ) == 0.0 );
+  threw = false;
+  try
+    {
+      ChannelRateTable bad( 10, 0.0 );
+    }
+  catch( const std::invalid_argument& )
+    {
+      threw = true;
+    }
+  UT_CHECK( threw );
+
+  // A 1 kHz Poisson channel measures 1 kHz, tau = 1 s so the spread is about 2%
+  ChannelRateTable poisson( 1, 1.0 );
+  TimeGenerator generator( 11 );
+  std::vector<PackedTime> times( 20000 );
+  const PackedTime end = generator.Poisson( 0, 1000.0, 0, times.data(), times.size() );
+  const std::vector<uint32_t> zeros( times.size(), 0 );
+  poisson.Fill( zeros.data(), times.data(), times.size() );
+  UT_CHECK_CLOSE( poisson.GetRate( 0, end ), 1000.0, 100.0 );
+
+  // Batch fill agrees with std::exp, and Snapshot with GetRate
+  const size_t nChannels = 1000;
+  const size_t nHits = 200000;
+  std::vector<PackedTime> hits( nHits );
+  std::vector<PackedTime> picks( nHits );
+  generator.Poisson( 0, 1.0e6, 0, hits.data(), nHits );
+  generator.Uniform( 0, nChannels, picks.data(), nHits );
+  std::vector<uint32_t> channels( picks.begin(), picks.end() );
+  ChannelRateTable batch( nChannels, 0.01 );
+  batch.Fill( channels.data(), hits.data(), nHits );
+  std::vector<double> weights( nChannels, 0.0 );
+  std::vector<PackedTime> lasts( nChannels, 0 );
+  for( size_t i = 0; i < nHits; i++ )
+    {
+      weights[channels[i]] = weights[channels[i]] * std::exp( -( hits[i] - lasts[channels[i]] ) * 1.0e-7 ) + 1.0;
+      lasts[channels[i]] = hits[i];
+    }
+  std::vector<double> rates( nChannels );
+  batch.Snapshot( hits.back(), rates.data() );
+  size_t bad = 0;
+  for( size_t channel = 0; channel < nChannels; channel++ )
+    {
+      const double expected = weights[channel] * std::exp( -( hits.back() - lasts[channel] ) * 1.0e-7 ) * 100.0;
+      bad += std::fabs( rates[channel] - expected ) > 1.0e-7 * expected;
+      bad += rates[channel] != batch.GetRate( channel, hits.back() );
+    }
+  UT_CHECK( bad == 0 );
+
+  // Snapshots while another thread fills, every hit adds one so rates
+  // decayed to a far future time only ever grow and stay finite
+  ChannelRateTable shared( nChannels, 0.01 );
+  std::atomic<bool> done( false );
+  std::thread writer( [&]()
+                      {
+                        for( int pass = 0; pass < 10; pass++ )
+                          {
+                            std::vector<PackedTime> shifted( hits );
+                            for( size_t i = 0; i < nHits; i++ )
+                              shifted[i] += pass * ( hits.back() + 1 );
+                            shared.Fill( channels.data(), shifted.data(), nHits );
+                            std::this_thread::yield();
+                          }
+                        done.store( true );
+                      } );
+  const PackedTime future = 11 * ( hits.back() + 1 );
+  std::vector<double> previous( nChannels, 0.0 );
+  size_t torn = 0;
+  size_t snapshots = 0;
+  while( !done.load() || snapshots == 0 )
+    {
+      shared.Snapshot( future, rates.data() );
+      for( size_t channel = 0; channel < nChannels; channel++ )
+        {
+          torn += !std::isfinite( rates[channel] ) || rates[channel] < previous[channel];
+          previous[channel] = rates[channel];
+        }
+      snapshots++;
+      std::this_thread::yield();
+    }
+  writer.join();
+  UT_CHECK( torn == 0 );
+  return Check::Result();
+}
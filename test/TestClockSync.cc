@@ -0,0 +1,174 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of ClockOffsetEstimator on made up probes, and of
+/// ClockSync against responder processes with skewed, drifting and
+/// jittery clocks on the loopback interface.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <ClockOffsetEstimator.hh>
+#include <ClockSync.hh>
+#include <TimeGenerator.hh>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  /// Run a responder in a child process whose clock is skewed by
+  /// offset + drift * (now - start) and sometimes stamps arrivals late
+  pid_t StartNode( const double offset, const double drift, const PackedTime start, uint16_t& port )
+  {
+    int fds[2];
+    if( pipe( fds ) != 0 )
+      return -1;
+    const pid_t pid = fork();
+    if( pid != 0 )
+      {
+        close( fds[1] );
+        if( read( fds[0], &port, sizeof( port ) ) != sizeof( port ) )
+          port = 0;
+        close( fds[0] );
+        return pid;
+      }
+    close( fds[0] );
+    TimeGenerator generator( 17, static_cast<uint64_t>( getpid() ) );
+    ClockSyncServer server( 0, [&]() -> PackedTime
+                            {
+                              // Queueing on the way in, up to 200 us on a quarter of the probes
+                              PackedTime delay;
+                              generator.Uniform( -600000, 200000, &delay, 1 );
+                              if( delay > 0 )
+                                std::this_thread::sleep_for( std::chrono::nanoseconds( delay ) );
+                              const PackedTime now = ClockSyncServer::SystemClock();
+                              return now + std::llrint( offset + drift * static_cast<double>( now - start ) );
+                            } );
+    const uint16_t bound = server.GetPort();
+    if( write( fds[1], &bound, sizeof( bound ) ) != sizeof( bound ) )
+      _exit( 1 );
+    close( fds[1] );
+    server.Serve( 5000 );
+    _exit( 0 );
+  }
+}
+
+int main()
+{
+  // Made up probes, remote = local + 50 us + 20 ppm, 10 us legs with queueing on some
+  ClockOffsetEstimator estimator( 4, 16 );
+  UT_CHECK( estimator.Fit().points == 0 );
+  TimeGenerator generator( 3 );
+  for( int i = 0; i < 200; i++ )
+    {
+      PackedTime queueing[2];
+      generator.Uniform( 0, 50000, queueing, 2 );
+      if( i % 4 == 1 )
+        queueing[0] = queueing[1] = 0;
+      const PackedTime t1 = static_cast<PackedTime>( i ) * 10000000;
+      const PackedTime arrive = t1 + 10000 + queueing[0];
+      const PackedTime reply = arrive + 3000;
+      const PackedTime t4 = reply + 10000 + queueing[1];
+      const double skew = 50000.0 + 2.0e-5 * static_cast<double>( arrive );
+      UT_CHECK( estimator.Add( t1, arrive + std::llrint( skew ), reply + std::llrint( skew ), t4 ) );
+    }
+  UT_CHECK( !estimator.Add( 100, 0, 10, 50 ) ); // Negative round trip
+  UT_CHECK( estimator.GetKeptCount() == 16 );
+  const ClockCorrection fit = estimator.Fit();
+  UT_CHECK( fit.points == 16 );
+  UT_CHECK_CLOSE( fit.delay, 20000.0, 1.0 );
+  UT_CHECK_CLOSE( fit.drift, 2.0e-5, 1.0e-9 ); // Per ns of remote time, 2e-5 / (1 + 2e-5)
+  UT_CHECK_CLOSE( fit.GetOffset( 1000000000 ), 50000.0 + 2.0e-5 * 1.0e9, 3.0 );
+
+  // Bulk correction of packed times and UniversalTimeCores
+  const ClockCorrection correction = { 1000000000, 2500.0, 1.0e-6, 0.0, 1 };
+  PackedTime packed[] = { 1000000000, 2000000000, -5 };
+  correction.Apply( packed, 3 );
+  UT_CHECK( packed[0] == 1000000000 - 2500 );
+  UT_CHECK( packed[1] == 2000000000 - 3500 );
+  UT_CHECK( packed[2] == -5 - std::llrint( 2500.0 - 1.0e-6 * 1000000005.0 ) );
+  UniversalTimeCore cores[] = { UniversalTimeCore( 0, 1, 0.0 ), UniversalTimeCore( 0, 2, 0.0 ) };
+  correction.Apply( cores, 2 );
+  UT_CHECK( PackedTimes::Pack( cores[0] ) == 1000000000 - 2500 );
+  UT_CHECK( PackedTimes::Pack( cores[1] ) == 2000000000 - 3500 );
+
+  // Two nodes in their own processes, one 50 us ahead and gaining 200 ppm, one 3 ms behind and losing 100 ppm
+  const PackedTime start = ClockSyncServer::SystemClock();
+  const double offsets[] = { 50000.0, -3000000.0 };
+  const double drifts[] = { 2.0e-4, -1.0e-4 };
+  std::vector<pid_t> children;
+  QsbrDomain domain;
+  ClockSync sync( domain, ClockSyncServer::SystemClock, 8, 64 );
+  for( int node = 0; node < 2; node++ )
+    {
+      uint16_t port = 0;
+      children.push_back( StartNode( offsets[node], drifts[node], start, port ) );
+      UT_CHECK( children.back() > 0 && port != 0 );
+      UT_CHECK( sync.AddNode( "127.0.0.1", port ) == static_cast<size_t>( node ) );
+    }
+  UT_CHECK( sync.GetCorrections() == 0 );
+  size_t replies = 0;
+  for( int poll = 0; poll < 400; poll++ )
+    {
+      replies += sync.Poll( 100 );
+      std::this_thread::sleep_for( std::chrono::microseconds( 500 ) );
+    }
+  sync.Publish();
+  const size_t reader = domain.RegisterReader();
+  const ClockCorrections* table = sync.GetCorrections();
+  UT_CHECK( table != 0 && table->nodes.size() == 2 );
+  UT_CHECK( replies > 700 );
+  const PackedTime now = ClockSyncServer::SystemClock();
+  for( int node = 0; node < 2 && table != 0; node++ )
+    {
+      const ClockCorrection& measured = table->nodes[node];
+      const double expected = offsets[node] + drifts[node] * static_cast<double>( now - start );
+      PackedTime remote = now + std::llrint( expected );
+      UT_CHECK( measured.points > 40 );
+      // The offset is off by at most half the round trip asymmetry, so by half the delay,
+      // measured 1-6 us here, and the drift by the delay over the span, measured under 2e-5
+      const double tolerance = 0.5 * measured.delay + 1000.0;
+      UT_CHECK_CLOSE( measured.GetOffset( remote ), expected, tolerance );
+      UT_CHECK_CLOSE( measured.drift, drifts[node], 2.5e-5 );
+      measured.Apply( &remote, 1 );
+      UT_CHECK( std::fabs( static_cast<double>( remote - now ) ) < tolerance );
+    }
+  domain.UnregisterReader( reader );
+  for( size_t i = 0; i < children.size(); i++ )
+    {
+      kill( children[i], SIGTERM );
+      waitpid( children[i], 0, 0 );
+    }
+
+  // A client polling every ms does not keep Stop waiting past one Serve
+  {
+    ClockSyncServer server;
+    server.Start();
+    QsbrDomain busyDomain;
+    ClockSync busy( busyDomain );
+    busy.AddNode( "127.0.0.1", server.GetPort() );
+    std::atomic<bool> polling( true );
+    std::thread client( [&]()
+                        {
+                          while( polling.load() )
+                            {
+                              busy.Poll( 10 );
+                              std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+                            }
+                        } );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+    const std::chrono::steady_clock::time_point stopping = std::chrono::steady_clock::now();
+    server.Stop();
+    const double stopSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - stopping ).count();
+    polling.store( false );
+    client.join();
+    UT_CHECK( stopSeconds < 0.5 );
+    UT_CHECK( busy.GetEstimator( 0 ).GetKeptCount() > 0 );
+  }
+  return Check::Result();
+}
@@ -0,0 +1,165 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of Deduplicator against a global set of (time, ID), on
+/// a merged stream with copies, on GTID roll over, slight disorder
+/// and the table size over a long stream.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <Deduplicator.hh>
+#include <TimeGenerator.hh>
+
+#include <algorithm>
+#include <cstdlib>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  struct Event
+  {
+    PackedTime time;
+    uint32_t gtid;
+    bool copy;
+  };
+
+  bool Earlier( const Event& lhs, const Event& rhs ) { return lhs.time < rhs.time; }
+
+  uint64_t GtidOf( const Event& event ) { return event.gtid; }
+
+  /// What the global set did: drop an event if one kept has the same ID within the tolerance
+  std::vector<bool> BruteForce( const std::vector<Event>& events, const PackedTime tolerance )
+  {
+    std::set<std::pair<uint32_t, PackedTime> > seen;
+    std::vector<bool> kept( events.size() );
+    for( size_t i = 0; i < events.size(); i++ )
+      {
+        const std::set<std::pair<uint32_t, PackedTime> >::const_iterator near
+          = seen.lower_bound( std::make_pair( events[i].gtid, events[i].time - tolerance ) );
+        kept[i] = near == seen.end() || near->first != events[i].gtid || near->second > events[i].time + tolerance;
+        if( kept[i] )
+          seen.insert( std::make_pair( events[i].gtid, events[i].time ) );
+      }
+    return kept;
+  }
+}
+
+int main()
+{
+  const PackedTime kTolerance = 50;
+  const uint32_t kGtidMask = 0xFFFFFF;
+  // 200k events at 1 MHz, a fifth copied by the other tier up to the tolerance later
+  const size_t n = 200000;
+  std::vector<PackedTime> times( n );
+  TimeGenerator generator( 75 );
+  generator.Poisson( 0, 1.0e6, 100, times.data(), n );
+  std::vector<Event> events;
+  for( size_t i = 0; i < n; i++ )
+    {
+      const Event event = { times[i], static_cast<uint32_t>( i ) & kGtidMask, false };
+      events.push_back( event );
+      if( i % 5 == 0 )
+        {
+          const Event copy = { times[i] + static_cast<PackedTime>( i % ( kTolerance + 1 ) ), event.gtid, true };
+          events.push_back( copy );
+        }
+    }
+  std::stable_sort( events.begin(), events.end(), Earlier );
+
+  {
+    Deduplicator deduplicator( kTolerance );
+    const std::vector<bool> expected = BruteForce( events, kTolerance );
+    bool same = true;
+    size_t copiesKept = 0;
+    for( size_t i = 0; i < events.size(); i++ )
+      {
+        const bool kept = deduplicator.Add( events[i].time, events[i].gtid );
+        same &= kept == expected[i];
+        copiesKept += kept && events[i].copy;
+      }
+    UT_CHECK( same );
+    UT_CHECK( copiesKept == 0 && deduplicator.GetDuplicates() == events.size() - n );
+    UT_CHECK( deduplicator.GetLate() == 0 );
+    // About 0.1 events in the window, the table never grows
+    UT_CHECK( deduplicator.GetCapacity() == 64 );
+  }
+
+  // Filter compacts in place, in order
+  {
+    std::vector<Event> filtered = events;
+    Deduplicator deduplicator( kTolerance );
+    const size_t kept = deduplicator.Filter( filtered.data(), filtered.size(), GtidOf );
+    UT_CHECK( kept == n );
+    bool originals = true;
+    for( size_t i = 0; i < kept; i++ )
+      originals &= !filtered[i].copy && filtered[i].time == times[i];
+    UT_CHECK( originals );
+  }
+
+  // The same ID beyond the tolerance, or after the GTID rolls over, is a new event
+  {
+    Deduplicator deduplicator( kTolerance );
+    UT_CHECK( deduplicator.Add( 1000, 7 ) );
+    UT_CHECK( !deduplicator.Add( 1000, 7 ) );
+    UT_CHECK( !deduplicator.Add( 1000 + kTolerance, 7 ) );
+    UT_CHECK( deduplicator.Add( 1000 + kTolerance, 8 ) );
+    UT_CHECK( deduplicator.Add( 1001 + 2 * kTolerance, 7 ) );
+    UT_CHECK( deduplicator.Add( 1000 + 16777216000LL, 7 ) );
+    UT_CHECK( deduplicator.GetDuplicates() == 2 );
+    // Against the latest of the kept copies, as the global set
+    Deduplicator exact( 0 );
+    UT_CHECK( exact.Add( 5, 1 ) && !exact.Add( 5, 1 ) && exact.Add( 6, 1 ) );
+  }
+
+  // Copies arriving up to the disorder allowed behind are still found
+  {
+    const PackedTime kDisorder = 2000;
+    // Arrival order by time plus a jitter under the disorder allowed
+    std::vector<std::pair<PackedTime, size_t> > arrivals( events.size() );
+    std::srand( 75 );
+    for( size_t i = 0; i < events.size(); i++ )
+      arrivals[i] = std::make_pair( events[i].time + std::rand() % kDisorder, i );
+    std::sort( arrivals.begin(), arrivals.end() );
+    std::vector<Event> shuffled;
+    for( size_t i = 0; i < arrivals.size(); i++ )
+      shuffled.push_back( events[arrivals[i].second] );
+    Deduplicator strict( kTolerance, 0 );
+    Deduplicator disordered( kTolerance, kDisorder );
+    size_t keptStrict = 0, keptDisordered = 0;
+    for( size_t i = 0; i < shuffled.size(); i++ )
+      {
+        keptStrict += strict.Add( shuffled[i].time, shuffled[i].gtid );
+        keptDisordered += disordered.Add( shuffled[i].time, shuffled[i].gtid );
+      }
+    UT_CHECK( keptDisordered == n && disordered.GetLate() == 0 );
+    UT_CHECK( strict.GetLate() > 0 );
+  }
+
+  // Memory follows the window: 10 M events at 100 MHz through a 1 us window
+  {
+    Deduplicator deduplicator( 1000 );
+    PackedTime time = 0;
+    size_t maxCapacity = 0;
+    for( uint64_t i = 0; i < 10000000; i++ )
+      {
+        time += 10;
+        deduplicator.Add( time, i );
+        if( i % 4096 == 0 )
+          maxCapacity = std::max( maxCapacity, deduplicator.GetCapacity() );
+      }
+    // About 100 live entries, a quarter full after rebuilds
+    UT_CHECK( maxCapacity <= 1024 && deduplicator.GetDuplicates() == 0 );
+    // A burst grows the table, which shrinks back once the burst has passed
+    for( uint64_t i = 0; i < 100000; i++ )
+      deduplicator.Add( time, i );
+    UT_CHECK( deduplicator.GetCapacity() >= 262144 );
+    for( uint64_t i = 0; i < 300000; i++ )
+      {
+        time += 10;
+        deduplicator.Add( time, 20000000 + i );
+      }
+    UT_CHECK( deduplicator.GetCapacity() <= 1024 );
+    UT_CHECK( deduplicator.GetDuplicates() == 0 );
+  }
+  return Check::Result();
+}
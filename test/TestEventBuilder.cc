@@ -0,0 +1,192 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of EventBuilder and SpscQueue.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <EventBuilder.hh>
+#include <SpscQueue.hh>
+#include <TimeGenerator.hh>
+
+#include <chrono>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  const unsigned kCrates = 19;
+  const PackedTime kTolerance = 50;
+
+  /// Collects released events
+  struct Collector
+  {
+    std::vector<EventBuilder::Event>* events;
+    void operator()( const EventBuilder::Event& event ) const { events->push_back( event ); }
+  };
+
+  /// Trigger times, 1 MHz with a 200 ns dead time, and per crate clock offsets within the tolerance
+  std::vector<PackedTime> MakeTriggers( const size_t count )
+  {
+    TimeGenerator generator( 3 );
+    std::vector<PackedTime> triggers( count );
+    generator.Poisson( 1000000, 1.0e6, 200, triggers.data(), count );
+    return triggers;
+  }
+
+  EventBuilder::Fragment MakeFragment( const std::vector<PackedTime>& triggers, const size_t trigger, const uint32_t crate )
+  {
+    // GTIDs start just before the rollover, clocks disagree by up to +-kTolerance / 2
+    const PackedTime offset = static_cast<PackedTime>( ( crate * 7 + trigger * 13 ) % kTolerance ) - kTolerance / 2;
+    const EventBuilder::Fragment fragment = { triggers[trigger] + offset,
+                                              static_cast<uint32_t>( ( 0xFFFF00 + trigger ) & EventBuilder::kGtidMask ),
+                                              crate, trigger * 100 + crate };
+    return fragment;
+  }
+
+  /// Check events are complete, in time order, with consecutive unwrapped GTIDs and the right payloads
+  void CheckEvents( const std::vector<EventBuilder::Event>& events, const size_t count )
+  {
+    UT_CHECK( events.size() == count );
+    bool good = true;
+    for( size_t i = 0; i < events.size(); i++ )
+      {
+        const EventBuilder::Event& event = events[i];
+        good = good && event.GetCount() == kCrates && event.gtid == static_cast<int64_t>( 0xFFFF00 + i );
+        good = good && ( i == 0 || events[i - 1].time <= event.time );
+        for( uint32_t crate = 0; crate < kCrates; crate++ )
+          good = good && event.fragments[crate].payload == i * 100 + crate && event.fragments[crate].crate == crate;
+      }
+    UT_CHECK( good );
+  }
+}
+
+int main()
+{
+  // SpscQueue across threads keeps every item in order
+  {
+    SpscQueue<uint64_t> queue( 1024 );
+    const uint64_t count = 200000;
+    std::thread producer( [&queue, count]()
+                          {
+                            for( uint64_t i = 0; i < count; )
+                              if( queue.Push( i ) )
+                                i++;
+                              else
+                                std::this_thread::yield();
+                          } );
+    uint64_t expected = 0;
+    bool ordered = true;
+    while( expected < count )
+      {
+        uint64_t item;
+        if( queue.Pop( item ) )
+          ordered = ordered && item == expected++;
+        else
+          std::this_thread::yield();
+      }
+    producer.join();
+    UT_CHECK( ordered );
+    UT_CHECK( queue.GetSize() == 0 );
+    bool threw = false;
+    try
+      {
+        SpscQueue<int> bad( 10 );
+      }
+    catch( const std::invalid_argument& )
+      {
+        threw = true;
+      }
+    UT_CHECK( threw );
+  }
+
+  const size_t nTriggers = 5000;
+  const std::vector<PackedTime> triggers = MakeTriggers( nTriggers );
+
+  // Single thread, crates interleaved in blocks, across the GTID rollover
+  {
+    EventBuilder builder( kCrates, kTolerance, 60.0 );
+    std::vector<EventBuilder::Event> events;
+    const Collector collector = { &events };
+    for( size_t first = 0; first < nTriggers; first += 100 )
+      {
+        for( uint32_t crate = 0; crate < kCrates; crate++ )
+          for( size_t trigger = first; trigger < first + 100 && trigger < nTriggers; trigger++ )
+            UT_CHECK( builder.Push( MakeFragment( triggers, trigger, crate ) ) );
+        builder.Process( collector );
+      }
+    UT_CHECK( events.size() < nTriggers ); // The newest events wait for the watermark
+    builder.Flush( collector );
+    CheckEvents( events, nTriggers );
+    UT_CHECK( builder.GetBuilt() == nTriggers );
+    UT_CHECK( builder.GetPartial() == 0 );
+    UT_CHECK( builder.GetLate() == 0 );
+    UT_CHECK( builder.GetMismatched() == 0 );
+  }
+
+  // A missing fragment gives a partial event, a dead crate cannot stall the builder
+  {
+    EventBuilder builder( kCrates, kTolerance, 0.05 );
+    std::vector<EventBuilder::Event> events;
+    const Collector collector = { &events };
+    for( size_t trigger = 0; trigger < 1000; trigger++ )
+      for( uint32_t crate = 0; crate < kCrates; crate++ )
+        {
+          const bool dead = crate == 5 && trigger >= 500;
+          if( !( crate == 3 && trigger == 10 ) && !dead )
+            builder.Push( MakeFragment( triggers, trigger, crate ) );
+        }
+    builder.Process( collector );
+    UT_CHECK( events.size() == 499 ); // Waiting for crate 5
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+    builder.Process( collector );
+    UT_CHECK( events.size() == 999 ); // Crate 5 timed out, the newest event still waits
+    UT_CHECK( events[10].GetCount() == kCrates - 1 && ( events[10].crateMask & ( 1u << 3 ) ) == 0 );
+    // Crate 5 comes back with old data, which is late
+    builder.Push( MakeFragment( triggers, 600, 5 ) );
+    builder.Flush( collector );
+    UT_CHECK( events.size() == 1000 );
+    UT_CHECK( builder.GetPartial() == 501 );
+    UT_CHECK( builder.GetLate() == 1 );
+  }
+
+  // Same GTID outside the tolerance is another event, another GTID inside it is counted
+  {
+    EventBuilder builder( 2, kTolerance, 60.0 );
+    std::vector<EventBuilder::Event> events;
+    const Collector collector = { &events };
+    const EventBuilder::Fragment fragments[] = { { 1000, 7, 0, 0 }, { 1000 + kTolerance + 1, 7, 1, 1 },
+                                                 { 5000, 8, 0, 2 }, { 5010, 9, 1, 3 } };
+    for( size_t i = 0; i < 4; i++ )
+      builder.Push( fragments[i] );
+    builder.Flush( collector );
+    UT_CHECK( events.size() == 4 );
+    UT_CHECK( builder.GetMismatched() == 1 );
+    UT_CHECK( builder.GetPartial() == 4 );
+  }
+
+  // A producer thread per crate and the builder thread
+  {
+    EventBuilder builder( kCrates, kTolerance, 60.0, 1024 );
+    std::vector<EventBuilder::Event> events;
+    const Collector collector = { &events };
+    builder.Start( collector );
+    std::vector<std::thread> producers;
+    for( uint32_t crate = 0; crate < kCrates; crate++ )
+      producers.emplace_back( [&builder, &triggers, crate]()
+                              {
+                                for( size_t trigger = 0; trigger < nTriggers; )
+                                  if( builder.Push( MakeFragment( triggers, trigger, crate ) ) )
+                                    trigger++;
+                                  else
+                                    std::this_thread::yield();
+                              } );
+    for( size_t i = 0; i < producers.size(); i++ )
+      producers[i].join();
+    // Monitoring reads the counters while the builder thread runs
+    UT_CHECK( builder.GetBuilt() <= nTriggers && builder.GetPartial() <= builder.GetBuilt() );
+    builder.Stop();
+    CheckEvents( events, nTriggers );
+    UT_CHECK( builder.GetLate() == 0 );
+  }
+  return Check::Result();
+}
@@ -0,0 +1,41 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of EventClusterer against a scalar reference.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <EventClusterer.hh>
+#include <TimeGenerator.hh>
+
+#include <vector>
+
+int main()
+{
+  UT_CHECK( EventClusterer( 10 ).Cluster( 0, 0 ).empty() );
+  const PackedTime single[] = { 5 };
+  UT_CHECK( EventClusterer( 10 ).Cluster( single, 1 ) == std::vector<EventClusterer::Range>( 1, EventClusterer::Range( 0, 1 ) ) );
+
+  // Gap equal to the limit stays in the event, one more starts a new one
+  const PackedTime hits[] = { 0, 10, 20, 31, 32, 100 };
+  const std::vector<EventClusterer::Range> events = EventClusterer( 10 ).Cluster( hits, 6 );
+  UT_CHECK( events.size() == 3 );
+  UT_CHECK( events[0] == EventClusterer::Range( 0, 3 ) );
+  UT_CHECK( events[1] == EventClusterer::Range( 3, 5 ) );
+  UT_CHECK( events[2] == EventClusterer::Range( 5, 6 ) );
+
+  // Several chunks give the same events as one, including events spanning chunk edges
+  std::vector<PackedTime> times( 300007 );
+  TimeGenerator generator( 3 );
+  generator.Poisson( -1000000, 2.0e6, 0, times.data(), times.size() );
+  std::vector<EventClusterer::Range> reference;
+  size_t begin = 0;
+  for( size_t i = 1; i < times.size(); i++ )
+    if( times[i] - times[i - 1] > 1000 )
+      {
+        reference.push_back( EventClusterer::Range( begin, i ) );
+        begin = i;
+      }
+  reference.push_back( EventClusterer::Range( begin, times.size() ) );
+  UT_CHECK( EventClusterer( 1000, 1 ).Cluster( times.data(), times.size() ) == reference );
+  UT_CHECK( EventClusterer( 1000, 4 ).Cluster( times.data(), times.size() ) == reference );
+  return Check::Result();
+}
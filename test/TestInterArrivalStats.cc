@@ -0,0 +1,155 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of InterArrivalStats, KllSketch and LogHistogram.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <InterArrivalStats.hh>
+#include <TimeGenerator.hh>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+int main()
+{
+  UT_CHECK( LogHistogram::GetBin( 0 ) == 0 );
+  UT_CHECK( LogHistogram::GetBin( -5 ) == 0 );
+  for( int64_t gap = 1; gap < 100000; gap = gap * 3 + 1 )
+    {
+      const size_t bin = LogHistogram::GetBin( gap );
+      UT_CHECK( LogHistogram::GetBinLowEdge( bin ) <= gap );
+      UT_CHECK( LogHistogram::GetBinLowEdge( bin + 1 ) > gap || LogHistogram::GetBinLowEdge( bin + 1 ) == LogHistogram::GetBinLowEdge( bin ) );
+    }
+
+  std::vector<PackedTime> times( 400000 );
+  TimeGenerator generator( 9 );
+  generator.Poisson( 0, 1.0e5, 50, times.data(), times.size() );
+  const size_t half = times.size() / 2;
+
+  // Two streams merged (one serialised as if from another node) match one stream
+  InterArrivalStats all;
+  all.Fill( times.data(), times.size() );
+  InterArrivalStats first( 200, 1 ), second( 200, 2 );
+  first.Fill( times.data(), half );
+  second.Fill( times.data() + half, times.size() - half );
+  std::vector<char> buffer;
+  second.Serialise( buffer );
+  InterArrivalStats remote;
+  UT_CHECK( remote.Deserialise( buffer.data(), buffer.size() ) == buffer.size() );
+  first.Merge( remote );
+  UT_CHECK( first.GetCount() == all.GetCount() - 1 ); // The gap across the split is in neither stream
+  UT_CHECK_CLOSE( first.GetMean(), all.GetMean(), 1.0e-3 * all.GetMean() );
+  UT_CHECK_CLOSE( first.GetVariance(), all.GetVariance(), 1.0e-3 * all.GetVariance() );
+
+  // Quantiles within the sketch's rank error, memory stays bounded
+  std::vector<int64_t> gaps;
+  for( size_t i = 1; i < times.size(); i++ )
+    gaps.push_back( times[i] - times[i - 1] );
+  std::sort( gaps.begin(), gaps.end() );
+  const double fractions[] = { 0.01, 0.25, 0.5, 0.9, 0.99 };
+  for( size_t i = 0; i < 5; i++ )
+    {
+      const double rank = std::lower_bound( gaps.begin(), gaps.end(), first.GetQuantile( fractions[i] ) ) - gaps.begin();
+      UT_CHECK_CLOSE( rank / gaps.size(), fractions[i], 0.02 );
+    }
+  UT_CHECK( first.GetSketch().GetRetained() < 1000 );
+  UT_CHECK( first.GetSketch().GetMinimum() >= 50 );
+  uint64_t entries = 0;
+  for( size_t bin = 0; bin < LogHistogram::kBins; bin++ )
+    entries += first.GetHistogram().GetBinContent( bin );
+  UT_CHECK( entries == first.GetCount() );
+
+  // A sketch of another k is refused before anything is merged
+  {
+    InterArrivalStats coarse( 50 );
+    coarse.Fill( times.data(), 1000 );
+    const uint64_t count = first.GetCount();
+    const double mean = first.GetMean();
+    bool threw = false;
+    try
+      {
+        first.Merge( coarse );
+      }
+    catch( const std::invalid_argument& )
+      {
+        threw = true;
+      }
+    UT_CHECK( threw && first.GetCount() == count && first.GetMean() == mean );
+  }
+
+  // Corrupt sketches are refused: k below the minimum, more levels than the buffer holds
+  {
+    std::vector<char> sketch;
+    KllSketch().Serialise( sketch );
+    std::vector<char> corrupt = sketch;
+    const uint32_t badK = 3;
+    std::memcpy( corrupt.data(), &badK, sizeof( badK ) );
+    KllSketch restored;
+    bool threw = false;
+    try
+      {
+        restored.Deserialise( corrupt.data(), corrupt.size() );
+      }
+    catch( const std::invalid_argument& )
+      {
+        threw = true;
+      }
+    UT_CHECK( threw );
+    corrupt = sketch;
+    const uint32_t levels = 0xFFFFFFFF;
+    std::memcpy( corrupt.data() + sketch.size() - 2 * sizeof( uint32_t ), &levels, sizeof( levels ) );
+    threw = false;
+    try
+      {
+        restored.Deserialise( corrupt.data(), corrupt.size() );
+      }
+    catch( const std::length_error& )
+      {
+        threw = true;
+      }
+    UT_CHECK( threw );
+    UT_CHECK( restored.Deserialise( sketch.data(), sketch.size() ) == sketch.size() && restored.GetCount() == 0 );
+  }
+
+  // A truncated buffer leaves what it was read into unchanged
+  {
+    InterArrivalStats stats;
+    stats.Fill( times.data(), 1000 );
+    std::vector<char> before;
+    stats.Serialise( before );
+    bool threw = false;
+    try
+      {
+        stats.Deserialise( buffer.data(), buffer.size() - sizeof( int64_t ) );
+      }
+    catch( const std::length_error& )
+      {
+        threw = true;
+      }
+    std::vector<char> after;
+    stats.Serialise( after );
+    UT_CHECK( threw && after == before );
+    KllSketch sketch, other( 200, 2 );
+    for( size_t i = 0; i < 1000; i++ )
+      {
+        sketch.Fill( times[i] );
+        other.Fill( times[i + 1000] );
+      }
+    std::vector<char> sketchBefore, sketchAfter, truncated;
+    sketch.Serialise( sketchBefore );
+    other.Serialise( truncated );
+    threw = false;
+    try
+      {
+        sketch.Deserialise( truncated.data(), truncated.size() - sizeof( int64_t ) );
+      }
+    catch( const std::length_error& )
+      {
+        threw = true;
+      }
+    sketch.Serialise( sketchAfter );
+    UT_CHECK( threw && sketchAfter == sketchBefore );
+  }
+  return Check::Result();
+}
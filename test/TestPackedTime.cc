@@ -0,0 +1,31 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of the packed time conversions.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <PackedTime.hh>
+
+int main()
+{
+  UT_CHECK( PackedTimes::Pack( 0, 0, 0.0 ) == 0 );
+  UT_CHECK( PackedTimes::Pack( 1, 1, 1.0 ) == PackedTimes::kNanoSecondsPerDay + PackedTimes::kNanoSecondsPerSecond + 1 );
+  UT_CHECK( PackedTimes::Pack( 0, 0, 0.6 ) == 1 ); // Rounds to the nearest ns
+  UT_CHECK( PackedTimes::Pack( 0, 0, -0.6 ) == -1 );
+
+  // Unpack uses floor division, only days carries the sign
+  int32_t days = 0, seconds = 0;
+  double nanoSeconds = 0.0;
+  PackedTimes::Unpack( -1, days, seconds, nanoSeconds );
+  UT_CHECK( days == -1 );
+  UT_CHECK( seconds == 86399 );
+  UT_CHECK( nanoSeconds == 999999999.0 );
+  const PackedTime time = PackedTimes::Pack( 4000, 12345, 678.0 );
+  PackedTimes::Unpack( time, days, seconds, nanoSeconds );
+  UT_CHECK( days == 4000 && seconds == 12345 && nanoSeconds == 678.0 );
+  UT_CHECK( PackedTimes::Pack( days, seconds, nanoSeconds ) == time );
+
+  UT_CHECK( PackedTimes::FloorDivide( 7, 2 ) == 3 );
+  UT_CHECK( PackedTimes::FloorDivide( -7, 2 ) == -4 );
+  UT_CHECK( PackedTimes::FloorDivide( -8, 2 ) == -4 );
+  return Check::Result();
+}
@@ -0,0 +1,189 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of PartitionedWriter and its manifest against the
+/// events written, read back whole and by time range.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <PartitionedWriter.hh>
+#include <TimeGenerator.hh>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+  struct Hit
+  {
+    PackedTime time;
+    uint64_t id;
+    double charge;
+  };
+
+  /// Events of a range, in time order then id order
+  std::vector<Hit> Expected( const std::vector<Hit>& hits, const PackedTime begin, const PackedTime end )
+  {
+    std::vector<Hit> expected;
+    for( size_t i = 0; i < hits.size(); i++ )
+      if( hits[i].time >= begin && hits[i].time < end )
+        expected.push_back( hits[i] );
+    std::stable_sort( expected.begin(), expected.end(), []( const Hit& lhs, const Hit& rhs ) { return lhs.time < rhs.time; } );
+    return expected;
+  }
+
+  bool Same( const std::vector<Hit>& lhs, const std::vector<Hit>& rhs )
+  {
+    if( lhs.size() != rhs.size() )
+      return false;
+    for( size_t i = 0; i < lhs.size(); i++ )
+      if( lhs[i].time != rhs[i].time || lhs[i].id != rhs[i].id || lhs[i].charge != rhs[i].charge )
+        return false;
+    return true;
+  }
+}
+
+int main()
+{
+  char directory[] = "/tmp/TestPartitionedWriterXXXXXX";
+  if( mkdtemp( directory ) == 0 )
+    return 1;
+  const PackedTime hour = PartitionedWriter<Hit>::kHour;
+  // Five hours from an hour before t0, arriving in no particular order, ties included
+  std::vector<PackedTime> times( 50000 );
+  TimeGenerator generator( 6 );
+  generator.Uniform( -hour, 4 * hour, times.data(), times.size() );
+  for( size_t i = 1; i < times.size(); i += 101 )
+    times[i] = times[i - 1];
+  times[7] = 0;
+  times[8] = -1;
+  std::vector<Hit> hits( times.size() );
+  for( size_t i = 0; i < hits.size(); i++ )
+    {
+      hits[i].time = times[i];
+      hits[i].id = i;
+      hits[i].charge = 0.5 * static_cast<double>( i );
+    }
+
+  {
+    PartitionedWriter<Hit> writer( directory, hour, 3, 1000 );
+    writer.Add( hits.data(), hits.size() / 2 );
+    writer.Flush();
+    // Several chunks per hour, each sorted and within its hour, readable already
+    const PartitionManifest chunked = writer.GetManifest();
+    UT_CHECK( chunked.entries.size() > 5 );
+    uint64_t total = 0;
+    for( size_t i = 0; i < chunked.entries.size(); i++ )
+      {
+        const PartitionManifest::Entry& entry = chunked.entries[i];
+        total += entry.count;
+        UT_CHECK( entry.first <= entry.last );
+        UT_CHECK( PackedTimes::FloorDivide( entry.first, hour ) == entry.partition );
+        UT_CHECK( PackedTimes::FloorDivide( entry.last, hour ) == entry.partition );
+      }
+    UT_CHECK( total == hits.size() / 2 );
+    std::vector<Hit> read;
+    PartitionedWriter<Hit>::ReadRange( directory, -hour, 4 * hour, read );
+    UT_CHECK( Same( read, Expected( std::vector<Hit>( hits.begin(), hits.begin() + hits.size() / 2 ), -hour, 4 * hour ) ) );
+    writer.Add( hits.data() + hits.size() / 2, hits.size() - hits.size() / 2 );
+    writer.Close();
+    writer.Close();
+  }
+
+  // One merged file per hour after Close, partitions -1 to 3
+  const PartitionManifest manifest = PartitionManifest::Load( directory );
+  UT_CHECK( manifest.GetWidth() == hour && manifest.GetRecordSize() == sizeof( Hit ) );
+  UT_CHECK( manifest.entries.size() == 5 );
+  for( size_t i = 0; i < manifest.entries.size(); i++ )
+    {
+      const PartitionManifest::Entry& entry = manifest.entries[i];
+      UT_CHECK( entry.partition == static_cast<int64_t>( i ) - 1 );
+      UT_CHECK( entry.file == "part_" + std::to_string( entry.partition ) + ".dat" );
+      const std::vector<Hit> expected = Expected( hits, entry.partition * hour, ( entry.partition + 1 ) * hour );
+      UT_CHECK( entry.count == expected.size() );
+      UT_CHECK( entry.first == expected.front().time && entry.last == expected.back().time );
+      std::vector<Hit> read;
+      UT_CHECK( PartitionedWriter<Hit>::ReadRange( directory, entry.partition * hour, ( entry.partition + 1 ) * hour, read ) == 1 );
+      UT_CHECK( Same( read, expected ) ); // Merging keeps arrival order of ties
+    }
+  UT_CHECK( manifest.Select( hour / 2, hour / 2 + 1 ).size() == 1 );
+  UT_CHECK( manifest.Select( -1, 1 ).size() == 2 );
+  UT_CHECK( manifest.Select( 10 * hour, 11 * hour ).empty() );
+
+  // A range over an hour boundary reads just the two files it touches
+  std::vector<Hit> read;
+  const PackedTime begin = 2 * hour - 1234567890;
+  const PackedTime end = 3 * hour - 987654321;
+  UT_CHECK( PartitionedWriter<Hit>::ReadRange( directory, begin, end, read ) == 2 );
+  UT_CHECK( Same( read, Expected( hits, begin, end ) ) );
+
+  // A second inside one file, starting and ending on event times, reads only its slice
+  const std::vector<Hit> middle = Expected( hits, hour + hour / 2, 2 * hour );
+  UT_CHECK( middle.size() > 2 );
+  const PackedTime second = PackedTimes::kNanoSecondsPerSecond;
+  const std::vector<Hit> expected = Expected( hits, middle.front().time, middle.front().time + second );
+  read.clear();
+  UT_CHECK( PartitionedWriter<Hit>::ReadRange( directory, middle.front().time, middle.front().time + second, read ) == 1 );
+  UT_CHECK( Same( read, expected ) );
+  read.clear();
+  PartitionedWriter<Hit>::ReadRange( directory, middle.front().time, middle.back().time, read );
+  UT_CHECK( Same( read, Expected( hits, middle.front().time, middle.back().time ) ) );
+
+  bool threw = false;
+  try
+    {
+      PartitionedWriter<Hit> missing( std::string( directory ) + "/missing", hour, 2, 10 );
+      missing.Add( hits.data(), 10 );
+      missing.Flush();
+    }
+  catch( const std::runtime_error& )
+    {
+      threw = true;
+    }
+  UT_CHECK( threw );
+  threw = false;
+  try
+    {
+      PartitionManifest::Load( std::string( directory ) + "/missing" );
+    }
+  catch( const std::runtime_error& )
+    {
+      threw = true;
+    }
+  UT_CHECK( threw );
+
+  // A chunk cut short before its merge fails the merge, which keeps the chunks
+  {
+    const std::string shortened = std::string( directory ) + "/shortened";
+    UT_CHECK( mkdir( shortened.c_str(), 0700 ) == 0 );
+    PartitionedWriter<Hit> writer( shortened, hour, 1, 1000 );
+    writer.Add( hits.data(), 5000 );
+    writer.Flush();
+    const PartitionManifest chunked = writer.GetManifest();
+    UT_CHECK( truncate( ( shortened + "/" + chunked.entries[0].file ).c_str(), sizeof( Hit ) ) == 0 );
+    threw = false;
+    try
+      {
+        writer.Close();
+      }
+    catch( const std::runtime_error& )
+      {
+        threw = true;
+      }
+    UT_CHECK( threw );
+    const PartitionManifest kept = PartitionManifest::Load( shortened );
+    UT_CHECK( kept.entries.size() == chunked.entries.size() );
+    for( size_t i = 0; i < kept.entries.size(); i++ )
+      UT_CHECK( std::remove( ( shortened + "/" + kept.entries[i].file ).c_str() ) == 0 );
+    std::remove( ( shortened + "/manifest.txt" ).c_str() );
+    UT_CHECK( rmdir( shortened.c_str() ) == 0 );
+  }
+
+  for( size_t i = 0; i < manifest.entries.size(); i++ )
+    std::remove( ( std::string( directory ) + "/" + manifest.entries[i].file ).c_str() );
+  std::remove( ( std::string( directory ) + "/manifest.txt" ).c_str() );
+  UT_CHECK( rmdir( directory ) == 0 );
+  return Check::Result();
+}
@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of PeriodicitySearch against direct sums.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <PeriodicitySearch.hh>
+#include <TimeGenerator.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+int main()
+{
+  for( double x = -0.5; x <= 0.5; x += 1.0e-3 )
+    {
+      double sine, cosine;
+      PeriodicitySearch::SinCos( x, sine, cosine );
+      UT_CHECK_CLOSE( sine, std::sin( 2.0 * M_PI * x ), 1.0e-8 );
+      UT_CHECK_CLOSE( cosine, std::cos( 2.0 * M_PI * x ), 1.0e-8 );
+    }
+
+  // Events 10 years after t0, phases must still be exact
+  const PackedTime reference = 3650 * PackedTimes::kNanoSecondsPerDay;
+  std::vector<PackedTime> times( 20000 );
+  TimeGenerator generator( 2 );
+  generator.Uniform( reference, reference + 30 * PackedTimes::kNanoSecondsPerDay, times.data(), times.size() );
+  const double frequencies[] = { 1.0e-5, 0.37, 1234.5678 };
+  double powers[3];
+  PeriodicitySearch search( reference, 2 );
+  search.SetTimes( times.data(), times.size() );
+  search.Rayleigh( frequencies, 3, powers );
+  for( size_t f = 0; f < 3; f++ )
+    {
+      double sumSin = 0.0, sumCos = 0.0;
+      for( size_t i = 0; i < times.size(); i++ )
+        {
+          // Exact phase: whole seconds and ns handled separately
+          const int64_t offset = times[i] - reference;
+          const double cycles = std::fmod( frequencies[f] * ( offset / PackedTimes::kNanoSecondsPerSecond ), 1.0 )
+            + frequencies[f] * ( offset % PackedTimes::kNanoSecondsPerSecond ) * 1.0e-9;
+          sumSin += std::sin( 2.0 * M_PI * cycles );
+          sumCos += std::cos( 2.0 * M_PI * cycles );
+        }
+      const double direct = 2.0 / times.size() * ( sumSin * sumSin + sumCos * sumCos );
+      UT_CHECK_CLOSE( powers[f], direct, 1.0e-3 * std::max( direct, 1.0 ) );
+    }
+
+  // Lomb-Scargle peaks at an injected sinusoid
+  std::vector<PackedTime> samples( 2000 );
+  generator.Uniform( reference, reference + 1000 * PackedTimes::kNanoSecondsPerSecond, samples.data(), samples.size() );
+  std::vector<double> values( samples.size() );
+  for( size_t i = 0; i < samples.size(); i++ )
+    values[i] = std::sin( 2.0 * M_PI * 0.05 * ( samples[i] - reference ) * 1.0e-9 ) + 0.1 * ( i % 5 );
+  PeriodicitySearch periodogram( reference );
+  periodogram.SetTimes( samples.data(), samples.size() );
+  std::vector<double> lsFrequencies, lsPowers;
+  periodogram.LombScargle( values.data(), 4.0, 1000, lsFrequencies, lsPowers );
+  const size_t peak = std::max_element( lsPowers.begin(), lsPowers.end() ) - lsPowers.begin();
+  UT_CHECK_CLOSE( lsFrequencies[peak], 0.05, 5.0e-4 );
+
+  // Events all at one time have no span to take frequencies from
+  const std::vector<PackedTime> together( 10, reference );
+  periodogram.SetTimes( together.data(), together.size() );
+  bool threw = false;
+  try
+    {
+      periodogram.LombScargle( values.data(), 4.0, 100, lsFrequencies, lsPowers );
+    }
+  catch( const std::invalid_argument& )
+    {
+      threw = true;
+    }
+  UT_CHECK( threw );
+  return Check::Result();
+}
@@ -0,0 +1,177 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of TimeIntervalTable, and of RcuPointer and QsbrDomain
+/// publishing tables to reader threads.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <QsbrDomain.hh>
+#include <RcuPointer.hh>
+#include <TimeIntervalTable.hh>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  std::atomic<int> gAlive( 0 ); ///< Versions not yet deleted
+
+  /// A table version that poisons itself when deleted
+  struct Version
+  {
+    Version( const int number_, std::vector<TimeIntervalTable<int>::Interval> intervals )
+      : number(number_), table(intervals), valid(true) { gAlive++; }
+    ~Version() { valid = false; gAlive--; }
+
+    int number;
+    TimeIntervalTable<int> table;
+    volatile bool valid;
+  };
+
+  /// Version n maps [0, 1000) to n and [2000, 3000) to -n
+  std::unique_ptr<const Version> MakeVersion( const int number )
+  {
+    std::vector<TimeIntervalTable<int>::Interval> intervals;
+    const TimeIntervalTable<int>::Interval second = { 2000, 3000, -number };
+    const TimeIntervalTable<int>::Interval first = { 0, 1000, number };
+    intervals.push_back( second );
+    intervals.push_back( first );
+    return std::unique_ptr<const Version>( new Version( number, intervals ) );
+  }
+}
+
+int main()
+{
+  // Lookups, unsorted input and the edges of each interval
+  const std::unique_ptr<const Version> version = MakeVersion( 7 );
+  const TimeIntervalTable<int>& table = version->table;
+  UT_CHECK( table.GetSize() == 2 );
+  UT_CHECK( table.Find( -1 ) == 0 );
+  UT_CHECK( table.Find( 0 ) != 0 && *table.Find( 0 ) == 7 );
+  UT_CHECK( *table.Find( 999 ) == 7 );
+  UT_CHECK( table.Find( 1000 ) == 0 && table.Find( 1999 ) == 0 );
+  UT_CHECK( *table.Find( 2000 ) == -7 && *table.Find( 2999 ) == -7 );
+  UT_CHECK( table.Find( 3000 ) == 0 );
+  const std::vector<TimeIntervalTable<int>::Interval> none;
+  const TimeIntervalTable<int> empty( none );
+  UT_CHECK( empty.Find( 0 ) == 0 );
+
+  bool threw = false;
+  try
+    {
+      std::vector<TimeIntervalTable<int>::Interval> overlapping( 2 );
+      overlapping[0].begin = 0; overlapping[0].end = 10;
+      overlapping[1].begin = 9; overlapping[1].end = 20;
+      TimeIntervalTable<int> bad( overlapping );
+    }
+  catch( const std::invalid_argument& )
+    {
+      threw = true;
+    }
+  UT_CHECK( threw );
+  threw = false;
+  try
+    {
+      std::vector<TimeIntervalTable<int>::Interval> reversed( 1 );
+      reversed[0].begin = 10; reversed[0].end = 10;
+      TimeIntervalTable<int> bad( reversed );
+    }
+  catch( const std::invalid_argument& )
+    {
+      threw = true;
+    }
+  UT_CHECK( threw );
+
+  // An online reader holds back reclamation until it is quiescent, an offline one does not
+  {
+    QsbrDomain domain( 2 );
+    RcuPointer<Version> pointer( domain );
+    UT_CHECK( pointer.Get() == 0 );
+    const size_t reader = domain.RegisterReader();
+    pointer.Publish( MakeVersion( 1 ) );
+    const Version* seen = pointer.Get();
+    UT_CHECK( seen->number == 1 );
+    pointer.Publish( MakeVersion( 2 ) );
+    UT_CHECK( pointer.GetRetiredCount() == 1 && seen->valid );
+    UT_CHECK( pointer.Reclaim() == 1 );
+    domain.Quiescent( reader );
+    UT_CHECK( pointer.Reclaim() == 0 );
+    UT_CHECK( gAlive == 2 ); // The table above and version 2
+    UT_CHECK( pointer.Get()->number == 2 );
+
+    domain.Offline( reader );
+    pointer.Publish( MakeVersion( 3 ) );
+    UT_CHECK( pointer.GetRetiredCount() == 0 );
+    domain.Online( reader );
+    pointer.Publish( MakeVersion( 4 ) );
+    UT_CHECK( pointer.GetRetiredCount() == 1 );
+    domain.UnregisterReader( reader );
+    UT_CHECK( pointer.Reclaim() == 0 );
+
+    UT_CHECK( domain.RegisterReader() == 0 );
+    UT_CHECK( domain.RegisterReader() == 1 );
+    threw = false;
+    try
+      {
+        domain.RegisterReader();
+      }
+    catch( const std::length_error& )
+      {
+        threw = true;
+      }
+    UT_CHECK( threw );
+  }
+  UT_CHECK( gAlive == 1 );
+
+  // Readers never see a deleted or mixed version while a writer publishes
+  {
+    QsbrDomain domain;
+    RcuPointer<Version> pointer( domain, MakeVersion( 0 ) );
+    const int nVersions = 2000;
+    std::atomic<bool> done( false );
+    std::atomic<size_t> bad( 0 );
+    std::atomic<size_t> lookups( 0 );
+    std::vector<std::thread> readers;
+    for( int r = 0; r < 3; r++ )
+      readers.emplace_back( [&]()
+                            {
+                              const size_t reader = domain.RegisterReader();
+                              size_t count = 0;
+                              int last = 0;
+                              while( !done.load( std::memory_order_acquire ) )
+                                {
+                                  for( int i = 0; i < 64; i++ )
+                                    {
+                                      const Version* current = pointer.Get();
+                                      const int* first = current->table.Find( i );
+                                      const int* second = current->table.Find( 2000 + i );
+                                      bad += !current->valid || *first != current->number || *second != -current->number
+                                        || current->number < last;
+                                      last = current->number;
+                                      count++;
+                                    }
+                                  domain.Quiescent( reader );
+                                  std::this_thread::yield();
+                                }
+                              domain.UnregisterReader( reader );
+                              lookups += count;
+                            } );
+    for( int n = 1; n <= nVersions; n++ )
+      {
+        pointer.Publish( MakeVersion( n ) );
+        if( n % 16 == 0 )
+          std::this_thread::yield();
+      }
+    pointer.Synchronize();
+    UT_CHECK( pointer.GetRetiredCount() == 0 );
+    done.store( true, std::memory_order_release );
+    for( size_t r = 0; r < readers.size(); r++ )
+      readers[r].join();
+    UT_CHECK( bad == 0 );
+    UT_CHECK( lookups > 0 );
+    UT_CHECK( gAlive == 2 );
+  }
+  UT_CHECK( gAlive == 1 );
+  return Check::Result();
+}
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of the UniversalTimeCore overflow policies.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <PackedTime.hh>
+#include <UniversalTimeCore.hh>
+
+#include <limits>
+#include <stdexcept>
+
+typedef BasicUniversalTimeCore<CheckedArithmetic> CheckedTime;
+typedef BasicUniversalTimeCore<SaturatingArithmetic> SaturatingTime;
+
+namespace
+{
+  bool Throws( const int32_t days, const int32_t seconds, const double nanoSeconds )
+  {
+    try
+      {
+        CheckedTime( days, seconds, nanoSeconds );
+      }
+    catch( const std::overflow_error& )
+      {
+        return true;
+      }
+    return false;
+  }
+}
+
+int main()
+{
+  const int32_t maxDays = std::numeric_limits<int32_t>::max();
+  const int32_t minDays = std::numeric_limits<int32_t>::min();
+
+  // In range times are the same under every policy
+  const UniversalTimeCore plain( 3, -100000, -2.5e9 );
+  const CheckedTime checked( 3, -100000, -2.5e9 );
+  const SaturatingTime saturating( 3, -100000, -2.5e9 );
+  UT_CHECK( PackedTimes::Pack( checked ) == PackedTimes::Pack( plain ) );
+  UT_CHECK( PackedTimes::Pack( saturating ) == PackedTimes::Pack( plain ) );
+  UT_CHECK( UniversalTimeCore( checked ) == plain );
+  UT_CHECK( PackedTimes::Pack( checked + checked ) == 2 * PackedTimes::Pack( plain ) );
+
+  // Checked throws on every overflow
+  UT_CHECK( !Throws( maxDays, 86399, 0.0 ) );
+  UT_CHECK( Throws( maxDays, 86400, 0.0 ) );
+  UT_CHECK( Throws( minDays, -1, 0.0 ) );
+  UT_CHECK( Throws( 0, 0, 1.0e30 ) );
+  UT_CHECK( Throws( 0, 0, std::numeric_limits<double>::quiet_NaN() ) );
+  UT_CHECK( Throws( 0, 0, -std::numeric_limits<double>::infinity() ) );
+  bool sumThrew = false;
+  try
+    {
+      CheckedTime( maxDays - 1, 0, 0.0 ) + CheckedTime( 2, 0, 0.0 );
+    }
+  catch( const std::overflow_error& )
+    {
+      sumThrew = true;
+    }
+  UT_CHECK( sumThrew );
+  bool differenceThrew = false;
+  try
+    {
+      CheckedTime( minDays + 1, 0, 0.0 ) - CheckedTime( 2, 0, 0.0 );
+    }
+  catch( const std::overflow_error& )
+    {
+      differenceThrew = true;
+    }
+  UT_CHECK( differenceThrew );
+  // A throwing compound assignment leaves its operand as it was
+  const CheckedTime before( maxDays - 1, 86000, 1.0e8 );
+  CheckedTime operand = before;
+  bool assignThrew = false;
+  try
+    {
+      operand += CheckedTime( 1, 1000, 1.0e9 );
+    }
+  catch( const std::overflow_error& )
+    {
+      assignThrew = true;
+    }
+  UT_CHECK( assignThrew );
+  UT_CHECK( operand.GetDays() == before.GetDays() && operand.GetSeconds() == before.GetSeconds()
+            && operand.GetNanoSeconds() == before.GetNanoSeconds() );
+  operand = CheckedTime( minDays + 1, 100, 1.0e8 );
+  assignThrew = false;
+  try
+    {
+      operand -= CheckedTime( 1, 1000, 2.0e8 );
+    }
+  catch( const std::overflow_error& )
+    {
+      assignThrew = true;
+    }
+  UT_CHECK( assignThrew );
+  UT_CHECK( operand == CheckedTime( minDays + 1, 100, 1.0e8 ) && operand.GetNanoSeconds() == 1.0e8 );
+
+  // Saturating clamps to the latest or earliest time
+  const SaturatingTime latest( maxDays, 86399, 1.0e9 );
+  UT_CHECK( latest.GetDays() == maxDays );
+  UT_CHECK( latest.GetSeconds() == 86399 );
+  UT_CHECK( latest.GetNanoSeconds() < 1.0e9 && latest.GetNanoSeconds() > 999999999.0 );
+  const SaturatingTime earliest( minDays, 0, -1.0 );
+  UT_CHECK( earliest.GetDays() == minDays );
+  UT_CHECK( earliest.GetSeconds() == 0 );
+  UT_CHECK( earliest.GetNanoSeconds() == 0.0 );
+  UT_CHECK( SaturatingTime( 0, 0, 1.0e30 ) == latest );
+  UT_CHECK( SaturatingTime( 0, 0, -1.0e30 ) == earliest );
+  UT_CHECK( SaturatingTime( maxDays, 0, 0.0 ) + SaturatingTime( maxDays, 0, 0.0 ) == latest );
+  UT_CHECK( SaturatingTime( minDays, 0, 0.0 ) - SaturatingTime( 1, 0, 0.0 ) == earliest );
+  UT_CHECK( latest + SaturatingTime( 0, 0, 1.0 ) == latest );
+  UT_CHECK( SaturatingTime( maxDays - 1, 0, 0.0 ) + SaturatingTime( 0, 1, 0.0 ) == SaturatingTime( maxDays - 1, 1, 0.0 ) );
+  return Check::Result();
+}
@@ -0,0 +1,179 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of TimeAuditor on a clean stream and one with each kind
+/// of fault injected, whole and fed in pieces.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <TimeAuditor.hh>
+#include <TimeGenerator.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+  typedef std::vector<TimeAuditor::Anomaly> Anomalies;
+
+  bool Same( const Anomalies& lhs, const Anomalies& rhs )
+  {
+    if( lhs.size() != rhs.size() )
+      return false;
+    for( size_t i = 0; i < lhs.size(); i++ )
+      if( lhs[i].index != rhs[i].index || lhs[i].kind != rhs[i].kind || lhs[i].time != rhs[i].time
+          || lhs[i].value != rhs[i].value )
+        return false;
+    return true;
+  }
+
+  bool Is( const TimeAuditor::Anomaly& anomaly, const uint64_t index, const TimeAuditor::Kind kind, const int64_t value )
+  {
+    return anomaly.index == index && anomaly.kind == static_cast<uint64_t>( kind ) && anomaly.value == value;
+  }
+}
+
+int main()
+{
+  UT_CHECK( sizeof( TimeAuditor::Anomaly ) == 24 );
+  const PackedTime kMaxGap = 1000000; // 1 ms at 1 MHz
+  const PackedTime kBudget = 50;
+  std::vector<PackedTime> times( 10000 );
+  TimeGenerator generator( 13 );
+  generator.Poisson( 0, 1.0e6, 100, times.data(), times.size() );
+  // A reference clock running 20 ppm fast, well inside the budget between hits
+  std::vector<PackedTime> references( times.size() );
+  for( size_t i = 0; i < times.size(); i++ )
+    references[i] = 123456789 + static_cast<PackedTime>( std::llround( times[i] * 1.00002 ) );
+
+  {
+    TimeAuditor auditor( kMaxGap, kBudget );
+    Anomalies anomalies;
+    UT_CHECK( auditor.Audit( times.data(), references.data(), times.size(), anomalies ) == 0 );
+    UT_CHECK( anomalies.empty() && auditor.GetAudited() == times.size() );
+  }
+
+  // A step back, a day's leap and its return, a clock jump against the reference
+  std::vector<PackedTime> faulty = times;
+  faulty[300] = faulty[299] - 5;
+  faulty[5000] += PackedTimes::kNanoSecondsPerDay;
+  for( size_t i = 7000; i < faulty.size(); i++ )
+    faulty[i] += 10000; // The clock skips 10 us, the reference does not
+  TimeAuditor auditor( kMaxGap, kBudget );
+  Anomalies whole;
+  UT_CHECK( auditor.Audit( faulty.data(), references.data(), faulty.size(), whole ) == 8 );
+  UT_CHECK( whole.size() == 8 );
+  if( whole.size() == 8 )
+    {
+      // The glitched time leaves its neighbours' drift off both ways
+      UT_CHECK( Is( whole[0], 300, TimeAuditor::kBackward, -5 ) );
+      UT_CHECK( whole[0].time == faulty[300] );
+      const int64_t glitch = faulty[300] - references[300] - faulty[299] + references[299];
+      UT_CHECK( Is( whole[1], 300, TimeAuditor::kJump, glitch ) );
+      UT_CHECK( whole[2].index == 301 && whole[2].kind == TimeAuditor::kJump && std::llabs( whole[2].value + glitch ) <= 1 );
+      UT_CHECK( Is( whole[3], 5000, TimeAuditor::kGap, faulty[5000] - faulty[4999] ) );
+      UT_CHECK( Is( whole[4], 5000, TimeAuditor::kJump, PackedTimes::kNanoSecondsPerDay ) );
+      UT_CHECK( Is( whole[5], 5001, TimeAuditor::kBackward, faulty[5001] - faulty[5000] ) );
+      UT_CHECK( Is( whole[6], 5001, TimeAuditor::kJump, -PackedTimes::kNanoSecondsPerDay ) );
+      // The 10 us skip is a normal gap but not a normal drift, and the new offset holds after it
+      UT_CHECK( whole[7].index == 7000 && whole[7].kind == TimeAuditor::kJump && std::llabs( whole[7].value - 10000 ) <= 1 );
+    }
+  UT_CHECK( auditor.GetCount( TimeAuditor::kJump ) == 5 );
+  UT_CHECK( auditor.GetCount( TimeAuditor::kBackward ) == 2 && auditor.GetCount( TimeAuditor::kGap ) == 1 );
+
+  // Fed in pieces, or one at a time, the findings are the same
+  const size_t pieces[] = { 1, 7, 255, 256, 257, 1000 };
+  for( size_t p = 0; p < 6; p++ )
+    {
+      TimeAuditor streamed( kMaxGap, kBudget );
+      Anomalies anomalies;
+      for( size_t i = 0; i < faulty.size(); i += pieces[p] )
+        streamed.Audit( faulty.data() + i, references.data() + i, std::min( pieces[p], faulty.size() - i ), anomalies );
+      UT_CHECK( Same( anomalies, whole ) );
+    }
+  {
+    TimeAuditor live( kMaxGap, kBudget );
+    Anomalies anomalies;
+    for( size_t i = 0; i < faulty.size(); i++ )
+      live.Fill( faulty[i], references[i], anomalies );
+    UT_CHECK( Same( anomalies, whole ) );
+  }
+
+  // Without a reference, and with a tolerance for small steps back
+  {
+    TimeAuditor tolerant( kMaxGap, 0, 10 );
+    Anomalies anomalies;
+    tolerant.Audit( faulty.data(), faulty.size(), anomalies );
+    UT_CHECK( anomalies.size() == 2 && tolerant.GetCount( TimeAuditor::kBackward ) == 1 );
+    UT_CHECK( tolerant.GetCount( TimeAuditor::kGap ) == 1 && tolerant.GetCount( TimeAuditor::kJump ) == 0 );
+    TimeAuditor noGap( 0 );
+    anomalies.clear();
+    noGap.Audit( faulty.data(), faulty.size(), anomalies );
+    UT_CHECK( anomalies.size() == 2 && noGap.GetCount( TimeAuditor::kBackward ) == 2 );
+  }
+
+  // Raw fields, non canonical ones found before packing folds them in
+  {
+    const size_t n = 600;
+    std::vector<int32_t> days( n ), seconds( n );
+    std::vector<double> nanoSeconds( n );
+    for( size_t i = 0; i < n; i++ )
+      {
+        days[i] = 4000;
+        seconds[i] = static_cast<int32_t>( i );
+        nanoSeconds[i] = 5.0;
+      }
+    seconds[10] = -1; // Also a step back
+    nanoSeconds[300] = 1.0e9;
+    seconds[301] = 86400; // Also a day's leap
+    nanoSeconds[301] = -0.5;
+    nanoSeconds[500] = NAN;
+    TimeAuditor fields( 2 * PackedTimes::kNanoSecondsPerSecond );
+    Anomalies anomalies;
+    std::vector<PackedTime> packed( n );
+    fields.AuditFields( days.data(), seconds.data(), nanoSeconds.data(), n, anomalies, packed.data() );
+    UT_CHECK( fields.GetCount( TimeAuditor::kNonCanonical ) == 4 );
+    UT_CHECK( fields.GetCount( TimeAuditor::kBackward ) == 2 && fields.GetCount( TimeAuditor::kGap ) == 2 );
+    UT_CHECK( packed[300] == PackedTimes::Pack( 4000, 301, 0.0 ) && packed[500] == PackedTimes::Pack( 4000, 500, 0.0 ) );
+    size_t found = 0;
+    for( size_t i = 0; i < anomalies.size(); i++ )
+      if( anomalies[i].kind == TimeAuditor::kNonCanonical )
+        {
+          const uint64_t index = anomalies[i].index;
+          found += ( index == 10 && anomalies[i].value == TimeAuditor::kBadSeconds )
+            + ( index == 300 && anomalies[i].value == TimeAuditor::kBadNanoSeconds )
+            + ( index == 301 && anomalies[i].value == ( TimeAuditor::kBadSeconds | TimeAuditor::kBadNanoSeconds ) )
+            + ( index == 500 && anomalies[i].value == TimeAuditor::kBadNanoSeconds );
+        }
+    UT_CHECK( found == 4 );
+    // Same as auditing the packed times, bar the field records
+    TimeAuditor repacked( 2 * PackedTimes::kNanoSecondsPerSecond );
+    Anomalies timeOnly;
+    repacked.Audit( packed.data(), n, timeOnly );
+    UT_CHECK( timeOnly.size() + 4 == anomalies.size() );
+
+    // Corrupt days are flagged rather than packed past the PackedTime range, the times around go on
+    days[200] = 2000000000;
+    days[201] = -TimeAuditor::kMaxDays;
+    seconds[201] = -2000000000; // Days in range, but not with these seconds
+    TimeAuditor corrupt( 2 * PackedTimes::kNanoSecondsPerSecond );
+    anomalies.clear();
+    corrupt.AuditFields( days.data(), seconds.data(), nanoSeconds.data(), n, anomalies, packed.data() );
+    UT_CHECK( packed[200] == TimeAuditor::kUnpacked && packed[201] == TimeAuditor::kUnpacked );
+    UT_CHECK( packed[202] == PackedTimes::Pack( 4000, 202, 5.0 ) );
+    UT_CHECK( corrupt.GetCount( TimeAuditor::kNonCanonical ) == 6 );
+    // The unpacked times stand in as 199's, so 202 is a 3 s gap
+    UT_CHECK( corrupt.GetCount( TimeAuditor::kBackward ) == 2 && corrupt.GetCount( TimeAuditor::kGap ) == 3 );
+    size_t unpacked = 0;
+    for( size_t i = 0; i < anomalies.size(); i++ )
+      unpacked += ( anomalies[i].index == 200 && anomalies[i].value == TimeAuditor::kBadDays )
+        + ( anomalies[i].index == 201 && anomalies[i].value == ( TimeAuditor::kBadSeconds | TimeAuditor::kBadDays ) );
+    UT_CHECK( unpacked == 2 );
+    // Leading the stream, the first packed time after stands in
+    TimeAuditor leading( 2 * PackedTimes::kNanoSecondsPerSecond );
+    anomalies.clear();
+    leading.AuditFields( days.data() + 200, seconds.data() + 200, nanoSeconds.data() + 200, 10, anomalies );
+    UT_CHECK( anomalies.size() == 2 && leading.GetCount( TimeAuditor::kNonCanonical ) == 2 );
+  }
+  return Check::Result();
+}
@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of TimeColumnExtractor on a stand in for TObjArray,
+/// against the times read one GetTime call at a time.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <TimeColumnExtractor.hh>
+#include <TimeGenerator.hh>
+
+#include <memory>
+#include <vector>
+
+namespace
+{
+  /// Stands in for TObject
+  class MockObject
+  {
+  public:
+    virtual ~MockObject() { }
+    uint32_t uniqueID = 0;
+    uint32_t bits = 0;
+  };
+
+  /// Stands in for UniversalTime, a TObject and a UniversalTimeCore
+  class MockTime : public MockObject, public UniversalTimeCore
+  {
+  public:
+    MockTime( const UniversalTimeCore& time ) : MockObject(), UniversalTimeCore( time ) { }
+  };
+
+  class MockHit : public MockObject
+  {
+  public:
+    MockHit( const int pmt_, const UniversalTimeCore& time_ ) : pmt(pmt_), charge(1.5), time(time_) { }
+    virtual const MockTime& GetTime() const { return time; }
+    int pmt;
+    double charge;
+    MockTime time;
+  };
+
+  /// Stands in for TObjArray, pointers that may be empty
+  class MockArray
+  {
+  public:
+    int GetEntriesFast() const { return static_cast<int>( objects.size() ); }
+    MockObject* UncheckedAt( const int i ) const { return objects[i]; }
+    std::vector<MockObject*> objects;
+  };
+}
+
+int main()
+{
+  std::vector<PackedTime> packed( 1000 );
+  TimeGenerator generator( 8 );
+  generator.Uniform( -3 * PackedTimes::kNanoSecondsPerDay, 3 * PackedTimes::kNanoSecondsPerDay, packed.data(), packed.size() );
+  std::vector<std::unique_ptr<MockHit> > hits;
+  MockArray array;
+  for( size_t i = 0; i < packed.size(); i++ )
+    {
+      int32_t days, seconds;
+      double nanoSeconds;
+      PackedTimes::Unpack( packed[i], days, seconds, nanoSeconds );
+      hits.emplace_back( new MockHit( static_cast<int>( i ), UniversalTimeCore( days, seconds, nanoSeconds ) ) );
+      array.objects.push_back( hits.back().get() );
+      if( i % 10 == 3 )
+        array.objects.push_back( 0 ); // Empty slot
+    }
+
+  // Through the accessor, with the entry numbers of the times
+  std::vector<PackedTime> times( array.objects.size() );
+  std::vector<uint32_t> indices( array.objects.size() );
+  UT_CHECK( TimeColumnExtractor::Extract<MockHit>( array, []( const MockHit& hit ) -> const MockTime& { return hit.GetTime(); },
+                                                   times.data(), indices.data() ) == packed.size() );
+  size_t bad = 0;
+  for( size_t i = 0; i < packed.size(); i++ )
+    {
+      const MockHit* hit = static_cast<const MockHit*>( array.UncheckedAt( static_cast<int>( indices[i] ) ) );
+      bad += times[i] != packed[i] || hit == 0 || hit->pmt != static_cast<int>( i );
+    }
+  UT_CHECK( bad == 0 );
+
+  // At the offset of the core within the member, not of the member itself
+  const ptrdiff_t offset = TimeColumnExtractor::OffsetOf( array.UncheckedAt( 0 ), hits[0]->GetTime() );
+  const char* base = reinterpret_cast<const char*>( array.UncheckedAt( 0 ) );
+  UT_CHECK( offset > reinterpret_cast<const char*>( &hits[0]->time ) - base );
+  std::vector<PackedTime> atOffset( array.objects.size(), -1 );
+  UT_CHECK( TimeColumnExtractor::ExtractAtOffset( array, offset, atOffset.data() ) == packed.size() );
+  bad = 0;
+  for( size_t i = 0; i < packed.size(); i++ )
+    bad += atOffset[i] != packed[i];
+  UT_CHECK( bad == 0 );
+  UT_CHECK( atOffset[packed.size()] == -1 );
+
+  MockArray empty;
+  UT_CHECK( TimeColumnExtractor::ExtractAtOffset( empty, offset, atOffset.data() ) == 0 );
+  return Check::Result();
+}
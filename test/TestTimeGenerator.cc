@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of TimeGenerator.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <TimeGenerator.hh>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+int main()
+{
+  // Philox4x32-10 known answers from the Random123 distribution
+  uint32_t words[4];
+  TimeGenerator::Philox( 0, 0, 0, words );
+  UT_CHECK( words[0] == 0x6627e8d5u && words[1] == 0xe169c58du && words[2] == 0xbc57ac4cu && words[3] == 0x9b00dbd8u );
+  TimeGenerator::Philox( ~0ULL, ~0ULL, ~0ULL, words );
+  UT_CHECK( words[0] == 0x408f276du && words[1] == 0x41c83b0eu && words[2] == 0xa20bc7c6u && words[3] == 0x6d5451fdu );
+
+  // Reproducible and independent of how the batch is split
+  std::vector<PackedTime> whole( 1000 ), split( 1000 );
+  TimeGenerator one( 42, 3 );
+  one.Uniform( -100, 100, whole.data(), whole.size() );
+  TimeGenerator first( 42, 3 ), second( 42, 3 );
+  first.Uniform( -100, 100, split.data(), 400 );
+  second.SetCounter( 400 );
+  second.Uniform( -100, 100, split.data() + 400, 600 );
+  UT_CHECK( whole == split );
+  UT_CHECK( *std::min_element( whole.begin(), whole.end() ) >= -100 );
+  UT_CHECK( *std::max_element( whole.begin(), whole.end() ) < 100 );
+  bool threw = false;
+  try
+    {
+      one.Uniform( 100, 100, whole.data(), whole.size() );
+    }
+  catch( const std::invalid_argument& )
+    {
+      threw = true;
+    }
+  UT_CHECK( threw );
+  TimeGenerator otherStream( 42, 4 );
+  otherStream.Uniform( -100, 100, split.data(), split.size() );
+  UT_CHECK( whole != split );
+
+  // Poisson process, sorted, dead time respected, mean rate as asked
+  std::vector<PackedTime> hits( 100000 );
+  TimeGenerator poisson( 1 );
+  const PackedTime last = poisson.Poisson( 0, 1.0e6, 200, hits.data(), hits.size() );
+  UT_CHECK( last == hits.back() );
+  bool deadTimeKept = true;
+  for( size_t i = 1; i < hits.size(); i++ )
+    deadTimeKept = deadTimeKept && hits[i] - hits[i - 1] >= 200;
+  UT_CHECK( deadTimeKept );
+  UT_CHECK_CLOSE( static_cast<double>( hits.back() ) / hits.size(), 1200.0, 20.0 );
+
+  // Bursts keep the series sorted
+  std::vector<PackedTime> series( hits.begin(), hits.begin() + 10000 );
+  const size_t added = poisson.InjectBursts( series, 1000.0, 25, 10 );
+  UT_CHECK( added > 0 && added % 25 == 0 );
+  UT_CHECK( series.size() == 10000 + added );
+  UT_CHECK( std::is_sorted( series.begin(), series.end() ) );
+
+  // main.C's field ranges
+  std::vector<int32_t> days( 10000 ), seconds( 10000 );
+  std::vector<double> nanoSeconds( 10000 );
+  TimeGenerator( 5 ).MixedSignFields( days.data(), seconds.data(), nanoSeconds.data(), days.size() );
+  UT_CHECK( *std::min_element( days.begin(), days.end() ) == -100 && *std::max_element( days.begin(), days.end() ) == 98 );
+  UT_CHECK( *std::min_element( seconds.begin(), seconds.end() ) >= -100000 && *std::max_element( seconds.begin(), seconds.end() ) < 100000 );
+  UT_CHECK( *std::min_element( nanoSeconds.begin(), nanoSeconds.end() ) > -1.0e9 && *std::max_element( nanoSeconds.begin(), nanoSeconds.end() ) < 1.0e9 );
+  return Check::Result();
+}
@@ -0,0 +1,185 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of TimeRangeReader against the events of its windows
+/// picked out by hand, through io_uring and through pread.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <PartitionedWriter.hh>
+#include <TimeGenerator.hh>
+#include <TimeRangeReader.hh>
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+  struct Hit
+  {
+    PackedTime time;
+    uint64_t id;
+    double charge;
+  };
+
+  typedef TimeRangeReader<Hit>::Window Window;
+
+  /// Ids of events in any of the windows, sorted
+  std::vector<uint64_t> Expected( const std::vector<Hit>& hits, const std::vector<Window>& windows )
+  {
+    std::vector<uint64_t> ids;
+    for( size_t i = 0; i < hits.size(); i++ )
+      for( size_t w = 0; w < windows.size(); w++ )
+        if( hits[i].time >= windows[w].first && hits[i].time < windows[w].second )
+          {
+            ids.push_back( hits[i].id );
+            break;
+          }
+    std::sort( ids.begin(), ids.end() );
+    return ids;
+  }
+
+  /// Ids of events read, sorted, and whether every run was in order and every event in a window
+  std::vector<uint64_t> Read( TimeRangeReader<Hit>& reader, const std::vector<Window>& windows, bool& good )
+  {
+    std::mutex mutex;
+    std::vector<uint64_t> ids;
+    good = true;
+    const uint64_t visited = reader.Read( windows, [&]( const Hit* hits, const size_t count )
+                                          {
+                                            std::lock_guard<std::mutex> lock( mutex );
+                                            for( size_t i = 0; i < count; i++ )
+                                              {
+                                                bool inWindow = false;
+                                                for( size_t w = 0; w < windows.size(); w++ )
+                                                  inWindow |= hits[i].time >= windows[w].first && hits[i].time < windows[w].second;
+                                                good &= inWindow;
+                                                good &= i == 0 || hits[i - 1].time <= hits[i].time;
+                                                good &= hits[i].charge == 0.5 * static_cast<double>( hits[i].id );
+                                                ids.push_back( hits[i].id );
+                                              }
+                                          } );
+    good &= visited == ids.size();
+    std::sort( ids.begin(), ids.end() );
+    return ids;
+  }
+}
+
+int main()
+{
+  char directory[] = "/tmp/TestTimeRangeReaderXXXXXX";
+  if( mkdtemp( directory ) == 0 )
+    return 1;
+  const PackedTime hour = PartitionedWriter<Hit>::kHour;
+  // Two hours of events with repeats, one file per hour
+  std::vector<PackedTime> times( 100000 );
+  TimeGenerator generator( 11 );
+  generator.Uniform( 0, 2 * hour, times.data(), times.size() );
+  for( size_t i = 1; i < times.size(); i += 37 )
+    times[i] = times[i - 1];
+  std::vector<Hit> hits( times.size() );
+  for( size_t i = 0; i < hits.size(); i++ )
+    {
+      hits[i].time = times[i];
+      hits[i].id = i;
+      hits[i].charge = 0.5 * static_cast<double>( i );
+    }
+  {
+    PartitionedWriter<Hit> writer( directory, hour, 2 );
+    writer.Add( hits.data(), hits.size() );
+    writer.Close();
+  }
+  const PartitionManifest manifest = PartitionManifest::Load( directory );
+  std::vector<std::string> paths;
+  for( size_t i = 0; i < manifest.entries.size(); i++ )
+    paths.push_back( std::string( directory ) + "/" + manifest.entries[i].file );
+  UT_CHECK( paths.size() == 2 );
+
+  // Overlapping, empty, reversed, outside, on repeats and over the file boundary
+  std::vector<Window> windows;
+  const PackedTime minute = 60 * PackedTimes::kNanoSecondsPerSecond;
+  windows.push_back( Window( hour / 3, hour / 3 + 2 * minute ) );
+  windows.push_back( Window( hour / 3 + minute, hour / 3 + 5 * minute ) );
+  windows.push_back( Window( hour - 3 * minute, hour + 3 * minute ) );
+  windows.push_back( Window( 7, 7 ) );
+  windows.push_back( Window( 9, 5 ) );
+  windows.push_back( Window( -hour, -1 ) );
+  windows.push_back( Window( 3 * hour, 4 * hour ) );
+  windows.push_back( Window( hits[37].time, hits[37].time + 1 ) );
+  windows.push_back( Window( 2 * hour - minute, 2 * hour ) );
+  const std::vector<uint64_t> expected = Expected( hits, windows );
+  UT_CHECK( expected.size() > 1000 );
+
+  const TimeRangeReader<Hit>::Engine engines[] = { TimeRangeReader<Hit>::kAuto, TimeRangeReader<Hit>::kPread };
+  for( size_t e = 0; e < 2; e++ )
+    {
+      // Small blocks so the windows span several, a shallow queue so slots are reused
+      TimeRangeReader<Hit> reader( paths, 500, 4, 3, engines[e] );
+      UT_CHECK( e == 0 || reader.GetEngine() == TimeRangeReader<Hit>::kPread );
+      bool good = false;
+      UT_CHECK( Read( reader, windows, good ) == expected );
+      UT_CHECK( good );
+      // Only the blocks holding the windows, give or take one at each end
+      UT_CHECK( reader.GetBlocksRead() < expected.size() / 500 + 2 * windows.size() );
+      UT_CHECK( reader.GetBytesRead() >= expected.size() * sizeof( Hit ) );
+      UT_CHECK( reader.GetBytesRead() < hits.size() * sizeof( Hit ) / 4 );
+
+      // Everything, once, however the windows cover it
+      std::vector<Window> all( 1, Window( -hour, 3 * hour ) );
+      all.push_back( Window( 0, hour ) );
+      std::vector<uint64_t> ids = Read( reader, all, good );
+      UT_CHECK( good && ids.size() == hits.size() );
+      UT_CHECK( std::adjacent_find( ids.begin(), ids.end() ) == ids.end() );
+      UT_CHECK( Read( reader, std::vector<Window>( 1, Window( -hour, 0 ) ), good ).empty() );
+      UT_CHECK( reader.GetBlocksRead() == 0 );
+
+      // Direct I/O where the filesystem has it, buffered otherwise
+      TimeRangeReader<Hit> direct( paths, 4096, 8, 2, engines[e], true );
+      UT_CHECK( Read( direct, windows, good ) == expected );
+      UT_CHECK( good );
+    }
+
+  // Times repeated across a block boundary, a window beginning on them reads the block before
+  {
+    const std::string path = std::string( directory ) + "/straddle";
+    const PackedTime straddle[] = { 10, 20, 30, 100, 100, 100, 200, 300 };
+    std::vector<Hit> records( 8 );
+    for( size_t i = 0; i < records.size(); i++ )
+      {
+        records[i].time = straddle[i];
+        records[i].id = i;
+        records[i].charge = 0.5 * static_cast<double>( i );
+      }
+    FILE* file = std::fopen( path.c_str(), "wb" );
+    UT_CHECK( file != 0 && std::fwrite( records.data(), sizeof( Hit ), records.size(), file ) == records.size() );
+    std::fclose( file );
+    const std::vector<Window> onRepeats( 1, Window( 100, 150 ) );
+    for( size_t e = 0; e < 2; e++ )
+      {
+        TimeRangeReader<Hit> reader( std::vector<std::string>( 1, path ), 4, 2, 1, engines[e] );
+        bool good = false;
+        UT_CHECK( Read( reader, onRepeats, good ) == Expected( records, onRepeats ) );
+        UT_CHECK( good && reader.GetBlocksRead() == 2 );
+      }
+    std::remove( path.c_str() );
+  }
+
+  bool threw = false;
+  try
+    {
+      TimeRangeReader<Hit> missing( std::vector<std::string>( 1, std::string( directory ) + "/missing" ) );
+    }
+  catch( const std::runtime_error& )
+    {
+      threw = true;
+    }
+  UT_CHECK( threw );
+
+  for( size_t i = 0; i < paths.size(); i++ )
+    std::remove( paths[i].c_str() );
+  std::remove( ( std::string( directory ) + "/manifest.txt" ).c_str() );
+  UT_CHECK( rmdir( directory ) == 0 );
+  return Check::Result();
+}
@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of TimeRollupStore against brute force aggregation.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <TimeGenerator.hh>
+#include <TimeRollupStore.hh>
+
+#include <dirent.h>
+#include <fcntl.h>
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+  /// Number of open file descriptors
+  size_t OpenFiles()
+  {
+    size_t count = 0;
+    DIR* fds = opendir( "/proc/self/fd" );
+    if( fds == 0 )
+      return 0;
+    while( readdir( fds ) != 0 )
+      count++;
+    closedir( fds );
+    return count;
+  }
+}
+
+int main()
+{
+  char directory[] = "/tmp/TestTimeRollupStoreXXXXXX";
+  if( mkdtemp( directory ) == 0 )
+    return 1;
+  // Two days of points, a few late, from before t0 to after
+  std::vector<PackedTime> times( 20000 );
+  TimeGenerator generator( 4 );
+  generator.Poisson( -PackedTimes::kNanoSecondsPerDay, 0.1, 0, times.data(), times.size() );
+  for( size_t i = 10; i < times.size(); i += 97 )
+    times[i] -= 30 * PackedTimes::kNanoSecondsPerSecond;
+  {
+    TimeRollupStore store( directory );
+    for( size_t i = 0; i < times.size() / 2; i++ )
+      store.Fill( times[i], static_cast<double>( i % 13 ) );
+  }
+  // Reopen, the first half must have persisted
+  TimeRollupStore store( directory );
+  for( size_t i = times.size() / 2; i < times.size(); i++ )
+    store.Fill( times[i], static_cast<double>( i % 13 ) );
+  UT_CHECK( store.GetSegment( 3 ).GetSize() <= 3 );
+
+  std::vector<PackedTime> bounds( 200 );
+  generator.Uniform( times.front(), times.back(), bounds.data(), bounds.size() );
+  for( size_t q = 0; q + 1 < bounds.size(); q += 2 )
+    {
+      const PackedTime begin = std::min( bounds[q], bounds[q + 1] );
+      const PackedTime end = std::max( bounds[q], bounds[q + 1] );
+      const RollupBucket result = store.Query( begin, end );
+      const int64_t second = PackedTimes::kNanoSecondsPerSecond;
+      const PackedTime from = PackedTimes::FloorDivide( begin, second ) * second;
+      const PackedTime to = -PackedTimes::FloorDivide( -end, second ) * second;
+      RollupBucket expected = RollupBucket::Empty();
+      for( size_t i = 0; i < times.size(); i++ )
+        if( times[i] >= from && times[i] < to )
+          expected.Fill( static_cast<double>( i % 13 ) );
+      UT_CHECK( result.count == expected.count );
+      UT_CHECK( result.sum == expected.sum );
+      UT_CHECK( result.count == 0 || ( result.minimum == expected.minimum && result.maximum == expected.maximum ) );
+    }
+
+  const char* names[] = { "1s", "1min", "1h", "1d" };
+  for( size_t level = 0; level < TimeRollupStore::kLevels; level++ )
+    std::remove( ( std::string( directory ) + "/rollup_" + names[level] + ".seg" ).c_str() );
+
+  // A store failing on its third level closes the first two and the bad file
+  {
+    FILE* bad = std::fopen( ( std::string( directory ) + "/rollup_1h.seg" ).c_str(), "w" );
+    UT_CHECK( bad != 0 && std::fputs( "not a rollup segment, long enough for a header", bad ) >= 0 );
+    std::fclose( bad );
+    const size_t before = OpenFiles();
+    bool threw = false;
+    try
+      {
+        TimeRollupStore broken( directory );
+      }
+    catch( const std::runtime_error& )
+      {
+        threw = true;
+      }
+    UT_CHECK( threw && OpenFiles() == before );
+    for( size_t level = 0; level < TimeRollupStore::kLevels; level++ )
+      std::remove( ( std::string( directory ) + "/rollup_" + names[level] + ".seg" ).c_str() );
+  }
+
+  // A header that does not describe its file is refused before mapping
+  {
+    const std::string path = std::string( directory ) + "/corrupt.seg";
+    const int64_t width = TimeRollupStore::GetWidth( 0 );
+    {
+      RollupSegment segment( path, width );
+      segment.Fill( 0, 1.0 );
+    }
+    uint64_t fields[2];
+    const int fd = open( path.c_str(), O_RDWR );
+    UT_CHECK( fd >= 0 && pread( fd, fields, sizeof( fields ), 16 ) == static_cast<ssize_t>( sizeof( fields ) ) );
+    // Size beyond the capacity, capacity beyond the file, no capacity
+    const uint64_t corrupt[3][2] = { { fields[1] + 1, fields[1] }, { fields[0], fields[1] * 2 }, { 0, 0 } };
+    size_t refused = 0;
+    for( size_t c = 0; c < 3; c++ )
+      {
+        UT_CHECK( pwrite( fd, corrupt[c], sizeof( corrupt[c] ), 16 ) == static_cast<ssize_t>( sizeof( corrupt[c] ) ) );
+        try
+          {
+            RollupSegment segment( path, width );
+          }
+        catch( const std::runtime_error& )
+          {
+            refused++;
+          }
+      }
+    UT_CHECK( refused == 3 );
+    UT_CHECK( pwrite( fd, fields, sizeof( fields ), 16 ) == static_cast<ssize_t>( sizeof( fields ) ) );
+    close( fd );
+    RollupSegment restored( path, width );
+    UT_CHECK( restored.GetSize() == 1 && restored.At( 0 ).count == 1 );
+    std::remove( path.c_str() );
+  }
+  rmdir( directory );
+  return Check::Result();
+}
@@ -0,0 +1,173 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of TimeSkipList against a sorted vector, and under
+/// concurrent inserts, scans and evictions.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <TimeGenerator.hh>
+#include <TimeSkipList.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  typedef std::vector<std::pair<PackedTime, uint64_t> > Events;
+
+  /// Everything in a range, in order
+  Events ScanAll( const TimeSkipList<uint64_t>& index, const PackedTime begin, const PackedTime end )
+  {
+    Events events;
+    index.Scan( begin, end, [&events]( const PackedTime time, const uint64_t value )
+                { events.push_back( std::make_pair( time, value ) ); } );
+    return events;
+  }
+}
+
+int main()
+{
+  // One thread, times with repeats, against a stable sort
+  QsbrDomain domain( 8 );
+  const size_t reader = domain.RegisterReader();
+  {
+    TimeSkipList<uint64_t> index( domain, 1000 );
+    UT_CHECK( index.Evict() == 0 && index.GetSize() == 0 );
+    std::vector<PackedTime> times( 20000 );
+    TimeGenerator generator( 9 );
+    generator.Uniform( -5000, 5000, times.data(), times.size() );
+    Events expected;
+    for( size_t i = 0; i < times.size(); i++ )
+      {
+        UT_CHECK( index.Insert( times[i], i ) );
+        expected.push_back( std::make_pair( times[i], i ) );
+      }
+    std::stable_sort( expected.begin(), expected.end(),
+                      []( const std::pair<PackedTime, uint64_t>& lhs, const std::pair<PackedTime, uint64_t>& rhs )
+                      { return lhs.first < rhs.first; } );
+    UT_CHECK( index.GetSize() == times.size() );
+    UT_CHECK( index.GetLatest() == expected.back().first );
+    UT_CHECK( ScanAll( index, -5000, 5000 ) == expected ); // Repeats in insertion order
+    const PackedTime ranges[][2] = { { -10000, -6000 }, { -17, 250 }, { 0, 1 }, { 4990, 10000 }, { 7, 7 } };
+    for( size_t r = 0; r < 5; r++ )
+      {
+        Events inRange;
+        for( size_t i = 0; i < expected.size(); i++ )
+          if( expected[i].first >= ranges[r][0] && expected[i].first < ranges[r][1] )
+            inRange.push_back( expected[i] );
+        UT_CHECK( ScanAll( index, ranges[r][0], ranges[r][1] ) == inRange );
+      }
+
+    // Eviction of the front, older inserts refused from then on
+    const size_t older = std::lower_bound( expected.begin(), expected.end(), std::make_pair( PackedTime( -1234 ), uint64_t( 0 ) ) )
+      - expected.begin();
+    UT_CHECK( index.Evict( -1234 ) == older );
+    UT_CHECK( index.GetSize() == expected.size() - older );
+    UT_CHECK( ScanAll( index, -5000, 5000 ) == Events( expected.begin() + older, expected.end() ) );
+    UT_CHECK( !index.Insert( -1235, 1 ) );
+    UT_CHECK( index.Insert( -1234, 1 ) );
+    UT_CHECK( index.Evict( -2000 ) == 0 );
+    // The reader has not been quiescent, nothing is freed until it is
+    UT_CHECK( index.Reclaim() == older );
+    domain.Quiescent( reader );
+    UT_CHECK( index.Reclaim() == 0 );
+    // Age from the latest time
+    const size_t kept = ScanAll( index, index.GetLatest() - 1000, index.GetLatest() + 1 ).size();
+    index.Evict();
+    UT_CHECK( index.GetSize() == kept );
+  }
+
+  // Three builders inserting, a display scanning and a thread evicting
+  {
+    const PackedTime kMaxAge = 50000;
+    const size_t nPerWriter = 200000;
+    TimeSkipList<uint64_t> index( domain, kMaxAge );
+    std::atomic<bool> done( false );
+    std::atomic<size_t> badScans( 0 );
+    std::atomic<size_t> refused( 0 );
+    std::vector<std::thread> threads;
+    for( uint64_t w = 0; w < 3; w++ )
+      threads.emplace_back( [&, w]()
+                            {
+                              const size_t own = domain.RegisterReader();
+                              TimeGenerator jitter( 10 + w );
+                              PackedTime late[256];
+                              for( size_t i = 0; i < nPerWriter; i += 256 )
+                                {
+                                  jitter.Uniform( 0, 1000, late, 256 );
+                                  for( size_t j = 0; j < 256; j++ )
+                                    {
+                                      // Roughly in order, a little late at times, value tells the writer
+                                      const PackedTime time = static_cast<PackedTime>( i + j ) * 10 - late[j];
+                                      refused += !index.Insert( time, ( i + j ) * 3 + w );
+                                    }
+                                  domain.Quiescent( own );
+                                }
+                              domain.UnregisterReader( own );
+                            } );
+    threads.emplace_back( [&]()
+                          {
+                            const size_t own = domain.RegisterReader();
+                            while( !done.load() )
+                              {
+                                const PackedTime latest = index.GetLatest();
+                                PackedTime last = latest - kMaxAge;
+                                size_t bad = 0;
+                                index.Scan( latest - kMaxAge, latest, [&]( const PackedTime time, const uint64_t value )
+                                            {
+                                              const PackedTime early = static_cast<PackedTime>( value / 3 ) * 10;
+                                              bad += time < last || time > early || time <= early - 1000;
+                                              last = time;
+                                            } );
+                                badScans += bad;
+                                domain.Quiescent( own );
+                              }
+                            domain.UnregisterReader( own );
+                          } );
+    threads.emplace_back( [&]()
+                          {
+                            while( !done.load() )
+                              {
+                                index.Evict();
+                                std::this_thread::yield();
+                              }
+                          } );
+    for( size_t t = 0; t < 3; t++ )
+      threads[t].join();
+    done.store( true );
+    threads[3].join();
+    threads[4].join();
+    UT_CHECK( badScans == 0 );
+
+    // Whatever is left after a final eviction is every event since its cutoff
+    const PackedTime cutoff = index.GetLatest() - kMaxAge;
+    index.Evict();
+    const Events left = ScanAll( index, cutoff - 2 * kMaxAge, index.GetLatest() + 1 );
+    UT_CHECK( left.size() == index.GetSize() );
+    std::vector<uint64_t> seen;
+    bool sorted = true;
+    for( size_t i = 0; i < left.size(); i++ )
+      {
+        sorted &= i == 0 || left[i - 1].first <= left[i].first;
+        seen.push_back( left[i].second );
+      }
+    UT_CHECK( sorted );
+    std::sort( seen.begin(), seen.end() );
+    UT_CHECK( std::adjacent_find( seen.begin(), seen.end() ) == seen.end() );
+    size_t missing = 0;
+    for( uint64_t value = 0; value < 3 * nPerWriter; value++ )
+      {
+        const PackedTime earliest = static_cast<PackedTime>( value / 3 ) * 10 - 1000;
+        if( earliest >= cutoff )
+          missing += !std::binary_search( seen.begin(), seen.end(), value );
+      }
+    UT_CHECK( missing == 0 );
+    UT_CHECK( left.front().first >= cutoff );
+    domain.Quiescent( reader );
+    UT_CHECK( index.Reclaim() == 0 );
+  }
+  domain.UnregisterReader( reader );
+  return Check::Result();
+}
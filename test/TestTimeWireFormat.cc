@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of TimeWireFormat against hand encoded timestamps, and
+/// round trips of single and bulk encodings.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <TimeGenerator.hh>
+#include <TimeWireFormat.hh>
+#include <UniversalTimeCore.hh>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+  /// Encoder output equals the bytes given
+  template<size_t N>
+  bool Encodes( const size_t size, const uint8_t* out, const uint8_t ( &expected )[N] )
+  {
+    return size == N && std::memcmp( out, expected, N ) == 0;
+  }
+
+  /// Every valid prefix is rejected and the whole decodes to time
+  template<class TDecode, size_t N>
+  bool Decodes( TDecode decode, const uint8_t ( &in )[N], const PackedTime time )
+  {
+    PackedTime decoded = 0;
+    for( size_t size = 0; size < N; size++ )
+      if( decode( in, size, decoded ) != 0 )
+        return false;
+    return decode( in, N, decoded ) == N && decoded == time;
+  }
+}
+
+int main()
+{
+  const auto msgPack = []( const uint8_t* in, const size_t size, PackedTime& time )
+    { return TimeWireFormat::DecodeMsgPack( in, size, time ); };
+  const auto cbor = []( const uint8_t* in, const size_t size, PackedTime& time )
+    { return TimeWireFormat::DecodeCbor( in, size, time ); };
+  const PackedTime second = PackedTimes::kNanoSecondsPerSecond;
+  const PackedTime unixEpoch = -PackedTimes::kUnixT0Seconds * second;
+  uint8_t out[TimeWireFormat::kCborMaxBytes];
+
+  // t0 is 1262304000 s, 0x4b3d3b00, after 1970
+  const uint8_t msgPack32[] = { 0xd6, 0xff, 0x4b, 0x3d, 0x3b, 0x00 };
+  const uint8_t cborT0[] = { 0xd9, 0x03, 0xe9, 0xa1, 0x01, 0x1a, 0x4b, 0x3d, 0x3b, 0x00 };
+  UT_CHECK( Encodes( TimeWireFormat::EncodeMsgPack( 0, out ), out, msgPack32 ) );
+  UT_CHECK( Decodes( msgPack, msgPack32, 0 ) );
+  UT_CHECK( Encodes( TimeWireFormat::EncodeCbor( 0, out ), out, cborT0 ) );
+  UT_CHECK( Decodes( cbor, cborT0, 0 ) );
+
+  // 1 ns after t0, nanoseconds in the top 30 bits of timestamp 64
+  const uint8_t msgPack64[] = { 0xd7, 0xff, 0x00, 0x00, 0x00, 0x04, 0x4b, 0x3d, 0x3b, 0x00 };
+  const uint8_t cborNs[] = { 0xd9, 0x03, 0xe9, 0xa2, 0x01, 0x1a, 0x4b, 0x3d, 0x3b, 0x00, 0x28, 0x01 };
+  UT_CHECK( Encodes( TimeWireFormat::EncodeMsgPack( 1, out ), out, msgPack64 ) );
+  UT_CHECK( Decodes( msgPack, msgPack64, 1 ) );
+  UT_CHECK( Encodes( TimeWireFormat::EncodeCbor( 1, out ), out, cborNs ) );
+  UT_CHECK( Decodes( cbor, cborNs, 1 ) );
+
+  // 1 ns before 1970, negative seconds need timestamp 96 and a CBOR negative integer
+  const uint8_t msgPack96[] = { 0xc7, 0x0c, 0xff, 0x3b, 0x9a, 0xc9, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+  const uint8_t cborNegative[] = { 0xd9, 0x03, 0xe9, 0xa2, 0x01, 0x20, 0x28, 0x1a, 0x3b, 0x9a, 0xc9, 0xff };
+  UT_CHECK( Encodes( TimeWireFormat::EncodeMsgPack( unixEpoch - 1, out ), out, msgPack96 ) );
+  UT_CHECK( Decodes( msgPack, msgPack96, unixEpoch - 1 ) );
+  UT_CHECK( Encodes( TimeWireFormat::EncodeCbor( unixEpoch - 1, out ), out, cborNegative ) );
+  UT_CHECK( Decodes( cbor, cborNegative, unixEpoch - 1 ) );
+
+  // Other encoders' choices: keys in either order, milliseconds, 8 byte seconds
+  const uint8_t cborSwapped[] = { 0xd9, 0x03, 0xe9, 0xa2, 0x28, 0x01, 0x01, 0x1a, 0x4b, 0x3d, 0x3b, 0x00 };
+  const uint8_t cborMilli[] = { 0xd9, 0x03, 0xe9, 0xa2, 0x01, 0x1a, 0x4b, 0x3d, 0x3b, 0x00, 0x22, 0x19, 0x01, 0xf4 };
+  const uint8_t cborWide[] = { 0xd9, 0x03, 0xe9, 0xa1, 0x01, 0x1b, 0x00, 0x00, 0x00, 0x00, 0x4b, 0x3d, 0x3b, 0x01 };
+  UT_CHECK( Decodes( cbor, cborSwapped, 1 ) );
+  UT_CHECK( Decodes( cbor, cborMilli, second / 2 ) );
+  UT_CHECK( Decodes( cbor, cborWide, second ) );
+
+  // Not timestamps, or out of range
+  PackedTime time = 0;
+  UT_CHECK( TimeWireFormat::DecodeMsgPack( out, TimeWireFormat::EncodeMsgPack( INT64_MIN, out ), time ) == 15 && time == INT64_MIN );
+  out[14] -= 1; // A second before the earliest packed time
+  UT_CHECK( TimeWireFormat::DecodeMsgPack( out, 15, time ) == 0 );
+  time = 0;
+  const uint8_t cborFloat[] = { 0xd9, 0x03, 0xe9, 0xa1, 0x01, 0xfb, 0x41, 0xd2, 0xcf, 0x4e, 0xc0, 0x00, 0x00, 0x00 };
+  const uint8_t cborNoSeconds[] = { 0xd9, 0x03, 0xe9, 0xa1, 0x28, 0x01 };
+  const uint8_t cborTwoFractions[] = { 0xd9, 0x03, 0xe9, 0xa2, 0x28, 0x01, 0x22, 0x01 };
+  const uint8_t cborTag1[] = { 0xc1, 0x1a, 0x4b, 0x3d, 0x3b, 0x00, 0x00 };
+  const uint8_t msgPackOtherType[] = { 0xd6, 0x01, 0x4b, 0x3d, 0x3b, 0x00 };
+  const uint8_t msgPackTooManyNs[] = { 0xd7, 0xff, 0xee, 0x6b, 0x28, 0x00, 0x4b, 0x3d, 0x3b, 0x00 };
+  const uint8_t msgPackTooLate[] = { 0xc7, 0x0c, 0xff, 0x00, 0x00, 0x00, 0x00, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+  UT_CHECK( TimeWireFormat::DecodeCbor( cborFloat, sizeof( cborFloat ), time ) == 0 );
+  UT_CHECK( TimeWireFormat::DecodeCbor( cborNoSeconds, sizeof( cborNoSeconds ), time ) == 0 );
+  UT_CHECK( TimeWireFormat::DecodeCbor( cborTwoFractions, sizeof( cborTwoFractions ), time ) == 0 );
+  UT_CHECK( TimeWireFormat::DecodeCbor( cborTag1, sizeof( cborTag1 ), time ) == 0 );
+  UT_CHECK( TimeWireFormat::DecodeMsgPack( msgPackOtherType, sizeof( msgPackOtherType ), time ) == 0 );
+  UT_CHECK( TimeWireFormat::DecodeMsgPack( msgPackTooManyNs, sizeof( msgPackTooManyNs ), time ) == 0 );
+  UT_CHECK( TimeWireFormat::DecodeMsgPack( msgPackTooLate, sizeof( msgPackTooLate ), time ) == 0 );
+  UT_CHECK( time == 0 );
+
+  // UniversalTime through its packed time
+  const UniversalTimeCore universal( 5000, 3, 7.0 );
+  uint8_t packed[TimeWireFormat::kCborMaxBytes];
+  UT_CHECK( TimeWireFormat::EncodeMsgPack( universal, out ) == TimeWireFormat::EncodeMsgPack( PackedTimes::Pack( universal ), packed ) );
+  UT_CHECK( std::memcmp( out, packed, 10 ) == 0 );
+  const size_t cborSize = TimeWireFormat::EncodeCbor( universal, out );
+  UT_CHECK( TimeWireFormat::DecodeCbor( out, cborSize, time ) == cborSize && time == PackedTimes::Pack( universal ) );
+
+  // Round trips over the whole packed time range and over the DAQ's years, single and bulk
+  std::vector<PackedTime> times( 20000 );
+  TimeGenerator generator( 12 );
+  generator.Uniform( INT64_MIN / 2, INT64_MAX / 2, times.data(), 10000 );
+  generator.Uniform( 0, 90 * 365 * PackedTimes::kNanoSecondsPerDay, times.data() + 10000, 10000 );
+  times[0] = unixEpoch;
+  times[1] = unixEpoch + 0xffffffffLL * second;
+  times[2] = unixEpoch + 0x100000000LL * second;
+  times[3] = INT64_MIN;
+  times[4] = INT64_MAX;
+  size_t bad = 0;
+  for( size_t i = 0; i < times.size(); i++ )
+    {
+      bad += TimeWireFormat::DecodeMsgPack( out, TimeWireFormat::EncodeMsgPack( times[i], out ), time ) == 0 || time != times[i];
+      bad += TimeWireFormat::DecodeCbor( out, TimeWireFormat::EncodeCbor( times[i], out ), time ) == 0 || time != times[i];
+    }
+  UT_CHECK( bad == 0 );
+
+  std::vector<uint8_t> buffer( times.size() * TimeWireFormat::kCborMaxBytes + 1 );
+  std::vector<PackedTime> decoded( times.size() + 1 );
+  size_t used = 0;
+  size_t size = TimeWireFormat::EncodeMsgPack( times.data(), times.size(), buffer.data() );
+  UT_CHECK( size < times.size() * TimeWireFormat::kMsgPackMaxBytes );
+  buffer[size] = 0xc0; // nil, not a timestamp
+  UT_CHECK( TimeWireFormat::DecodeMsgPack( buffer.data(), size + 1, decoded.data(), decoded.size(), &used ) == times.size() );
+  UT_CHECK( used == size );
+  UT_CHECK( std::equal( times.begin(), times.end(), decoded.begin() ) );
+  size = TimeWireFormat::EncodeCbor( times.data(), times.size(), buffer.data() );
+  buffer[size] = 0xf6;
+  UT_CHECK( TimeWireFormat::DecodeCbor( buffer.data(), size + 1, decoded.data(), decoded.size(), &used ) == times.size() );
+  UT_CHECK( used == size );
+  UT_CHECK( std::equal( times.begin(), times.end(), decoded.begin() ) );
+  // The DAQ's years take the fixed forms
+  UT_CHECK( TimeWireFormat::EncodeMsgPack( times.data() + 10000, 10000, buffer.data() ) == 10000 * 10 );
+  UT_CHECK( TimeWireFormat::EncodeCbor( times.data() + 10000, 10000, buffer.data() ) == 10000 * 16 );
+  // A count limit, and a cut off last item
+  UT_CHECK( TimeWireFormat::DecodeCbor( buffer.data(), 10000 * 16, decoded.data(), 10, &used ) == 10 && used == 160 );
+  UT_CHECK( TimeWireFormat::DecodeCbor( buffer.data(), 10 * 16 - 1, decoded.data(), decoded.size(), &used ) == 9 && used == 144 );
+  return Check::Result();
+}
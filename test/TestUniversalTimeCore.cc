@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of UniversalTimeCore, built without ROOT.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <PackedTime.hh>
+#include <UniversalTimeCore.hh>
+
+int main()
+{
+  // Overflowing fields roll into the next field
+  const UniversalTimeCore overflow( 0, 86401, 1.5e9 );
+  UT_CHECK( overflow.GetDays() == 1 );
+  UT_CHECK( overflow.GetSeconds() == 2 );
+  UT_CHECK_CLOSE( overflow.GetNanoSeconds(), 5.0e8, 1e-6 );
+
+  // Normalisation keeps the time
+  const UniversalTimeCore mixed( 3, -100000, -2.5e9 );
+  UT_CHECK( PackedTimes::Pack( mixed ) == PackedTimes::Pack( 3, -100000, -2.5e9 ) );
+
+  // Canonical form, only days carries the sign
+  const UniversalTimeCore before( 0, 0, -1.0 );
+  UT_CHECK( before.GetDays() == -1 );
+  UT_CHECK( before.GetSeconds() == 86399 );
+  UT_CHECK_CLOSE( before.GetNanoSeconds(), 999999999.0, 1e-6 );
+  UT_CHECK( mixed.GetDays() == 1 );
+  UT_CHECK( mixed.GetSeconds() == 72797 );
+  UT_CHECK_CLOSE( mixed.GetNanoSeconds(), 5.0e8, 1e-6 );
+  UT_CHECK( UniversalTimeCore( -1, 86400, 0.0 ) == UniversalTimeCore() );
+  UT_CHECK( UniversalTimeCore( 0, -1, 1.0e9 ) == UniversalTimeCore() );
+  // A remainder too small to hold below 1e9 rolls over
+  const UniversalTimeCore tiny( 0, 0, -1.0e-12 );
+  UT_CHECK( tiny.GetNanoSeconds() >= 0.0 && tiny.GetNanoSeconds() < 1.0e9 );
+  UT_CHECK( tiny.GetSeconds() >= 0 && tiny.GetSeconds() < 86400 );
+
+  // Arithmetic
+  const UniversalTimeCore a( 1, 100, 5.0e8 );
+  const UniversalTimeCore b( 0, 50, 7.0e8 );
+  UT_CHECK( PackedTimes::Pack( a + b ) == PackedTimes::Pack( a ) + PackedTimes::Pack( b ) );
+  UT_CHECK( PackedTimes::Pack( a - b ) == PackedTimes::Pack( a ) - PackedTimes::Pack( b ) );
+  UniversalTimeCore c = a;
+  c -= b;
+  c += b;
+  UT_CHECK( c == a );
+  UT_CHECK( a - b != a );
+
+  // Ordering of positive times
+  UT_CHECK( b < a );
+  UT_CHECK( b <= a );
+  UT_CHECK( a > b );
+  UT_CHECK( a >= a );
+  UT_CHECK( !( a < a ) );
+
+  // Ordering across t0
+  const UniversalTimeCore zero;
+  UT_CHECK( before < zero );
+  UT_CHECK( UniversalTimeCore( 0, -1, 0.0 ) < before );
+  UT_CHECK( zero - a < zero );
+  UT_CHECK( zero - a < zero - b );
+
+  // Calendar conversion from the SNO+ epoch
+  const std::tm time = UniversalTimeCore( 31, 3600, 0.0 ).GetTime();
+  UT_CHECK( time.tm_year == 110 );
+  UT_CHECK( time.tm_mon == 1 );
+  UT_CHECK( time.tm_mday == 1 );
+  UT_CHECK( time.tm_hour == 1 );
+  return Check::Result();
+}
@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////
+/// Unit tests of the time literals and constexpr UniversalTimeCore.
+////////////////////////////////////////////////////////////////////
+#include <Check.hh>
+
+#include <PackedTime.hh>
+#include <UniversalTimeLiterals.hh>
+
+using namespace UniversalTimeLiterals;
+
+namespace
+{
+  // Constants as detector code would declare them, all built by the compiler
+  constexpr UniversalTimeCore kTriggerWindow = 400_ns;
+  constexpr UniversalTimeCore kCableDelay = 12.5_ns;
+  constexpr UniversalTimeCore kVeto = 20_us;
+  constexpr UniversalTimeCore kRun = 1_h;
+
+  static_assert( kTriggerWindow == UniversalTimeCore( 0, 0, 400.0 ), "400_ns" );
+  static_assert( kCableDelay.GetNanoSeconds() == 12.5, "12.5_ns" );
+  static_assert( kVeto == UniversalTimeCore( 0, 0, 2.0e4 ), "20_us" );
+  static_assert( 1500_ms == UniversalTimeCore( 0, 1, 5.0e8 ), "1500_ms" );
+  static_assert( 90_s == 1.5_min, "90_s" );
+  static_assert( kRun == UniversalTimeCore( 0, 3600, 0.0 ), "1_h" );
+  static_assert( 25_h == UniversalTimeCore( 1, 3600, 0.0 ), "25_h" );
+  static_assert( 1_d == UniversalTimeCore( 1, 0, 0.0 ), "1_d" );
+  static_assert( 0.5_d == 12_h, "0.5_d" );
+  static_assert( 3000000000_ns == 3_s, "3e9_ns" );
+
+  // Arithmetic and comparison fold too
+  static_assert( 1_s - 1_ns == UniversalTimeCore( 0, 0, 999999999.0 ), "1_s - 1_ns" );
+  static_assert( -400_ns == UniversalTimeCore( -1, 86399, 999999600.0 ), "-400_ns" );
+  static_assert( 399_ns < kTriggerWindow && kTriggerWindow <= 400_ns && 401_ns > kTriggerWindow, "compare" );
+  static_assert( UniversalTimeCore( 0, 0, -1.0 ).GetDays() == -1, "constexpr normalisation" );
+  static_assert( BasicUniversalTimeCore<CheckedArithmetic>( 0, -1, 0.0 ).GetSeconds() == 86399, "checked" );
+
+  bool InWindow( const UniversalTimeCore& trigger, const UniversalTimeCore& hit )
+  {
+    return trigger <= hit && hit - trigger < kTriggerWindow;
+  }
+}
+
+int main()
+{
+  const UniversalTimeCore trigger( 10, 500, 100.0 );
+  UT_CHECK( InWindow( trigger, trigger + 399_ns ) );
+  UT_CHECK( !InWindow( trigger, trigger + 400_ns ) );
+  UT_CHECK( !InWindow( trigger, trigger - 1_ns ) );
+  UT_CHECK( PackedTimes::Pack( 1_d + 1_h + 1_min + 1_s + 1_ms + 1_us + 1_ns )
+            == PackedTimes::kNanoSecondsPerDay + 3661001001001ll );
+  UT_CHECK( PackedTimes::Pack( 0.25_us ) == 250 );
+  UT_CHECK( PackedTimes::Pack( 1.000000001_s ) == 1000000001 );
+  return Check::Result();
+}
@@ -0,0 +1,41 @@
+////////////////////////////////////////////////////////////////////
+/// Prints the records of BinaryLogger::Write files as text.
+///
+/// Usage: BinaryLogDecode file...
+////////////////////////////////////////////////////////////////////
+#include <BinaryLogger.hh>
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+int main( int argc, char** argv )
+{
+  if( argc < 2 )
+    {
+      std::fprintf( stderr, "Usage: %s file...\n", argv[0] );
+      return 2;
+    }
+  int result = 0;
+  for( int arg = 1; arg < argc; arg++ )
+    {
+      FILE* file = std::fopen( argv[arg], "rb" );
+      if( file == 0 )
+        {
+          std::perror( argv[arg] );
+          result = 1;
+          continue;
+        }
+      try
+        {
+          BinaryLogger::Decode( file, []( const PackedTime, const std::string& text ) { std::puts( text.c_str() ); } );
+        }
+      catch( const std::runtime_error& error )
+        {
+          std::fprintf( stderr, "%s: %s\n", argv[arg], error.what() );
+          result = 1;
+        }
+      std::fclose( file );
+    }
+  return result;
+}